@@ -0,0 +1,217 @@
+#include <Profiler/Compression.h>
+#include <Profiler/Profiler.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static void benchedFunc()
+{
+}
+
+// Test's workload, HR and LR functions with arguments, a loop with allocations and zones.
+static void workloadFunc(std::size_t value)
+{
+	auto _func = Profiler::HRFunction(reinterpret_cast<void*>(&workloadFunc));
+	Profiler::IntArg(0, value);
+	Profiler::IntArg(1, value * 3);
+}
+
+static void workloadLoop(std::size_t count)
+{
+	auto _func = Profiler::Function(reinterpret_cast<void*>(&workloadLoop));
+	Profiler::IntArg(0, count);
+
+	auto _loop = Profiler::HRForLoop();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		auto _iter = Profiler::HRForLoopIter(_loop, i);
+		workloadFunc(i);
+		int value = 0;
+		Profiler::MemAlloc(&value, sizeof(value));
+		Profiler::MemFree(&value);
+	}
+}
+
+static void workloadZone()
+{
+	PROFILER_ZONE();
+
+	auto lambda = []() {
+		PROFILER_HR_ZONE("Lambda", 0x00FF00, "Bench");
+	};
+	lambda();
+}
+
+// Runs `calls` HR function begin and end pairs on `threadCount` threads and returns the nanoseconds per event.
+// Wall time is scaled by the cores the threads can run on, so threads outnumbering cores still show the cost per event.
+static double MeasureEventCost(std::size_t threadCount, std::size_t calls)
+{
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t i = 0; i < threadCount; ++i)
+	{
+		threads.emplace_back([calls]() {
+			auto  _thread  = Profiler::Thread();
+			void* function = reinterpret_cast<void*>(&benchedFunc);
+			for (std::size_t j = 0; j < calls; ++j)
+			{
+				Profiler::HRFunctionBegin(function);
+				Profiler::HRFunctionEnd();
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+	std::size_t cores = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, threadCount);
+	return elapsed * static_cast<double>(cores) / static_cast<double>(2 * calls * threadCount);
+}
+
+// Per event cost from 1 to 64 threads, a flat line means threads do not contend when publishing events.
+static void ThreadSweep()
+{
+	constexpr std::size_t c_Calls = 200'000;
+
+	std::printf("Thread sweep, %zu calls per thread on %u cores\n", c_Calls, std::thread::hardware_concurrency());
+	std::printf("%8s %12s %12s  (ns/event)\n", "Threads", "Direct", "Collector");
+	for (std::size_t threadCount = 1; threadCount <= 64; threadCount *= 2)
+	{
+		double costs[2];
+		for (std::size_t collector = 0; collector < 2; ++collector)
+		{
+			if (collector)
+				Profiler::StartCollector();
+			Profiler::WantCapturing(true, true);
+			costs[collector] = MeasureEventCost(threadCount, c_Calls);
+			Profiler::WantCapturing(false, true);
+			Profiler::StopCollector();
+			// Every thread has ended, nothing stores into the chains anymore.
+			Profiler::g_State.clearEvents();
+		}
+		std::printf("%8zu %12.2f %12.2f\n", threadCount, costs[0], costs[1]);
+	}
+}
+
+// Compresses every encoded block of a scaled up Test workload the way CaptureWriter does and checks the round trip.
+static void CompressionBench()
+{
+	constexpr std::size_t c_Frames = 20'000;
+	constexpr std::size_t c_Passes = 5;
+
+	Profiler::WantCapturing(true, true);
+	for (std::size_t frame = 0; frame < c_Frames; ++frame)
+	{
+		workloadFunc(frame);
+		workloadLoop(10);
+		workloadZone();
+		Profiler::Frame();
+	}
+	Profiler::WantCapturing(false, true);
+
+	std::vector<const Profiler::EncodedBlock*> blocks;
+	for (auto chain : Profiler::g_State.Chains)
+	{
+		for (auto block = chain->first(); block; block = Profiler::EventChain::next(block))
+			blocks.emplace_back(block);
+	}
+
+	std::size_t                     bound      = Profiler::CompressBound(Profiler::c_EncodedBlockSize);
+	auto                            compressed = std::make_unique<std::uint8_t[]>(bound * blocks.size());
+	std::vector<std::size_t>        sizes(blocks.size());
+	std::unique_ptr<std::uint8_t[]> restored   = std::make_unique<std::uint8_t[]>(Profiler::c_EncodedBlockSize);
+
+	std::size_t rawBytes        = 0;
+	std::size_t compressedBytes = 0;
+	auto        start           = std::chrono::steady_clock::now();
+	for (std::size_t pass = 0; pass < c_Passes; ++pass)
+	{
+		for (std::size_t i = 0; i < blocks.size(); ++i)
+			sizes[i] = Profiler::Compress(blocks[i]->Data, blocks[i]->Size, compressed.get() + i * bound, bound);
+	}
+	double compressTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	bool intact = true;
+	start       = std::chrono::steady_clock::now();
+	for (std::size_t pass = 0; pass < c_Passes; ++pass)
+	{
+		for (std::size_t i = 0; i < blocks.size(); ++i)
+		{
+			std::size_t size  = Profiler::Decompress(compressed.get() + i * bound, sizes[i], restored.get(), Profiler::c_EncodedBlockSize);
+			intact           &= size == blocks[i]->Size && std::memcmp(restored.get(), blocks[i]->Data, size) == 0;
+		}
+	}
+	double decompressTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (std::size_t i = 0; i < blocks.size(); ++i)
+	{
+		rawBytes        += blocks[i]->Size;
+		compressedBytes += sizes[i];
+	}
+	double processed = static_cast<double>(rawBytes * c_Passes) / 1e6;
+	std::printf("Compression, %zu frames of the Test workload in %zu blocks\n", c_Frames, blocks.size());
+	std::printf("  encoded %zu bytes, compressed %zu bytes, ratio %.2f\n", rawBytes, compressedBytes, static_cast<double>(rawBytes) / static_cast<double>(compressedBytes));
+	std::printf("  compress %.0f MB/s, decompress %.0f MB/s, round trip %s\n", processed / compressTime, processed / decompressTime, intact ? "intact" : "CORRUPT");
+	Profiler::g_State.clearEvents();
+}
+
+static const char* ClockSourceName(Profiler::EClockSource source)
+{
+	switch (source)
+	{
+	case Profiler::EClockSource::Monotonic: return "Monotonic";
+	case Profiler::EClockSource::MonotonicCoarse: return "MonotonicCoarse";
+	case Profiler::EClockSource::Rdtsc: return "Rdtsc";
+	case Profiler::EClockSource::Rdtscp: return "Rdtscp";
+	case Profiler::EClockSource::LfenceRdtsc: return "LfenceRdtsc";
+	}
+	return "Unknown";
+}
+
+// Cost and resolution of every clock source, the numbers to pick PROFILER_LOW_RES_CLOCK and PROFILER_HIGH_RES_CLOCK by.
+static void ClockSources()
+{
+	std::printf("Clock sources\n");
+	std::printf("%16s %12s %16s\n", "Source", "ns/read", "Resolution (ns)");
+	for (auto& info : Profiler::MeasureClockSources())
+	{
+		if (info.Supported)
+			std::printf("%16s %12.2f %16.2f\n", ClockSourceName(info.Source), info.Cost, info.Resolution);
+		else
+			std::printf("%16s %12s %16s\n", ClockSourceName(info.Source), "-", "-");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Profiler::Init();
+
+	// Runs every benchmark, or only those named on the command line.
+	auto selected = [argc, argv](const char* name) {
+		if (argc < 2)
+			return true;
+		for (int i = 1; i < argc; ++i)
+		{
+			if (std::strcmp(argv[i], name) == 0)
+				return true;
+		}
+		return false;
+	};
+
+	if (selected("clocks"))
+		ClockSources();
+	if (selected("threads"))
+		ThreadSweep();
+	if (selected("compression"))
+		CompressionBench();
+
+	Profiler::Deinit();
+}
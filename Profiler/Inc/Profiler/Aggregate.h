@@ -0,0 +1,60 @@
+#pragma once
+
+#include "State.h"
+#include "Utils/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+namespace Profiler
+{
+	// Zones a thread can keep statistics for, calls to further zones are folded into one overflow entry.
+	static constexpr std::size_t c_AggregateTableSize = 1024;
+	// Nesting deeper than this is counted but not timed.
+	static constexpr std::size_t c_AggregateMaxDepth = 256;
+	// Histogram bucket i holds durations below 2^i HR ticks.
+	static constexpr std::size_t c_AggregateBuckets = 40;
+	// Set in aggregate keys of zones, the rest of the key is the descriptor ID.
+	static constexpr std::uint64_t c_AggregateZoneKey = 1ULL << 63;
+
+	struct AggregateStats
+	{
+	public:
+		std::uint64_t ThreadID     = 0; // Only set in per thread snapshots
+		void*         FunctionPtr  = nullptr;
+		std::uint32_t DescriptorID = 0; // Both unset for the overflow entry
+		std::uint64_t Count        = 0;
+		std::uint64_t TotalTime    = 0;
+		std::uint64_t SelfTime     = 0;
+		std::uint64_t MinTime      = 0;
+		std::uint64_t MaxTime      = 0;
+		std::uint64_t Histogram[c_AggregateBuckets] {};
+	};
+
+	// Times are in nanoseconds, or HR ticks when the TSC was not calibrated.
+	struct AggregateSnapshot
+	{
+	public:
+		std::vector<AggregateStats> Stats;
+		std::uint64_t               BucketLimits[c_AggregateBuckets] {};
+	};
+
+	// While aggregating and not capturing, functions and zones update per thread statistics instead of storing events,
+	// every other event is dropped. Takes effect on all threads immediately.
+	void SetAggregating(bool aggregate);
+	bool IsAggregating();
+	// Clears the statistics of every thread, each thread drops its table on its next zone.
+	void ResetAggregates();
+	// Merges the thread tables into one entry per zone sorted by total time, unless perThread is set. Threads that ended
+	// are reported together under thread ID 0.
+	// Safe to call while threads aggregate, counters of zones running concurrently may be slightly apart.
+	AggregateSnapshot SnapshotAggregates(bool perThread = false);
+
+	namespace Detail
+	{
+		BUILD_NEVER_INLINE void AggregateBegin(ThreadState* state, std::uint64_t key);
+		BUILD_NEVER_INLINE void AggregateEnd(ThreadState* state);
+	} // namespace Detail
+} // namespace Profiler
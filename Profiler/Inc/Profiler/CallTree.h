@@ -0,0 +1,52 @@
+#pragma once
+
+#include "State.h"
+#include "Utils/Core.h"
+
+#include <cstdint>
+
+#include <vector>
+
+namespace Profiler
+{
+	// Node of a merged calling context tree, node 0 is the root and every other node's parent precedes it.
+	// Keys are function pointers, or c_AggregateZoneKey | descriptor ID for zones. Times are in nanoseconds.
+	struct CallTreeNode
+	{
+	public:
+		std::uint64_t Key;
+		std::uint32_t Parent;
+		std::uint32_t Depth;
+		std::uint64_t Count;
+		std::uint64_t InclusiveTime;
+		std::uint64_t ExclusiveTime;
+	};
+
+	// Caller to callee edge summed over every context the call happens in, a caller of 0 is a thread's root.
+	struct CallGraphEdge
+	{
+	public:
+		std::uint64_t Caller;
+		std::uint64_t Callee;
+		std::uint64_t Count;
+		std::uint64_t Time;
+	};
+
+	// While set, capturing threads build calling context trees from function and zone begin and end instead of
+	// storing those events, their arguments are dropped. Change it while not capturing.
+	void SetCallTreeCapture(bool enabled);
+	bool IsCallTreeCapture();
+	// Empties the tree of every thread, each thread drops its tree on its next call.
+	void ClearCallTrees();
+
+	// Merges the trees of every thread, calls still open are not included. Trees of threads that ended are kept folded
+	// together. Safe to call while threads build their trees, counts of calls ending concurrently may be slightly apart.
+	std::vector<CallTreeNode>  MergeCallTrees();
+	std::vector<CallGraphEdge> BuildCallGraph(const std::vector<CallTreeNode>& tree);
+
+	namespace Detail
+	{
+		BUILD_NEVER_INLINE void CallTreeBegin(ThreadState* state, std::uint64_t key);
+		BUILD_NEVER_INLINE void CallTreeEnd(ThreadState* state);
+	} // namespace Detail
+} // namespace Profiler
@@ -3,20 +3,50 @@
 #include "State.h"
 #include "Utils/Core.h"
 
+#include <cstddef>
+
 namespace Profiler
 {
+	// Deepest callstack CollectCallstack and CaptureCallstack record.
+	static constexpr std::size_t c_MaxCallstackDepth = 64;
+	// Unique stacks a thread remembers before it starts over and emits stacks again.
+	static constexpr std::size_t c_MaxInternedCallstacks = 16384;
+
 	namespace Detail
 	{
+		// Returns the DataID of the stack's data block, storing the block first if the thread has not seen the stack.
+		std::uint64_t InternCallstack(ThreadState* state, void** callstack, std::size_t callstackSize);
+
 		BUILD_NEVER_INLINE void Callstack(ThreadState* state, void** callstack, std::size_t callstackSize);
-	}
+		BUILD_NEVER_INLINE void CaptureCallstack(ThreadState* state);
+	} // namespace Detail
 
+	// Stacks are interned per thread, the frames of a stack are only stored the first time it is seen.
 	inline void Callstack(void** callstack, std::size_t callstackSize)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::Callstack(state, callstack, callstackSize);
 	}
 
+	// Records the callstack of the caller, cheap enough to call at every allocation.
+	inline void CaptureCallstack()
+	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
+		ThreadState* state = GetThreadState();
+		if (state->Capture)
+			Detail::CaptureCallstack(state);
+	}
+
+	// Unwinds the calling thread and stores return addresses, starting with the caller's.
+	// Uses the CFI tables loaded by Init and falls back to frame pointers, stops at the first frame outside the thread's stack.
+	BUILD_NEVER_INLINE std::size_t UnwindCallstack(void** frames, std::size_t maxFrames, std::size_t skip = 0);
+
 	void** CollectCallstack(std::size_t& size);
 	void   FreeCallstack(void** callstack);
-} // namespace Profiler
\ No newline at end of file
+} // namespace Profiler
@@ -0,0 +1,224 @@
+#pragma once
+
+#include "CallTree.h"
+#include "State.h"
+#include "Symbols.h"
+#include "Utils/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace Profiler
+{
+	static constexpr char          c_CaptureMagic[8] = { 'P', 'R', 'O', 'F', 'C', 'A', 'P', '\0' };
+	static constexpr std::uint32_t c_CaptureVersion  = 2;
+
+	// Version 1 headers end after HighResClockFrequency.
+	static constexpr std::uint32_t c_CaptureHeaderV1Size = 40;
+
+	static constexpr std::uint32_t c_CaptureChunkCompressed = 0x1;
+
+	// A capture file is a CaptureHeader followed by chunks, every chunk starts with a CaptureChunkHeader.
+	// Chunks may appear in any order, readers skip chunk types they do not know.
+	// A finished capture ends with an Index chunk listing every other chunk and a Footer chunk holding the index offset,
+	// so readers can find all blocks without touching the rest of the file.
+	enum class ECaptureChunkType : std::uint32_t
+	{
+		Unknown = 0,
+		Threads,
+		Events,
+		Stats,
+		Index,
+		Footer,
+		Clocks,
+		Zones,
+		CallTree,
+		CallGraph,
+		Symbols,
+		Lines,
+		Modules
+	};
+
+	struct CaptureHeader
+	{
+	public:
+		char          Magic[8];
+		std::uint32_t Version;
+		std::uint32_t HeaderSize;
+		std::uint32_t Abilities;
+		std::uint32_t Flags;
+		std::uint64_t LowResClockFrequency;
+		std::uint64_t HighResClockFrequency;
+		std::uint64_t HighResClockOffset;
+		std::uint64_t HighResClockEpoch;
+		std::uint64_t HighResClockScale;
+	};
+
+	// Converts an HR timestamp to monotonic nanoseconds, returns 0 if the capture has no calibration.
+	inline std::uint64_t HighResToNanoseconds(const CaptureHeader& header, std::uint64_t ticks)
+	{
+		if (!header.HighResClockScale)
+			return 0;
+		std::int64_t  delta    = static_cast<std::int64_t>(ticks - header.HighResClockOffset);
+		std::uint64_t absDelta = delta < 0 ? 0 - static_cast<std::uint64_t>(delta) : static_cast<std::uint64_t>(delta);
+		std::uint64_t low      = absDelta & 0xFFFF'FFFF;
+		std::uint64_t scaled   = (absDelta >> 32) * header.HighResClockScale + low * (header.HighResClockScale >> 32) + ((low * (header.HighResClockScale & 0xFFFF'FFFF)) >> 32);
+		return delta < 0 ? header.HighResClockEpoch - scaled : header.HighResClockEpoch + scaled;
+	}
+
+	struct CaptureChunkHeader
+	{
+	public:
+		ECaptureChunkType Type;
+		std::uint32_t     Flags;
+		std::uint64_t     Size;
+	};
+
+	struct CaptureThreadEntry
+	{
+	public:
+		std::uint64_t ThreadID;
+		std::uint64_t BlockCount;
+		std::uint64_t EventCount;
+	};
+
+	struct CaptureStats
+	{
+	public:
+		std::uint64_t DroppedBlocks;
+		std::uint64_t DroppedEvents;
+		std::uint64_t DroppedSamples; // Missing from older captures, reads as 0
+	};
+
+	// Header of an Events chunk, the encoded block data follows directly after it.
+	// If the chunk is compressed the data is LZ4 compressed and `Size` is the size after decompression.
+	struct CaptureEventsHeader
+	{
+	public:
+		std::uint64_t ThreadID;
+		std::uint32_t Count;
+		std::uint32_t Size;
+	};
+
+	// Entry of a Zones chunk, followed by the name, function, file and category strings without terminators.
+	struct CaptureZoneEntry
+	{
+	public:
+		std::uint32_t ID;
+		std::uint32_t Line;
+		std::uint32_t Color;
+		std::uint16_t NameSize;
+		std::uint16_t FunctionSize;
+		std::uint16_t FileSize;
+		std::uint16_t CategorySize;
+	};
+
+	// Entry of a Symbols chunk, followed by the name without terminator. Entries are sorted by address.
+	struct CaptureSymbolEntry
+	{
+	public:
+		std::uint64_t Address;
+		std::uint64_t Size;
+		std::uint32_t NameSize;
+		std::uint32_t Pad;
+	};
+
+	// Header of a Lines chunk, followed by LocationCount SourceLocation and FrameCount SourceFrame entries and then
+	// StringCount strings, each a u32 size and the characters without terminator.
+	struct CaptureLinesHeader
+	{
+	public:
+		std::uint32_t StringCount;
+		std::uint32_t LocationCount;
+		std::uint32_t FrameCount;
+		std::uint32_t Pad;
+	};
+
+	// Entry of a Modules chunk, followed by the path and the hex build ID without terminators. See LoadedModule.
+	struct CaptureModuleEntry
+	{
+	public:
+		std::uint64_t Base;
+		std::uint64_t Start;
+		std::uint64_t End;
+		std::uint64_t LoadTime;
+		std::uint64_t UnloadTime;
+		std::uint16_t PathSize;
+		std::uint16_t BuildIDSize;
+		std::uint32_t Pad;
+	};
+
+	struct CaptureIndexEntry
+	{
+	public:
+		std::uint64_t     Offset;
+		std::uint64_t     Size;
+		ECaptureChunkType Type;
+		std::uint32_t     Flags;
+		std::uint64_t     ThreadID;
+		std::uint32_t     Count;
+		std::uint32_t     DataSize;
+	};
+
+	class CaptureWriter
+	{
+	public:
+		static constexpr std::size_t c_BufferSize = 1 << 20;
+
+	public:
+		CaptureWriter() = default;
+		CaptureWriter(const CaptureWriter&) = delete;
+		CaptureWriter& operator=(const CaptureWriter&) = delete;
+		~CaptureWriter() { close(); }
+
+		bool open(const std::filesystem::path& filepath);
+		bool close();
+
+		void writeHeader();
+		void writeHeader(const CaptureHeader& header);
+		void writeChunk(ECaptureChunkType type, std::uint32_t flags, const void* data, std::size_t size);
+		// Copies a chunk of another capture as is, `data` is the chunk's data after its CaptureChunkHeader.
+		void copyChunk(const CaptureIndexEntry& entry, const std::uint8_t* data);
+		void writeEvents(const EncodedBlock* block);
+		// Writes the zone descriptors registered from `first` on, returns the number of descriptors written so far.
+		std::size_t writeZones(std::size_t first);
+		void        writeSymbols(const std::vector<ResolvedSymbol>& symbols);
+		void        writeLines(const ResolvedLines& lines);
+		void        writeModules(const std::vector<LoadedModule>& modules);
+
+		void setCompression(bool compress) { m_Compress = compress; }
+
+		bool isOpen() const { return m_File != nullptr; }
+		bool good() const { return m_Good; }
+
+	private:
+		void addIndexEntry(ECaptureChunkType type, std::uint32_t flags, std::uint64_t size, const CaptureEventsHeader* events = nullptr);
+		void write(const void* data, std::size_t size);
+		void flush();
+
+	private:
+		std::FILE*                      m_File   = nullptr;
+		bool                            m_Good   = false;
+		std::uint64_t                   m_Offset = 0;
+		std::vector<CaptureIndexEntry>  m_Index;
+		std::unique_ptr<std::uint8_t[]> m_Buffer;
+		std::size_t                     m_BufferSize = 0;
+		bool                            m_Compress   = false;
+		std::unique_ptr<std::uint8_t[]> m_Scratch;
+	};
+
+	bool WriteCaptures(const std::filesystem::path& filepath, bool compress);
+
+	// Writes a copy of a capture with its Symbols and Lines chunks resolved from its module table, meant for captures
+	// taken with capture symbolization off. Module files missing from their recorded paths are looked up in `searchPaths`.
+	bool SymbolizeCapture(const std::filesystem::path& input, const std::filesystem::path& output, const std::vector<std::filesystem::path>& searchPaths = {});
+
+	// Converts a binary capture into a human readable text dump, meant for debugging.
+	bool DumpCapture(const std::filesystem::path& filepath, std::ostream& stream = std::cout);
+} // namespace Profiler
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CaptureReader.h"
+#include "ClockDomain.h"
+#include "Events.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+namespace Profiler
+{
+	// A paired FunctionBegin or ZoneBegin with its FunctionEnd, `Sequence` orders zones of one thread by when they began.
+	// Zones begun from a descriptor have a DescriptorID and no FunctionPtr.
+	// BeginTime and EndTime are both timestamps converted to monotonic nanoseconds, so LR and HR zones compare.
+	struct Zone
+	{
+	public:
+		void*          FunctionPtr   = nullptr;
+		EventTimestamp Begin {};
+		EventTimestamp End {};
+		std::uint64_t  BeginTime     = 0;
+		std::uint64_t  EndTime       = 0;
+		std::uint64_t  Sequence      = 0;
+		std::uint32_t  DescriptorID  = 0;
+		std::uint32_t  Depth         = 0;
+		std::uint32_t  FirstArgument = 0;
+		std::uint32_t  ArgumentCount = 0;
+		bool           Closed        = false;
+	};
+
+	struct ThreadZones
+	{
+	public:
+		std::uint64_t ThreadID = 0;
+
+		// Sorted by Sequence, so parents come before their children.
+		std::vector<Zone>          Zones;
+		std::vector<CapturedEvent> Arguments;
+	};
+
+	struct CaptureAnalysis
+	{
+	public:
+		std::vector<ThreadZones> Threads;
+		std::size_t              ZoneCount     = 0;
+		std::size_t              FailedBlocks  = 0;
+		std::size_t              UnmatchedEnds = 0;
+		std::size_t              UnclosedZones = 0;
+	};
+
+	// Decodes every block on a work stealing pool, pairs zones within each block and stitches the
+	// per block results of every thread together afterwards.
+	// threadCount of 0 uses all hardware threads.
+	CaptureAnalysis AnalyzeCapture(const CaptureReader& reader, std::size_t threadCount = 0);
+} // namespace Profiler
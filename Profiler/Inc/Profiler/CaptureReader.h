@@ -0,0 +1,223 @@
+#pragma once
+
+#include "Capture.h"
+#include "Encoding.h"
+#include "Events.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Profiler
+{
+	struct CapturedEvent
+	{
+	public:
+		template <class T>
+		const T& as() const
+		{
+			return *reinterpret_cast<const T*>(&Data);
+		}
+
+	public:
+		EEventType Type = EEventType::Unknown;
+		Event      Data;
+	};
+
+	// Strings point into the mapping and stay valid while the reader is open.
+	struct CapturedZoneDescriptor
+	{
+	public:
+		std::uint32_t    ID    = 0;
+		std::uint32_t    Line  = 0;
+		std::uint32_t    Color = 0;
+		std::string_view Name;
+		std::string_view Function;
+		std::string_view File;
+		std::string_view Category;
+	};
+
+	// Name points into the mapping and stays valid while the reader is open.
+	struct CapturedSymbol
+	{
+	public:
+		std::uint64_t    Address = 0;
+		std::uint64_t    Size    = 0;
+		std::string_view Name;
+	};
+
+	// One frame of a captured address, strings point into the mapping and stay valid while the reader is open.
+	struct CapturedSourceFrame
+	{
+	public:
+		std::string_view Function;
+		std::string_view File;
+		std::uint32_t    Line   = 0;
+		std::uint32_t    Column = 0;
+	};
+
+	// Module the capture's process had loaded, strings point into the mapping and stay valid while the reader is open.
+	struct CapturedModule
+	{
+	public:
+		std::uint64_t    Base       = 0;
+		std::uint64_t    Start      = 0;
+		std::uint64_t    End        = 0;
+		std::uint64_t    LoadTime   = 0;
+		std::uint64_t    UnloadTime = 0;
+		std::string_view Path;
+		std::string_view BuildID;
+	};
+
+	// One Events chunk in a mapped capture, `Data` points straight into the mapping.
+	struct CaptureBlock
+	{
+	public:
+		std::uint64_t       ThreadID = 0;
+		std::uint32_t       Count    = 0;
+		std::uint32_t       Size     = 0;
+		std::uint32_t       Flags    = 0;
+		const std::uint8_t* Data     = nullptr;
+		std::size_t         DataSize = 0;
+	};
+
+	// Decodes the events of a single block, iterating does not allocate per event.
+	// Compressed blocks are decompressed once into a buffer owned by the range.
+	class CaptureEventRange
+	{
+	public:
+		class Iterator
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type        = CapturedEvent;
+			using difference_type   = std::ptrdiff_t;
+			using pointer           = const CapturedEvent*;
+			using reference         = const CapturedEvent&;
+
+		public:
+			Iterator() = default;
+			Iterator(CaptureEventRange* range)
+				: m_Range(range)
+			{
+				++*this;
+			}
+
+			const CapturedEvent& operator*() const { return m_Range->m_Current; }
+			const CapturedEvent* operator->() const { return &m_Range->m_Current; }
+
+			Iterator& operator++()
+			{
+				if (!m_Range->m_Decoder.next(m_Range->m_Current.Data, m_Range->m_Current.Type))
+					m_Range = nullptr;
+				return *this;
+			}
+
+			friend bool operator==(const Iterator& lhs, std::default_sentinel_t) { return lhs.m_Range == nullptr; }
+
+		private:
+			CaptureEventRange* m_Range = nullptr;
+		};
+
+	public:
+		CaptureEventRange() = default;
+		CaptureEventRange(const CaptureBlock& block) { reset(block); }
+
+		// Returns false if the block could not be decompressed.
+		bool reset(const CaptureBlock& block);
+
+		Iterator                begin() { return Iterator { this }; }
+		std::default_sentinel_t end() { return {}; }
+
+	private:
+		EventDecoder              m_Decoder;
+		CapturedEvent             m_Current;
+		std::vector<std::uint8_t> m_Buffer;
+	};
+
+	// Memory maps a capture file and indexes its chunks, event data is only paged in once it is decoded.
+	class CaptureReader
+	{
+	public:
+		CaptureReader() = default;
+		CaptureReader(const CaptureReader&) = delete;
+		CaptureReader& operator=(const CaptureReader&) = delete;
+		~CaptureReader() { close(); }
+
+		bool open(const std::filesystem::path& filepath);
+		void close();
+
+		bool isOpen() const { return m_Data != nullptr; }
+
+		const CaptureHeader&                   header() const { return m_Header; }
+		const CaptureStats&                    stats() const { return m_Stats; }
+		const std::vector<CaptureThreadEntry>& threads() const { return m_Threads; }
+		const std::vector<ClockSample>&        clockSamples() const { return m_ClockSamples; }
+		const std::vector<CaptureBlock>&       blocks() const { return m_Blocks; }
+		// Merged calling context tree and call graph of captures taken with call tree capture on.
+		const std::vector<CallTreeNode>&  callTree() const { return m_CallTree; }
+		const std::vector<CallGraphEdge>& callGraph() const { return m_CallGraph; }
+
+		// Indexed by descriptor ID - 1, IDs missing from the capture have an ID of 0.
+		const std::vector<CapturedZoneDescriptor>& zoneDescriptors() const { return m_ZoneDescriptors; }
+		const CapturedZoneDescriptor*              zoneDescriptor(std::uint32_t id) const { return id && id <= m_ZoneDescriptors.size() && m_ZoneDescriptors[id - 1].ID ? &m_ZoneDescriptors[id - 1] : nullptr; }
+
+		// Function symbols the capture's code addresses resolved to, sorted by address.
+		const std::vector<CapturedSymbol>& symbols() const { return m_Symbols; }
+		// Symbol containing `address`, nullptr if the capture has none for it.
+		const CapturedSymbol* symbol(std::uint64_t address) const;
+
+		// File, line and inlined frames of a captured code address, innermost first. Empty without line info.
+		std::span<const CapturedSourceFrame> sourceFrames(std::uint64_t address) const;
+		const std::vector<SourceLocation>&   sourceLocations() const { return m_SourceLocations; }
+
+		// Modules the capture's code addresses belong to, empty for captures written before module tables.
+		const std::vector<CapturedModule>& modules() const { return m_Modules; }
+
+		// Every chunk but the index and footer, in file order.
+		const std::vector<CaptureIndexEntry>& index() const { return m_Index; }
+		// Chunks of types the reader does not interpret itself, in file order.
+		const std::vector<CaptureIndexEntry>& chunks() const { return m_Chunks; }
+		const std::uint8_t*                   chunkData(const CaptureIndexEntry& entry) const { return m_Data + entry.Offset + sizeof(CaptureChunkHeader); }
+
+		CaptureEventRange events(const CaptureBlock& block) const { return CaptureEventRange { block }; }
+
+	private:
+		bool readIndex();
+		bool scanChunks();
+		void addChunk(const CaptureIndexEntry& entry);
+		void addZones(const std::uint8_t* data, std::size_t size);
+		void addSymbols(const std::uint8_t* data, std::size_t size);
+		void addLines(const std::uint8_t* data, std::size_t size);
+		void addModules(const std::uint8_t* data, std::size_t size);
+
+	private:
+		const std::uint8_t* m_Data = nullptr;
+		std::size_t         m_Size = 0;
+#if BUILD_IS_SYSTEM_WINDOWS
+		void* m_File    = nullptr;
+		void* m_Mapping = nullptr;
+#endif
+
+		CaptureHeader                   m_Header {};
+		CaptureStats                    m_Stats {};
+		std::vector<CaptureThreadEntry> m_Threads;
+		std::vector<ClockSample>        m_ClockSamples;
+		std::vector<CaptureBlock>       m_Blocks;
+		std::vector<CaptureIndexEntry>  m_Index;
+		std::vector<CaptureIndexEntry>  m_Chunks;
+		std::vector<CallTreeNode>       m_CallTree;
+		std::vector<CallGraphEdge>      m_CallGraph;
+
+		std::vector<CapturedZoneDescriptor> m_ZoneDescriptors;
+		std::vector<CapturedSymbol>         m_Symbols;
+		std::vector<SourceLocation>         m_SourceLocations;
+		std::vector<CapturedSourceFrame>    m_SourceFrames;
+		std::vector<CapturedModule>         m_Modules;
+	};
+} // namespace Profiler
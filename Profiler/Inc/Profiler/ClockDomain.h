@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CaptureReader.h"
+#include "Events.h"
+
+#include <cstdint>
+
+#include <vector>
+
+namespace Profiler
+{
+	// Maps LR and HR timestamps of a capture onto one monotonic nanosecond timeline.
+	// Between clock samples both clocks are interpolated linearly, outside of them the nearest segment is extended.
+	class ClockConverter
+	{
+	public:
+		ClockConverter() = default;
+		explicit ClockConverter(const CaptureReader& reader) { reset(reader); }
+
+		void reset(const CaptureReader& reader);
+
+		std::uint64_t toNanoseconds(EventTimestamp timestamp) const { return timestamp.Type ? highResToNanoseconds(timestamp.Time) : lowResToNanoseconds(timestamp.Time); }
+		std::uint64_t highResToNanoseconds(std::uint64_t ticks) const { return m_HighRes.map(ticks); }
+		std::uint64_t lowResToNanoseconds(std::uint64_t time) const { return m_LowRes.map(time); }
+
+	private:
+		struct Point
+		{
+		public:
+			std::uint64_t From;
+			std::uint64_t To;
+		};
+
+		struct Mapping
+		{
+		public:
+			void          reset(std::vector<Point> points, double defaultSlope);
+			std::uint64_t map(std::uint64_t value) const;
+
+		public:
+			std::vector<Point> Points;
+			double             DefaultSlope = 1.0;
+		};
+
+	private:
+		Mapping m_HighRes;
+		Mapping m_LowRes;
+	};
+} // namespace Profiler
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "State.h"
+#include "Utils/Core.h"
+
+#include <cstddef>
+
+#include <filesystem>
+
+namespace Profiler
+{
+	// The collector thread takes full event blocks off the instrumented threads and stores them,
+	// so the thread that filled a block only pays for a queue push.
+	void StartCollector();
+	// Ends streaming first, streams are written by the collector.
+	void StopCollector();
+	void FlushCollector();
+	bool IsCollectorRunning();
+
+	struct StreamingOptions
+	{
+	public:
+		// Once blocks waiting for the collector use more memory than this, the policy decides what publishing threads do.
+		// Dropping keeps blocks that hold part of a data record.
+		std::size_t      HighWaterMark = 64 << 20;
+		EStreamingPolicy Policy        = EStreamingPolicy::Block;
+		bool             Compress      = true;
+	};
+
+	// Streams encoded blocks to a capture file while capturing, keeping resident event memory around the high water mark.
+	// Starts the collector if it is not running already.
+	bool StartStreaming(const std::filesystem::path& filepath, const StreamingOptions& options = {});
+	bool StopStreaming();
+	bool IsStreaming();
+} // namespace Profiler
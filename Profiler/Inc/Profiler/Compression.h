@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Profiler
+{
+	// LZ4 block format compression, used for event blocks on their way to storage.
+	constexpr std::size_t CompressBound(std::size_t size)
+	{
+		return size + size / 255 + 16;
+	}
+
+	// Returns the compressed size, or 0 if `dst` is too small.
+	std::size_t Compress(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstCapacity);
+
+	// Returns the decompressed size, or 0 if the input is malformed or does not fit in `dst`.
+	std::size_t Decompress(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstCapacity);
+} // namespace Profiler
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+#include <string_view>
+
+// Set PROFILER_ENABLED to 0 to compile out every instrumentation call, the library itself still builds.
+#ifndef PROFILER_ENABLED
+	#define PROFILER_ENABLED 1
+#endif
+
+// Zones with a level above PROFILER_LEVEL are compiled out, see ELevel.
+#ifndef PROFILER_LEVEL
+	#define PROFILER_LEVEL 4
+#endif
+
+// Per category overrides of PROFILER_LEVEL as a list of { "Category", level } entries, each followed by a comma,
+// e.g. -DPROFILER_CATEGORY_LEVELS={\"Render\",1},{\"Physics\",3},
+#ifndef PROFILER_CATEGORY_LEVELS
+	#define PROFILER_CATEGORY_LEVELS
+#endif
+
+namespace Profiler
+{
+	static constexpr bool c_ProfilerEnabled = PROFILER_ENABLED != 0;
+
+	enum class ELevel : std::uint8_t
+	{
+		Coarse = 1,
+		Normal,
+		Detailed,
+		Verbose
+	};
+
+	struct CategoryLevel
+	{
+	public:
+		const char*  Category;
+		std::uint8_t Level;
+	};
+
+	static constexpr CategoryLevel c_CategoryLevels[] = { PROFILER_CATEGORY_LEVELS { nullptr, PROFILER_LEVEL } };
+
+	consteval std::uint8_t GetCategoryLevel(const char* category)
+	{
+		for (auto& entry : c_CategoryLevels)
+		{
+			if (entry.Category && category && std::string_view { entry.Category } == category)
+				return entry.Level;
+		}
+		return PROFILER_LEVEL;
+	}
+
+	consteval bool IsZoneEnabled(ELevel level, const char* category)
+	{
+		return c_ProfilerEnabled && static_cast<std::uint8_t>(level) <= GetCategoryLevel(category);
+	}
+} // namespace Profiler
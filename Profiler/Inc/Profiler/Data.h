@@ -12,6 +12,9 @@ namespace Profiler
 
 	inline std::uint64_t Data(void* data, std::size_t size)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return 0;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			return Detail::Data(state, data, size);
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Elf.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#if BUILD_IS_SYSTEM_LINUX
+namespace Profiler
+{
+	static constexpr std::uint32_t c_DwarfNone = ~0U;
+
+	// Source position of one frame at an address, Function and File index DwarfIndex::strings(), c_DwarfNone if unknown.
+	struct DwarfFrame
+	{
+	public:
+		std::uint32_t Function;
+		std::uint32_t File;
+		std::uint32_t Line;
+		std::uint32_t Column;
+	};
+
+	// The .debug_line rows and the subprogram and inlined subroutine tree of .debug_info of one module, flattened
+	// into address sorted tables so a lookup is two binary searches. Supports DWARF 2 to 5 without split units.
+	class DwarfIndex
+	{
+	public:
+		// Returns false if the file has no usable .debug_line.
+		bool build(const ElfFile& elf);
+
+		// Appends the frames at the link time `address`, innermost inlined frame first, the last one is the concrete function.
+		void lookup(std::uint64_t address, std::vector<DwarfFrame>& frames) const;
+
+		const std::vector<std::string>& strings() const { return m_Strings; }
+
+	private:
+		struct LineRow
+		{
+		public:
+			std::uint64_t Address;
+			std::uint32_t File;
+			std::uint32_t Line; // 0 past the end of a sequence
+			std::uint32_t Column;
+		};
+
+		// A subprogram or inlined subroutine, Call* is where its parent called it.
+		struct Scope
+		{
+		public:
+			std::uint32_t Function;
+			std::uint32_t CallFile;
+			std::uint32_t CallLine;
+			std::uint32_t CallColumn;
+			std::uint32_t Parent;
+		};
+
+		// Innermost scope from Start up to the next range, c_DwarfNone outside of any function.
+		struct ScopeRange
+		{
+		public:
+			std::uint64_t Start;
+			std::uint32_t Scope;
+		};
+
+		friend class DwarfBuilder;
+
+	private:
+		std::vector<LineRow>     m_Lines;
+		std::vector<Scope>       m_Scopes;
+		std::vector<ScopeRange>  m_Ranges;
+		std::vector<std::string> m_Strings;
+	};
+} // namespace Profiler
+#endif
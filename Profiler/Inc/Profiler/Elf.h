@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Utils/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <string_view>
+
+#if BUILD_IS_SYSTEM_LINUX
+	#include <elf.h>
+
+namespace Profiler
+{
+	// Contents of one section, Data is nullptr if the file has no such section.
+	struct ElfSection
+	{
+	public:
+		const std::uint8_t* Data = nullptr;
+		std::size_t         Size = 0;
+	};
+
+	// Read only mapping of a 64 bit ELF file, every access is bounds checked against the file size.
+	class ElfFile
+	{
+	public:
+		ElfFile(const std::string& path);
+		ElfFile(const ElfFile&) = delete;
+		ElfFile& operator=(const ElfFile&) = delete;
+		~ElfFile();
+
+		bool valid() const { return m_Header != nullptr; }
+
+		template <class T>
+		const T* at(std::uint64_t offset, std::uint64_t count = 1) const
+		{
+			if (!m_Data || offset > m_Size || count > (m_Size - offset) / sizeof(T))
+				return nullptr;
+			return reinterpret_cast<const T*>(m_Data + offset);
+		}
+
+		const Elf64_Phdr* programHeaders() const { return at<Elf64_Phdr>(m_Header->e_phoff, m_Header->e_phnum); }
+		const Elf64_Shdr* sectionHeaders() const { return at<Elf64_Shdr>(m_Header->e_shoff, m_Header->e_shnum); }
+		std::size_t       programHeaderCount() const { return programHeaders() ? m_Header->e_phnum : 0; }
+		std::size_t       sectionHeaderCount() const { return sectionHeaders() ? m_Header->e_shnum : 0; }
+
+		// Hex string of the NT_GNU_BUILD_ID note, empty if the file has none.
+		std::string buildID() const;
+
+		bool hasSection(std::uint32_t type) const;
+		// Compressed sections are reported as missing.
+		ElfSection section(std::string_view name) const;
+
+	private:
+		const std::uint8_t* m_Data   = nullptr;
+		std::size_t         m_Size   = 0;
+		const Elf64_Ehdr*   m_Header = nullptr;
+	};
+
+	// Hex string of the NT_GNU_BUILD_ID note among `size` bytes of notes, empty if there is none.
+	std::string ReadBuildIDNote(const std::uint8_t* notes, std::size_t size);
+
+	// Path of the separate debug file /usr/lib/debug/.build-id holds for a stripped file.
+	std::string ElfDebugFilePath(const std::string& buildID);
+} // namespace Profiler
+#endif
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Events.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+namespace Profiler
+{
+	static constexpr std::size_t c_MaxEncodedEventSize = 48;
+
+	// Every encoded event starts with a tag byte, the low 5 bits hold the EEventType and the upper 3 bits a small payload.
+	// Timestamps are zigzag varint deltas against the previous timestamp of the same type with the type in the lowest bit,
+	// function pointers are indices into a dictionary that is built while encoding.
+	// Encoder and decoder state is reset at the start of every encoded block so blocks decode independently, a data
+	// record left open continues as DataSection events in the next block.
+	class EventEncoder
+	{
+	public:
+		// Starts a new encoded block.
+		void beginBlock();
+		// Starts a new block and forgets any open data record, for when the events before were discarded.
+		void reset();
+
+		// Encodes one raw event slot into `out`, which needs room for c_MaxEncodedEventSize bytes.
+		std::size_t encode(const Event& event, std::uint8_t* out);
+
+	private:
+		struct DictionaryEntry
+		{
+			void*         FunctionPtr;
+			std::uint32_t Index;
+			std::uint32_t Generation;
+		};
+
+		static constexpr std::size_t c_DictionarySize = 1024;
+		static constexpr std::size_t c_MaxProbes      = 8;
+
+	private:
+		void writeTimestamp(std::uint8_t*& out, EventTimestamp timestamp);
+		bool findFunction(void* functionPtr, std::uint64_t& index);
+
+	private:
+		std::uint64_t   m_LastTimestamps[2] { 0, 0 };
+		std::uint32_t   m_Generation    = 1;
+		std::uint32_t   m_FunctionCount = 0;
+		std::uint64_t   m_DataRemaining = 0;
+		DictionaryEntry m_Dictionary[c_DictionarySize] {};
+	};
+
+	class EventDecoder
+	{
+	public:
+		void reset(const std::uint8_t* data, std::size_t size);
+
+		// Decodes the next event into `event`, DataSection events hold raw data bytes instead of a typed event.
+		// Returns false once the block is exhausted or the data is malformed.
+		bool next(Event& event, EEventType& type);
+
+		bool done() const { return m_Cur == m_End; }
+
+	private:
+		bool readTimestamp(EventTimestamp& timestamp);
+
+	private:
+		const std::uint8_t* m_Cur = nullptr;
+		const std::uint8_t* m_End = nullptr;
+
+		std::uint64_t      m_LastTimestamps[2] { 0, 0 };
+		std::vector<void*> m_Functions;
+	};
+} // namespace Profiler
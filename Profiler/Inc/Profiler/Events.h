@@ -0,0 +1,325 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Profiler
+{
+	enum class EEventType : std::uint8_t
+	{
+		Unknown = 0,
+		ThreadBounds,
+		ThreadBegin,
+		ThreadEnd,
+		Frame,
+		FunctionBegin,
+		FunctionEnd,
+		Callstack,
+		BoolArgument,
+		IntArgument,
+		FloatArgument,
+		FlagsArgument,
+		PtrArgument,
+		ForLoopBegin,
+		ForLoopEnd,
+		ForLoopIterBegin,
+		ForLoopIterEnd,
+		MemAlloc,
+		MemFree,
+		DataHeader,
+		DataSection,
+		ZoneBegin,
+		Sample,
+		ZoneSample
+	};
+
+	struct EventTimestamp
+	{
+		std::uint64_t Time : 63;
+		std::uint64_t Type : 1;
+	};
+
+	struct Event
+	{
+	public:
+		Event()
+			: Type(EEventType::Unknown),
+			  Data { 0 } {}
+
+		Event(EEventType type)
+			: Type(type),
+			  Data { 0 } {}
+
+	public:
+		EEventType   Type;
+		std::uint8_t Data[31];
+	};
+
+	struct ThreadBoundsEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ThreadBounds;
+
+	public:
+		EEventType    Type;
+		std::uint64_t ThreadID;
+		std::uint64_t Length;
+	};
+
+	struct ThreadBeginEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ThreadBegin;
+
+	public:
+		EEventType     Type;
+		EventTimestamp Timestamp;
+	};
+
+	struct ThreadEndEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ThreadEnd;
+
+	public:
+		EEventType     Type;
+		EventTimestamp Timestamp;
+	};
+
+	struct FrameEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::Frame;
+
+	public:
+		EEventType     Type;
+		std::uint64_t  FrameNum;
+		EventTimestamp Timestamp;
+	};
+
+	struct FunctionBeginEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::FunctionBegin;
+
+	public:
+		EEventType     Type;
+		void*          FunctionPtr;
+		EventTimestamp Timestamp;
+	};
+
+	struct FunctionEndEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::FunctionEnd;
+
+	public:
+		EEventType     Type;
+		EventTimestamp Timestamp;
+	};
+
+	// Begins a zone described by a registered ZoneDescriptor, zones end with a FunctionEndEvent.
+	struct ZoneBeginEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ZoneBegin;
+
+	public:
+		EEventType     Type;
+		std::uint32_t  DescriptorID;
+		EventTimestamp Timestamp;
+	};
+
+	// DataID names the data block holding the return addresses, threads store each unique stack once
+	// and reference its block from every later callstack event.
+	struct CallstackEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::Callstack;
+
+	public:
+		EEventType    Type;
+		std::uint64_t DataID;
+		std::uint64_t NumEntries;
+	};
+
+	// Stack of a thread interrupted by its sampling timer, DataID names an interned callstack data block.
+	struct SampleEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::Sample;
+
+	public:
+		EEventType     Type;
+		std::uint64_t  DataID;
+		std::uint64_t  NumEntries;
+		EventTimestamp Timestamp;
+	};
+
+	// Shadow stack of ThreadID read by the zone sampler thread, DataID names an interned data block of zone keys.
+	struct ZoneSampleEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ZoneSample;
+
+	public:
+		EEventType     Type;
+		std::uint8_t   NumEntries;
+		std::uint8_t   Pad[6];
+		std::uint64_t  ThreadID;
+		std::uint64_t  DataID;
+		EventTimestamp Timestamp;
+	};
+
+	struct BoolArgumentEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::BoolArgument;
+
+	public:
+		EEventType   Type;
+		std::uint8_t Offset;
+		std::uint8_t Pad[6];
+		bool         Value;
+	};
+
+	struct IntArgumentEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::IntArgument;
+
+	public:
+		EEventType    Type;
+		std::uint8_t  Offset;
+		std::uint8_t  Size;
+		std::uint8_t  Base;
+		std::uint8_t  Pad[4];
+		std::uint64_t Data[3];
+	};
+
+	struct FloatArgumentEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::FloatArgument;
+
+	public:
+		EEventType    Type;
+		std::uint8_t  Offset;
+		std::uint8_t  Size;
+		std::uint8_t  Pad[5];
+		std::uint64_t Data[3];
+	};
+
+	struct FlagsArgumentEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::FlagsArgument;
+
+	public:
+		EEventType    Type;
+		std::uint8_t  Offset;
+		std::uint8_t  Pad[6];
+		std::uint64_t FlagsType;
+		std::uint64_t Data[2];
+	};
+
+	struct PtrArgumentEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::PtrArgument;
+
+	public:
+		EEventType   Type;
+		std::uint8_t Offset;
+		std::uint8_t Pad[6];
+		void*        Ptr;
+	};
+
+	struct ForLoopBeginEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ForLoopBegin;
+
+	public:
+		EEventType     Type;
+		std::size_t    ID;
+		EventTimestamp Timestamp;
+	};
+
+	struct ForLoopEndEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ForLoopEnd;
+
+	public:
+		EEventType     Type;
+		std::uint64_t  ID;
+		EventTimestamp Timestamp;
+	};
+
+	struct ForLoopIterBeginEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ForLoopIterBegin;
+
+	public:
+		EEventType     Type;
+		std::uint8_t   Size;
+		std::uint8_t   Pad[6];
+		std::uint64_t  ID;
+		EventTimestamp Timestamp;
+		std::uint64_t  Index[2];
+	};
+
+	struct ForLoopIterEndEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::ForLoopIterEnd;
+
+	public:
+		EEventType     Type;
+		std::uint8_t   Pad[7];
+		std::uint64_t  ID;
+		EventTimestamp Timestamp;
+	};
+
+	struct MemAllocEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::MemAlloc;
+
+	public:
+		EEventType     Type;
+		void*          Memory;
+		std::uint64_t  Size;
+		EventTimestamp Timestamp;
+	};
+
+	struct MemFreeEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::MemFree;
+
+	public:
+		EEventType     Type;
+		void*          Memory;
+		EventTimestamp Timestamp;
+	};
+
+	struct DataHeaderEvent
+	{
+	public:
+		static constexpr EEventType c_Type = EEventType::DataHeader;
+
+	public:
+		EEventType    Type;
+		std::uint64_t Size;
+		std::uint64_t ID;
+	};
+
+	struct DataSectionEvent
+	{
+	public:
+		std::uint8_t Data[32];
+	};
+} // namespace Profiler
\ No newline at end of file
@@ -22,6 +22,9 @@ namespace Profiler
 
 	inline std::uint64_t ForLoopBegin()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return 0;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			return Detail::ForLoopBegin(state);
@@ -30,6 +33,9 @@ namespace Profiler
 
 	inline void ForLoopEnd(std::uint64_t id)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::ForLoopEnd(state, id);
@@ -37,6 +43,9 @@ namespace Profiler
 
 	inline std::uint64_t HRForLoopBegin()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return 0;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			return Detail::HRForLoopBegin(state);
@@ -45,6 +54,9 @@ namespace Profiler
 
 	inline void HRForLoopEnd(std::uint64_t id)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::HRForLoopEnd(state, id);
@@ -53,6 +65,9 @@ namespace Profiler
 	template <std::integral T>
 	inline void ForLoopIterBegin(std::uint64_t id, T index)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 		{
@@ -64,6 +79,9 @@ namespace Profiler
 
 	inline void ForLoopIterEnd(std::uint64_t id)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::ForLoopIterEnd(state, id);
@@ -72,6 +90,9 @@ namespace Profiler
 	template <std::integral T>
 	inline void HRForLoopIterBegin(std::uint64_t id, T index)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 		{
@@ -83,6 +104,9 @@ namespace Profiler
 
 	inline void HRForLoopIterEnd(std::uint64_t id)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::HRForLoopIterEnd(state, id);
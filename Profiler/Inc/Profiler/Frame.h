@@ -14,6 +14,9 @@ namespace Profiler
 
 	inline void Frame()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		if (!g_State.Initialized)
 			return;
 
@@ -23,18 +26,29 @@ namespace Profiler
 		bool newCapture = g_State.WantCapturing;
 		if (g_State.Capturing != newCapture)
 		{
+			if (newCapture)
+				++g_State.CallstackGeneration;
 			for (auto tstate : g_State.Threads)
+			{
 				tstate->Capture = newCapture;
+				if (!newCapture)
+					RequestFlush(tstate);
+			}
 		}
 		g_State.Capturing = newCapture;
 
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::Frame(state);
+		else
+			FlushIfRequested(state);
 	}
 
 	inline void HRFrame()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		if (!g_State.Initialized)
 			return;
 
@@ -44,13 +58,21 @@ namespace Profiler
 		bool newCapture = g_State.WantCapturing;
 		if (g_State.Capturing != newCapture)
 		{
+			if (newCapture)
+				++g_State.CallstackGeneration;
 			for (auto tstate : g_State.Threads)
+			{
 				tstate->Capture = newCapture;
+				if (!newCapture)
+					RequestFlush(tstate);
+			}
 		}
 		g_State.Capturing = newCapture;
 
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::HRFrame(state);
+		else
+			FlushIfRequested(state);
 	}
 } // namespace Profiler
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Aggregate.h"
 #include "State.h"
 #include "Timestamp.h"
 #include "Utils/Core.h"
@@ -26,34 +27,65 @@ namespace Profiler
 
 	inline void FunctionBegin(void* functionPtr)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
-		if (state->Capture)
-			Detail::FunctionBegin(state, functionPtr);
+		switch (BeginScope(state))
+		{
+		case EScopePath::Capture: Detail::FunctionBegin(state, functionPtr); break;
+		case EScopePath::Aggregate: Detail::AggregateBegin(state, reinterpret_cast<std::uintptr_t>(functionPtr)); break;
+		case EScopePath::None: break;
+		}
 	}
 
 	inline void FunctionEnd()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
-		if (state->Capture)
-			Detail::FunctionEnd(state);
+		switch (EndScope(state))
+		{
+		case EScopePath::Capture: Detail::FunctionEnd(state); break;
+		case EScopePath::Aggregate: Detail::AggregateEnd(state); break;
+		case EScopePath::None: break;
+		}
 	}
 
 	inline void HRFunctionBegin(void* functionPtr)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
-		if (state->Capture)
-			Detail::HRFunctionBegin(state, functionPtr);
+		switch (BeginScope(state))
+		{
+		case EScopePath::Capture: Detail::HRFunctionBegin(state, functionPtr); break;
+		case EScopePath::Aggregate: Detail::AggregateBegin(state, reinterpret_cast<std::uintptr_t>(functionPtr)); break;
+		case EScopePath::None: break;
+		}
 	}
 
 	inline void HRFunctionEnd()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
-		if (state->Capture)
-			Detail::HRFunctionEnd(state);
+		switch (EndScope(state))
+		{
+		case EScopePath::Capture: Detail::HRFunctionEnd(state); break;
+		case EScopePath::Aggregate: Detail::AggregateEnd(state); break;
+		case EScopePath::None: break;
+		}
 	}
 
 	inline void BoolArg(std::uint8_t offset, bool value)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::BoolArg(state, offset, value);
@@ -62,6 +94,9 @@ namespace Profiler
 	template <std::integral T>
 	inline void IntArg(std::uint8_t offset, T value, std::uint8_t base = 10)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 		{
@@ -74,6 +109,9 @@ namespace Profiler
 	template <std::floating_point T>
 	inline void FloatArg(std::uint8_t offset, T value)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 		{
@@ -86,6 +124,9 @@ namespace Profiler
 	/*template <class T>
 	inline void FlagsArg(std::uint8_t offset, Utils::Flags<T> flags)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 		{
@@ -97,6 +138,9 @@ namespace Profiler
 
 	inline void PtrArg(std::uint8_t offset, void* ptr)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::PtrArg(state, offset, ptr);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include <string_view>
+
+namespace Profiler
+{
+	// Code built with -finstrument-functions (premake --instrument-functions) calls the profiler's
+	// __cyg_profile_func_enter and __cyg_profile_func_exit hooks, which record every call like HRFunction does.
+	// Calls into excluded code are skipped, as are calls made while a hook runs.
+	void ExcludeInstrumentedRange(std::uint64_t start, std::uint64_t end);
+	// Matches a module's path or file name, modules loaded later are matched when they load.
+	void ExcludeInstrumentedModule(std::string_view name);
+	void ClearInstrumentExclusions();
+
+	namespace Detail
+	{
+		// Reads PROFILER_INSTRUMENT_EXCLUDE, module names and start-end address ranges separated by commas. Called by Init.
+		void LoadInstrumentExclusions();
+		// Maps excluded modules to their address ranges, called whenever modules load or unload.
+		void UpdateInstrumentExclusions();
+		void FreeInstrumentExclusions();
+	} // namespace Detail
+} // namespace Profiler
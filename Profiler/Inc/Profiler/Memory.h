@@ -16,6 +16,9 @@ namespace Profiler
 
 	inline void MemAlloc(void* memory, std::uint64_t size)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::MemAlloc(state, memory, size);
@@ -23,6 +26,9 @@ namespace Profiler
 
 	inline void HRMemAlloc(void* memory, std::uint64_t size)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::HRMemAlloc(state, memory, size);
@@ -30,6 +36,9 @@ namespace Profiler
 
 	inline void MemFree(void* memory)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::MemFree(state, memory);
@@ -37,6 +46,9 @@ namespace Profiler
 
 	inline void HRMemFree(void* memory)
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::HRMemFree(state, memory);
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+namespace Profiler
+{
+	// A module the process had loaded, a runtime address maps to the link time address - Base.
+	// Times are monotonic nanoseconds, LoadTime is 0 for modules loaded before Init and UnloadTime is 0 while loaded.
+	struct LoadedModule
+	{
+	public:
+		std::uint64_t Base;
+		std::uint64_t Start;
+		std::uint64_t End;
+		std::uint64_t LoadTime;
+		std::uint64_t UnloadTime;
+		std::string   Path;
+		std::string   BuildID;
+	};
+
+	// Records the loaded modules through dl_iterate_phdr, called by Init.
+	void LoadModules();
+	// Diffs the loaded modules against the table, cheap when the loader's counters have not moved.
+	// New modules also get their unwind tables loaded. Called by Frame while capturing and whenever capturing starts.
+	// Returns true if a module was loaded or unloaded.
+	bool UpdateModules();
+	// Every module seen since Init sorted by Start, unloaded modules included.
+	std::vector<LoadedModule> ModuleSnapshot();
+	// The module containing `address`, the one mapped there last if modules were loaded at the same place one after another:
+	// still loaded modules first, then the latest unloaded. Load and unload times are not matched against event times,
+	// symbols are resolved per address, so events from before an address range was reused resolve to its later module.
+	const LoadedModule* FindModule(const std::vector<LoadedModule>& modules, std::uint64_t address);
+} // namespace Profiler
@@ -1,11 +1,25 @@
 #pragma once
 
+#include "Aggregate.h"
+#include "CallTree.h"
 #include "Callstack.h"
+#include "Capture.h"
+#include "CaptureAnalysis.h"
+#include "CaptureReader.h"
+#include "ClockDomain.h"
+#include "Collector.h"
 #include "Data.h"
 #include "ForLoop.h"
 #include "Frame.h"
 #include "Function.h"
+#include "Instrument.h"
 #include "Memory.h"
+#include "Modules.h"
 #include "Runtime.h"
+#include "Sampling.h"
 #include "State.h"
-#include "Thread.h"
\ No newline at end of file
+#include "Symbols.h"
+#include "Thread.h"
+#include "Unwind.h"
+#include "Zone.h"
+#include "ZoneStack.h"
\ No newline at end of file
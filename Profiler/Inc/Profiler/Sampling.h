@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Utils/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Profiler
+{
+	class ThreadState;
+	struct ThreadSampler;
+
+	// Samples a thread buffers between drains, samples taken while its buffer is full are dropped.
+	static constexpr std::size_t c_SampleBufferSize = 256;
+
+	// Interrupts every registered thread `frequency` times per second of CPU time it uses and records its callstack,
+	// capturing threads store the stacks as Sample events next to their zones. Threads registering later start sampling
+	// as they register. Returns false if the platform has no per thread CPU timers.
+	bool StartSampling(std::uint32_t frequency);
+	void StopSampling();
+	bool IsSampling();
+
+	namespace Detail
+	{
+		// Called by State with ThreadsMutex held on the thread itself, takes a free sampler or creates one and starts its
+		// timer while sampling. Stopping returns the sampler for reuse.
+		void PrepareThreadSampling(ThreadState* state);
+		void StopThreadSampling(ThreadState* state);
+
+		// Moves buffered samples into the thread's events, done when a thread publishes a block, flushes or ends a frame.
+		// Only the thread itself may drain, its handler and its events are the two ends of the buffer.
+		BUILD_NEVER_INLINE void DrainSamples(ThreadState* state);
+	} // namespace Detail
+} // namespace Profiler
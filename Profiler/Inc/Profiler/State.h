@@ -1,13 +1,23 @@
 #pragma once
 
+#include "Config.h"
+#include "Encoding.h"
+#include "Events.h"
+#include "Sampling.h"
+#include "Unwind.h"
+#include "Utils/BlockPool.h"
 #include "Utils/Core.h"
 #include "Utils/Flags.h"
+#include "Utils/MPSCQueue.h"
+#include "ZoneStack.h"
 
 #include <cstddef>
 #include <cstdint>
 
 #include <atomic>
+#include <filesystem>
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace Profiler
@@ -18,333 +28,313 @@ namespace Profiler
 	{
 		static constexpr EAbilities InvariantCPUClock = 1;
 		static constexpr EAbilities IBS               = 2;
+		static constexpr EAbilities RDTSCP            = 4;
 	} // namespace Abilities
 
-	enum class EEventType : std::uint8_t
-	{
-		Unknown = 0,
-		ThreadBounds,
-		ThreadBegin,
-		ThreadEnd,
-		Frame,
-		FunctionBegin,
-		FunctionEnd,
-		Callstack,
-		BoolArgument,
-		IntArgument,
-		FloatArgument,
-		FlagsArgument,
-		PtrArgument,
-		ForLoopBegin,
-		ForLoopEnd,
-		ForLoopIterBegin,
-		ForLoopIterEnd,
-		MemAlloc,
-		MemFree,
-		DataHeader
-	};
-
-	struct EventTimestamp
-	{
-		std::uint64_t Time : 63;
-		std::uint64_t Type : 1;
-	};
-
-	struct Event
-	{
-	public:
-		Event()
-			: Type(EEventType::Unknown),
-			  Data { 0 } {}
-
-		Event(EEventType type)
-			: Type(type),
-			  Data { 0 } {}
-
-	public:
-		EEventType   Type;
-		std::uint8_t Data[31];
-	};
-
-	struct ThreadBoundsEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::ThreadBounds;
-
-	public:
-		EEventType    Type;
-		std::uint64_t ThreadID;
-		std::uint64_t Length;
-	};
-
-	struct ThreadBeginEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::ThreadBegin;
-
-	public:
-		EEventType     Type;
-		EventTimestamp Timestamp;
-	};
-
-	struct ThreadEndEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::ThreadEnd;
-
-	public:
-		EEventType     Type;
-		EventTimestamp Timestamp;
-	};
-
-	struct FrameEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::Frame;
+	static constexpr std::size_t c_EventBlockSize   = 128;
+	static constexpr std::size_t c_EncodedBlockSize = 16384;
 
-	public:
-		EEventType     Type;
-		std::uint64_t  FrameNum;
-		EventTimestamp Timestamp;
-	};
+	// Zone IDs below this can be silenced at runtime, zones past it are always enabled.
+	static constexpr std::size_t c_MaxFilteredZones = 16384;
 
-	struct FunctionBeginEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::FunctionBegin;
+	// Calls nested deeper than this under -finstrument-functions are not recorded.
+	static constexpr std::size_t c_MaxInstrumentDepth = 256;
 
-	public:
-		EEventType     Type;
-		void*          FunctionPtr;
-		EventTimestamp Timestamp;
-	};
+	// Functions and zones nested deeper than this are not recorded.
+	static constexpr std::size_t c_MaxScopeDepth = 4096;
 
-	struct FunctionEndEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::FunctionEnd;
+	// Nanoseconds FlushThreads waits for other threads to publish their buffers.
+	static constexpr std::uint64_t c_FlushTimeout = 10'000'000;
 
-	public:
-		EEventType     Type;
-		EventTimestamp Timestamp;
-	};
+	// Nanoseconds between clock samples taken while capturing.
+	static constexpr std::uint64_t c_ClockSampleInterval = 100'000'000;
 
-	struct CallstackEvent
+	// A paired reading of the HR ticks, monotonic nanoseconds and the LR clock, readers use these to put
+	// both timestamp types on one timeline.
+	struct ClockSample
 	{
 	public:
-		static constexpr EEventType c_Type = EEventType::Callstack;
-
-	public:
-		EEventType    Type;
-		std::uint64_t DataID;
-		std::uint64_t NumEntries;
+		std::uint64_t Ticks;
+		std::uint64_t Nanoseconds;
+		std::uint64_t LowResTime;
 	};
 
-	struct BoolArgumentEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::BoolArgument;
-
-	public:
-		EEventType   Type;
-		std::uint8_t Offset;
-		std::uint8_t Pad[6];
-		bool         Value;
-	};
+	class EventChain;
+	struct AggregateTable;
+	struct CallstackTable;
+	struct ThreadCallTree;
+	struct ZoneDescriptor;
 
-	struct IntArgumentEvent
+	namespace Detail
 	{
-	public:
-		static constexpr EEventType c_Type = EEventType::IntArgument;
-
-	public:
-		EEventType    Type;
-		std::uint8_t  Offset;
-		std::uint8_t  Size;
-		std::uint8_t  Base;
-		std::uint8_t  Pad[4];
-		std::uint64_t Data[3];
-	};
-
-	struct FloatArgumentEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::FloatArgument;
-
-	public:
-		EEventType    Type;
-		std::uint8_t  Offset;
-		std::uint8_t  Size;
-		std::uint8_t  Pad[5];
-		std::uint64_t Data[3];
-	};
-
-	struct FlagsArgumentEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::FlagsArgument;
-
-	public:
-		EEventType    Type;
-		std::uint8_t  Offset;
-		std::uint8_t  Pad[6];
-		std::uint64_t FlagsType;
-		std::uint64_t Data[2];
-	};
+		// Called by State with ThreadsMutex held when a thread is removed, returns the thread's tables for reuse.
+		void RetireAggregates(ThreadState* state);
+		void RetireCallstacks(ThreadState* state);
+		void RetireCallTree(ThreadState* state);
+	} // namespace Detail
 
-	struct PtrArgumentEvent
+	struct EventBlock
 	{
 	public:
-		static constexpr EEventType c_Type = EEventType::PtrArgument;
-
-	public:
-		EEventType   Type;
-		std::uint8_t Offset;
-		std::uint8_t Pad[6];
-		void*        Ptr;
+		std::atomic<EventBlock*> Next     = nullptr;
+		EventChain*              Chain    = nullptr;
+		std::uint64_t            ThreadID = 0;
+		std::uint64_t            Count    = 0;
+		bool                     Seal     = false;
+		Event                    Events[c_EventBlockSize];
 	};
 
-	struct ForLoopBeginEvent
+	struct EncodedBlock
 	{
 	public:
-		static constexpr EEventType c_Type = EEventType::ForLoopBegin;
-
-	public:
-		EEventType     Type;
-		std::size_t    ID;
-		EventTimestamp Timestamp;
+		std::atomic<EncodedBlock*> Next     = nullptr;
+		std::uint64_t              ThreadID = 0;
+		std::uint32_t              Size     = 0;
+		std::uint32_t              Count    = 0;
+		std::uint8_t               Data[c_EncodedBlockSize];
 	};
 
-	struct ForLoopEndEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::ForLoopEnd;
-
-	public:
-		EEventType     Type;
-		std::uint64_t  ID;
-		EventTimestamp Timestamp;
-	};
+	using EventBlockPool   = Utils::BlockPool<EventBlock>;
+	using EncodedBlockPool = Utils::BlockPool<EncodedBlock>;
 
-	struct ForLoopIterBeginEvent
+	// Single producer chain of encoded blocks, the producer encodes raw event blocks into the current encoded block
+	// and links finished blocks with a release store. Any consumer can walk the published blocks with acquire loads
+	// without ever blocking the producer.
+	class EventChain
 	{
 	public:
-		static constexpr EEventType c_Type = EEventType::ForLoopIterBegin;
+		// Encodes and releases a raw block, only one thread may store into a chain at a time.
+		void store(EventBlock* block);
 
-	public:
-		EEventType     Type;
-		std::uint8_t   Size;
-		std::uint8_t   Pad[6];
-		std::uint64_t  ID;
-		EventTimestamp Timestamp;
-		std::uint64_t  Index[2];
-	};
+		EncodedBlock* first() const { return m_Head.load(std::memory_order_acquire); }
 
-	struct ForLoopIterEndEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::ForLoopIterEnd;
+		static EncodedBlock* next(EncodedBlock* block) { return block->Next.load(std::memory_order_acquire); }
 
-	public:
-		EEventType     Type;
-		std::uint8_t   Pad[7];
-		std::uint64_t  ID;
-		EventTimestamp Timestamp;
-	};
+		// Detaches every published block, only the thread storing into the chain may take from it.
+		EncodedBlock* take()
+		{
+			EncodedBlock* block = m_Head.exchange(nullptr, std::memory_order_acquire);
+			m_Tail              = nullptr;
+			return block;
+		}
 
-	struct MemAllocEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::MemAlloc;
+		void clear(EncodedBlockPool& pool)
+		{
+			EncodedBlock* block = m_Head.exchange(nullptr, std::memory_order_acquire);
+			while (block)
+			{
+				EncodedBlock* nextBlock = next(block);
+				pool.release(block);
+				block = nextBlock;
+			}
+			if (m_Current)
+				pool.release(m_Current);
+			m_Tail    = nullptr;
+			m_Current = nullptr;
+			m_Encoder.reset();
+		}
 
-	public:
-		EEventType     Type;
-		void*          Memory;
-		std::uint64_t  Size;
-		EventTimestamp Timestamp;
-	};
+	private:
+		void publish(EncodedBlock* block)
+		{
+			block->Next.store(nullptr, std::memory_order_relaxed);
+			if (m_Tail)
+				m_Tail->Next.store(block, std::memory_order_release);
+			else
+				m_Head.store(block, std::memory_order_release);
+			m_Tail = block;
+		}
 
-	struct MemFreeEvent
-	{
-	public:
-		static constexpr EEventType c_Type = EEventType::MemFree;
+		void seal();
 
-	public:
-		EEventType     Type;
-		void*          Memory;
-		EventTimestamp Timestamp;
+	private:
+		std::atomic<EncodedBlock*> m_Head    = nullptr;
+		EncodedBlock*              m_Tail    = nullptr;
+		EncodedBlock*              m_Current = nullptr;
+		EventEncoder               m_Encoder;
 	};
 
-	struct DataHeaderEvent
+	// Path a function or zone began on, its end takes the same one even if the thread's mode changed in between.
+	enum class EScopePath : std::uint8_t
 	{
-	public:
-		static constexpr EEventType c_Type = EEventType::DataHeader;
-
-	public:
-		EEventType    Type;
-		std::uint64_t Size;
-		std::uint64_t ID;
+		None,
+		Capture,
+		Aggregate
 	};
 
-	struct DataSectionEvent
+	enum class EStreamingPolicy : std::uint8_t
 	{
-	public:
-		std::uint8_t Data[32];
+		Block,
+		Drop
 	};
 
 	class alignas(32) ThreadState
 	{
 	public:
-		std::uint64_t    ThreadID      = 0;
-		std::uint64_t    FunctionDepth = 0;
-		std::uint64_t    ForLoopDepth  = 0;
-		std::uint8_t     CurrentIndex  = 0;
-		std::atomic_bool Capture       = false;
-		Event            Buffer[128];
+		std::uint64_t    ThreadID       = 0;
+		std::uint64_t    FunctionDepth  = 0;
+		std::uint64_t    ForLoopDepth   = 0;
+		std::uint8_t     CurrentIndex   = 0;
+		std::atomic_bool Capture        = false;
+		std::atomic_bool Aggregate      = false;
+		std::atomic_bool FlushRequested = false; // Set by other threads, only the owner may publish its buffer
+		EventBlock*      Buffer         = nullptr;
+		EventChain*      Chain          = nullptr;
+		AggregateTable*  Aggregates     = nullptr;
+		ThreadCallTree*  CallTree       = nullptr;
+		CallstackTable*  Callstacks     = nullptr;
+		ThreadSampler*   Sampler        = nullptr;
+		ZoneStack        OpenZones;
+
+		// Section slots of the data record being written that are not taken yet, BufferInData is set when the buffer
+		// starts inside a record. Blocks holding part of a record are never dropped.
+		std::uint64_t DataSlots    = 0;
+		bool          BufferInData = false;
+
+		// Functions and zones the thread is inside of, bit n of ScopeCaptured or ScopeAggregated is set if the one at
+		// depth n began capturing or aggregating.
+		std::uint64_t ScopeDepth = 0;
+		std::uint64_t ScopeCaptured[c_MaxScopeDepth / 64] {};
+		std::uint64_t ScopeAggregated[c_MaxScopeDepth / 64] {};
+
+		// Calls the -finstrument-functions hooks are inside of, bit n of InstrumentBegun is set if the call at depth n
+		// began a function and bit n of InstrumentAggregated if it began one aggregating. InstrumentOpen counts the
+		// captured ones, InInstrumentHook stops code the hooks run from recursing.
+		std::uint64_t InstrumentDepth  = 0;
+		std::uint64_t InstrumentOpen   = 0;
+		bool          InInstrumentHook = false;
+		std::uint64_t InstrumentBegun[c_MaxInstrumentDepth / 64] {};
+		std::uint64_t InstrumentAggregated[c_MaxInstrumentDepth / 64] {};
 	};
 
 	class State
 	{
 	public:
-		void pushEvents(Event* events, std::size_t count, std::uint64_t threadID)
-		{
-			EventMutex.lock();
-			ThreadBoundsEvent* bounds = reinterpret_cast<ThreadBoundsEvent*>(&Events.emplace_back(ThreadBoundsEvent::c_Type));
-			bounds->ThreadID          = threadID;
-			bounds->Length            = count;
-			Events.insert(Events.end(), events, events + count);
-			EventMutex.unlock();
-		}
-
 		void addThread(ThreadState* state)
 		{
+			PrepareThreadUnwinding();
 			ThreadsMutex.lock();
+			if (!state->Chain)
+			{
+				state->Chain  = Chains.emplace_back(new EventChain());
+				state->Buffer = Blocks.acquire();
+			}
 			Threads.emplace_back(state);
+			Detail::PrepareThreadSampling(state);
 			ThreadsMutex.unlock();
-			state->Capture = Initialized && Capturing;
+			state->Capture   = Initialized && Capturing;
+			state->Aggregate = Initialized && Aggregating;
 		}
 
 		void removeThread(ThreadState* state)
 		{
 			ThreadsMutex.lock();
 			std::erase(Threads, state);
+			Detail::StopThreadSampling(state);
+			Detail::RetireAggregates(state);
+			Detail::RetireCallstacks(state);
+			Detail::RetireCallTree(state);
 			ThreadsMutex.unlock();
 		}
 
-	public:
-		bool Initialized   = false;
-		bool Capturing     = false;
-		bool WantCapturing = false;
+		// Memory held by blocks that were handed to the collector but are not stored yet.
+		std::size_t pendingMemoryUsage() const { return PendingCount.load(std::memory_order_relaxed) * sizeof(EventBlock); }
 
-		EAbilities Abilities = 0;
+		void clearEvents()
+		{
+			std::lock_guard readersLock(ChainReadersMutex);
+			ThreadsMutex.lock();
+			for (auto chain : Chains)
+				chain->clear(EncodedBlocks);
+			ThreadsMutex.unlock();
+		}
 
-		std::vector<Event> Events;
-		std::mutex         EventMutex;
+		// Chains are never freed, so a copy of the list taken under ThreadsMutex stays valid without it.
+		std::vector<EventChain*> chains()
+		{
+			std::lock_guard lock(ThreadsMutex);
+			return Chains;
+		}
+
+	public:
+		bool Initialized       = false;
+		bool Capturing         = false;
+		bool WantCapturing     = false;
+		bool Aggregating       = false;
+		bool BuildCallTrees    = false;
+		bool SampleZoneStacks  = false;
+		bool SymbolizeCaptures = true;
 
-		std::uint64_t        CurrentFrame  = 0;
-		std::atomic_uint64_t CurrentDataID = 0;
+		EAbilities Abilities = 0;
 
+		EventBlockPool               Blocks;
+		EncodedBlockPool             EncodedBlocks;
+		std::vector<EventChain*>     Chains;
+		std::mutex                   ChainReadersMutex; // Held while published blocks are read or freed, so no one frees blocks under a reader
+		Utils::MPSCQueue<EventBlock> PendingBlocks;
+		std::atomic_size_t           PendingCount      = 0; // Raised before UseCollector is read, so a stopping collector sees every push
+		std::atomic_bool             UseCollector      = false;
+		std::atomic_bool             CollectorDraining = false; // Threads wait for the collector's last drain before storing directly
+
+		std::atomic_bool     Streaming              = false;
+		EStreamingPolicy     StreamingPolicy        = EStreamingPolicy::Block;
+		std::size_t          StreamingHighWaterMark = 0;
+		std::atomic_uint64_t DroppedBlocks          = 0;
+		std::atomic_uint64_t DroppedEvents          = 0;
+		std::atomic_uint64_t DroppedSamples         = 0;
+
+		std::uint64_t        CurrentFrame        = 0;
+		std::atomic_uint64_t CurrentDataID       = 0;
+		std::atomic_uint32_t CallstackGeneration = 0; // Threads forget their interned stacks when it changes
+
+		// HR timestamps map to monotonic nanoseconds as Epoch + ((ticks - Offset) * Scale >> 32).
 		std::uint64_t InvariantClockFrequency = 0;
+		std::uint64_t InvariantClockOffset    = 0;
+		std::uint64_t InvariantClockEpoch     = 0;
+		std::uint64_t InvariantClockScale     = 0;
+
+		std::vector<ClockSample> ClockSamples;
+		std::mutex               ClockSamplesMutex;
+		std::atomic_uint64_t     LastClockSample = 0;
+
+		// Registered for the life of the process, not cleared with the rest of the state.
+		std::vector<const ZoneDescriptor*> ZoneDescriptors;
+		std::mutex                         ZoneDescriptorsMutex;
+
+		// One bit per zone ID, a set bit silences the zone. Names are matched against zones as they register,
+		// guarded by ZoneDescriptorsMutex.
+		std::atomic_uint64_t     DisabledZones[c_MaxFilteredZones / 64] {};
+		std::vector<std::string> DisabledZoneNames;
+
+		// While AutoDisableFrames is set zone calls are counted per ID, zones averaging more than
+		// AutoDisableMaxCalls per frame are silenced until that many frames have passed.
+		std::atomic_uint64_t AutoDisableFrames   = 0;
+		std::uint64_t        AutoDisableMaxCalls = 0;
+		std::uint64_t        AutoDisableElapsed  = 0;
+		std::atomic_uint64_t ZoneCalls[c_MaxFilteredZones] {};
+
+		// Tables of running threads, guarded by ThreadsMutex. Tables from an older generation count as empty, a new
+		// epoch only drops the open zones of each table. Tables of ended threads are folded into one set of retired
+		// statistics and kept for reuse in FreeAggregateTables.
+		std::vector<AggregateTable*> AggregateTables;
+		std::vector<AggregateTable*> FreeAggregateTables;
+
+		// Interned stack tables of ended threads kept for reuse, guarded by ThreadsMutex.
+		std::vector<CallstackTable*> FreeCallstackTables;
+		std::atomic_uint32_t         AggregateGeneration = 0;
+		std::atomic_uint32_t         AggregateEpoch      = 0;
+
+		// Trees of running threads, guarded by ThreadsMutex. Trees from an older generation count as empty. Trees of
+		// ended threads are folded into one retired tree and kept for reuse in FreeCallTrees.
+		std::vector<ThreadCallTree*> CallTrees;
+		std::vector<ThreadCallTree*> FreeCallTrees;
+		std::atomic_uint32_t         CallTreeGeneration = 0;
+
+		// Samplers and their sample buffers outlive Deinit, guarded by ThreadsMutex. Samplers of ended threads are kept
+		// for reuse in FreeSamplers. A frequency of 0 means not sampling.
+		std::vector<ThreadSampler*> Samplers;
+		std::vector<ThreadSampler*> FreeSamplers;
+		std::uint32_t               SamplingFrequency = 0;
 
 		std::vector<ThreadState*> Threads;
 		std::mutex                ThreadsMutex;
@@ -354,11 +344,19 @@ namespace Profiler
 	void Init();
 	void Deinit();
 	void WantCapturing(bool capture, bool instant = false);
-	void WriteCaptures();
+	// Publishes the calling thread's buffer and asks every other thread to publish theirs, waiting up to c_FlushTimeout
+	// for them. Threads blocked for longer publish on their next event, function or zone, Frame or ThreadEnd.
+	void FlushThreads();
+	bool WriteCaptures(const std::filesystem::path& filepath);
 
 	std::uint64_t GetThreadID();
 	bool          IsMainThread();
 
+	std::uint64_t MonotonicNanoseconds();
+	ClockSample   SampleClocks();
+	// Records a clock sample if the last one is older than c_ClockSampleInterval, or always when forced.
+	void          RecordClockSample(bool force = false);
+
 	extern State g_State;
 
 	extern thread_local ThreadState g_TState;
@@ -368,16 +366,23 @@ namespace Profiler
 		return g_State.CurrentDataID++;
 	}
 
+	BUILD_NEVER_INLINE void PublishEvents(ThreadState* state, std::size_t count, bool seal);
+
 	template <class T>
 	inline T& NewEvent(ThreadState* state)
 	{
 		std::uint8_t ci = state->CurrentIndex;
 		if (ci & 0x80)
 		{
-			g_State.pushEvents(state->Buffer, 128, state->ThreadID);
+			PublishEvents(state, c_EventBlockSize, false);
 			ci = 0;
 		}
-		T& elem = *reinterpret_cast<T*>(&state->Buffer[ci]);
+		else if (state->FlushRequested.load(std::memory_order_relaxed))
+		{
+			PublishEvents(state, ci, true);
+			ci = state->CurrentIndex;
+		}
+		T& elem = *reinterpret_cast<T*>(&state->Buffer->Events[ci]);
 		if constexpr (requires { T::c_Type; })
 			elem.Type = T::c_Type;
 		state->CurrentIndex = ci + 1;
@@ -386,8 +391,66 @@ namespace Profiler
 
 	inline void FlushEvents(ThreadState* state)
 	{
-		g_State.pushEvents(state->Buffer, state->CurrentIndex, state->ThreadID);
-		state->CurrentIndex = 0;
+		PublishEvents(state, state->CurrentIndex, true);
+	}
+
+	// Asks a thread to flush, it does so on its next event, function or zone, Frame or ThreadEnd and clears the
+	// request once its buffer is published.
+	inline void RequestFlush(ThreadState* state)
+	{
+		state->FlushRequested.store(true, std::memory_order_relaxed);
+	}
+
+	// Honours a flush request while the thread is not capturing.
+	inline void FlushIfRequested(ThreadState* state)
+	{
+		if (state->FlushRequested.load(std::memory_order_relaxed))
+			FlushEvents(state);
+	}
+
+	// Opens a function or zone on the path the thread's current mode selects, honours flush requests while not capturing.
+	inline EScopePath BeginScope(ThreadState* state)
+	{
+		std::uint64_t depth = state->ScopeDepth++;
+		if (depth >= c_MaxScopeDepth)
+			return EScopePath::None;
+
+		std::uint64_t  bit        = 1ULL << (depth & 63);
+		std::uint64_t& captured   = state->ScopeCaptured[depth >> 6];
+		std::uint64_t& aggregated = state->ScopeAggregated[depth >> 6];
+		if (state->Capture)
+		{
+			captured   |= bit;
+			aggregated &= ~bit;
+			return EScopePath::Capture;
+		}
+		captured &= ~bit;
+		FlushIfRequested(state);
+		if (state->Aggregate)
+		{
+			aggregated |= bit;
+			return EScopePath::Aggregate;
+		}
+		aggregated &= ~bit;
+		return EScopePath::None;
+	}
+
+	// Closes the innermost open function or zone and returns the path it began on, ends without a begin take none.
+	inline EScopePath EndScope(ThreadState* state)
+	{
+		if (!state->ScopeDepth)
+			return EScopePath::None;
+
+		std::uint64_t depth = --state->ScopeDepth;
+		if (depth >= c_MaxScopeDepth)
+			return EScopePath::None;
+
+		std::uint64_t bit = 1ULL << (depth & 63);
+		if (state->ScopeCaptured[depth >> 6] & bit)
+			return EScopePath::Capture;
+		if (state->ScopeAggregated[depth >> 6] & bit)
+			return EScopePath::Aggregate;
+		return EScopePath::None;
 	}
 
 	inline ThreadState* GetThreadState()
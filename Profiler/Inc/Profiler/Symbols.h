@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Modules.h"
+#include "State.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Profiler
+{
+	// Function symbol at its runtime address, Size is 0 if the symbol table did not record one.
+	struct ResolvedSymbol
+	{
+	public:
+		std::uint64_t Address;
+		std::uint64_t Size;
+		std::string   Name;
+	};
+
+	// Source position of one frame, Function and File index ResolvedLines::Strings, ~0U if unknown.
+	struct SourceFrame
+	{
+	public:
+		std::uint32_t Function;
+		std::uint32_t File;
+		std::uint32_t Line;
+		std::uint32_t Column;
+	};
+
+	// Frames of one address, innermost inlined frame first and the function containing the address last.
+	struct SourceLocation
+	{
+	public:
+		std::uint64_t Address;
+		std::uint32_t FirstFrame;
+		std::uint32_t FrameCount;
+	};
+
+	struct ResolvedLines
+	{
+	public:
+		std::vector<std::string>    Strings;
+		std::vector<SourceLocation> Locations; // Sorted by address
+		std::vector<SourceFrame>    Frames;
+	};
+
+	// Resolves addresses to the demangled .symtab or .dynsym function symbols containing them, one per symbol found.
+	// Addresses are batched per module and modules are resolved in parallel. Symbol tables are cached in memory and
+	// on disk keyed by build ID in $PROFILER_SYMBOL_CACHE, $XDG_CACHE_HOME/profiler/symbols or ~/.cache/profiler/symbols,
+	// an empty PROFILER_SYMBOL_CACHE disables the disk cache. Returns nothing on platforms without ELF modules.
+	// Module files are looked up at their recorded path, then in `searchPaths` by file name, as <build ID>.debug and in
+	// .build-id/xx/rest.debug, and a file whose build ID differs from the module's is never used.
+	std::vector<ResolvedSymbol> ResolveSymbols(const std::vector<std::uint64_t>& addresses, const std::vector<LoadedModule>& modules, const std::vector<std::filesystem::path>& searchPaths = {});
+	// Resolves against the modules the process has loaded since Init.
+	std::vector<ResolvedSymbol> ResolveSymbols(const std::vector<std::uint64_t>& addresses);
+
+	// Resolves addresses to file, line and inlined frames through the modules' .debug_line and .debug_info, or their
+	// separate debug files. Each module's DWARF is indexed once per process, lookups are binary searches.
+	// Return addresses are looked up at the call before them. Addresses without line info are left out.
+	ResolvedLines ResolveLines(const std::vector<std::uint64_t>& addresses, const std::vector<std::uint64_t>& returnAddresses, const std::vector<LoadedModule>& modules, const std::vector<std::filesystem::path>& searchPaths = {});
+	ResolvedLines ResolveLines(const std::vector<std::uint64_t>& addresses, const std::vector<std::uint64_t>& returnAddresses);
+
+	// While set, captures get their Symbols and Lines chunks resolved when written. Without it the instrumented process
+	// pays nothing for symbols and SymbolizeCapture resolves the capture later through its module table.
+	// Change it while not capturing.
+	void SetCaptureSymbolization(bool enabled);
+	bool IsCaptureSymbolization();
+
+	// Gathers the code addresses a capture references: function pointers and the frames of callstacks and samples.
+	// Blocks of a thread have to be collected in order, stack data may continue in the next block.
+	class SymbolAddressCollector
+	{
+	public:
+		void collect(const EncodedBlock* block);
+		// Events of a thread have to be passed in order, as for blocks.
+		void collect(std::uint64_t threadID, const Event& event, EEventType type);
+
+		std::vector<std::uint64_t> addresses() const;
+		// Addresses only seen as return addresses, i.e. callstack frames and sample frames past the first.
+		std::vector<std::uint64_t> returnAddresses() const;
+
+		void clear()
+		{
+			m_Addresses.clear();
+			m_Data.clear();
+		}
+
+	private:
+		struct PendingData
+		{
+		public:
+			std::uint64_t             ID        = ~0ULL;
+			std::uint64_t             Remaining = 0;
+			std::vector<std::uint8_t> Bytes;
+		};
+
+		enum class EStackKind
+		{
+			Callstack,
+			Sample,
+			ZoneKeys
+		};
+
+	private:
+		void add(std::uint64_t address, bool returnAddress);
+		void addStack(const PendingData& data, std::uint64_t dataID, EStackKind kind);
+
+	private:
+		std::unordered_map<std::uint64_t, bool>        m_Addresses; // Address to whether it was only seen as a return address
+		std::unordered_map<std::uint64_t, PendingData> m_Data;
+	};
+} // namespace Profiler
@@ -16,7 +16,11 @@ namespace Profiler
 
 	inline void ThreadBegin()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
+		state->ThreadID    = GetThreadID();
 		g_State.addThread(state);
 		if (state->Capture)
 			Detail::ThreadBegin(state);
@@ -24,16 +28,25 @@ namespace Profiler
 
 	inline void ThreadEnd()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::ThreadEnd(state);
+		else
+			FlushIfRequested(state);
 		g_State.removeThread(state);
 		FreeThreadState(state);
 	}
 
 	inline void HRThreadBegin()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
+		state->ThreadID    = GetThreadID();
 		g_State.addThread(state);
 		if (state->Capture)
 			Detail::HRThreadBegin(state);
@@ -41,9 +54,14 @@ namespace Profiler
 
 	inline void HRThreadEnd()
 	{
+		if constexpr (!c_ProfilerEnabled)
+			return;
+
 		ThreadState* state = GetThreadState();
 		if (state->Capture)
 			Detail::HRThreadEnd(state);
+		else
+			FlushIfRequested(state);
 		g_State.removeThread(state);
 		FreeThreadState(state);
 	}
@@ -7,18 +7,166 @@
 #include <cstdint>
 
 #include <chrono>
+#include <vector>
+
+#if BUILD_IS_SYSTEM_UNIX
+	#include <time.h>
+#endif
+
+// The clock every zone type reads is chosen at compile time, LR and HR zones of a type can use different sources.
+// PROFILER_LOW_RES_CLOCK and PROFILER_HIGH_RES_CLOCK set the defaults, PROFILER_<TYPE>_CLOCKS overrides one zone type
+// with a "lowRes, highRes" pair, e.g. -DPROFILER_FUNCTION_CLOCKS=MonotonicCoarse,Rdtscp
+#ifndef PROFILER_LOW_RES_CLOCK
+	#define PROFILER_LOW_RES_CLOCK Monotonic
+#endif
+#ifndef PROFILER_HIGH_RES_CLOCK
+	#define PROFILER_HIGH_RES_CLOCK Rdtsc
+#endif
+#ifndef PROFILER_FUNCTION_CLOCKS
+	#define PROFILER_FUNCTION_CLOCKS PROFILER_LOW_RES_CLOCK, PROFILER_HIGH_RES_CLOCK
+#endif
+#ifndef PROFILER_FOR_LOOP_CLOCKS
+	#define PROFILER_FOR_LOOP_CLOCKS PROFILER_LOW_RES_CLOCK, PROFILER_HIGH_RES_CLOCK
+#endif
+#ifndef PROFILER_FRAME_CLOCKS
+	#define PROFILER_FRAME_CLOCKS PROFILER_LOW_RES_CLOCK, PROFILER_HIGH_RES_CLOCK
+#endif
+#ifndef PROFILER_THREAD_CLOCKS
+	#define PROFILER_THREAD_CLOCKS PROFILER_LOW_RES_CLOCK, PROFILER_HIGH_RES_CLOCK
+#endif
+#ifndef PROFILER_MEMORY_CLOCKS
+	#define PROFILER_MEMORY_CLOCKS PROFILER_LOW_RES_CLOCK, PROFILER_HIGH_RES_CLOCK
+#endif
+#ifndef PROFILER_SAMPLE_CLOCKS
+	#define PROFILER_SAMPLE_CLOCKS PROFILER_LOW_RES_CLOCK, PROFILER_HIGH_RES_CLOCK
+#endif
 
 namespace Profiler
 {
+	// Monotonic sources store CLOCK_MONOTONIC nanoseconds as LR timestamps, TSC sources store ticks as HR timestamps.
+	enum class EClockSource : std::uint8_t
+	{
+		Monotonic,       // clock_gettime through the vDSO, std::chrono::steady_clock elsewhere
+		MonotonicCoarse, // CLOCK_MONOTONIC_COARSE, cheapest read at scheduler tick resolution, Monotonic elsewhere
+		Rdtsc,           // Cheapest TSC read, may be reordered with the surrounding work
+		Rdtscp,          // Waits for earlier instructions, requires Abilities::RDTSCP
+		LfenceRdtsc      // Waits for earlier instructions on any CPU
+	};
+
+	constexpr bool IsHighResClock(EClockSource source)
+	{
+		return source >= EClockSource::Rdtsc;
+	}
+
+	enum class EZoneType : std::uint8_t
+	{
+		Default,
+		Function,
+		ForLoop,
+		Frame,
+		Thread,
+		Memory,
+		Sample // Read in signal handlers, every source is async signal safe
+	};
+
+	template <EZoneType Type>
+	struct ClockPolicy
+	{
+	public:
+		static constexpr EClockSource LowRes  = EClockSource::PROFILER_LOW_RES_CLOCK;
+		static constexpr EClockSource HighRes = EClockSource::PROFILER_HIGH_RES_CLOCK;
+	};
+
+#define PROFILER_CLOCK_POLICY_IMPL(type, lowRes, highRes) \
+	template <> \
+	struct ClockPolicy<EZoneType::type> \
+	{ \
+	public: \
+		static constexpr EClockSource LowRes  = EClockSource::lowRes; \
+		static constexpr EClockSource HighRes = EClockSource::highRes; \
+	};
+#define PROFILER_CLOCK_POLICY(type, clocks) PROFILER_CLOCK_POLICY_IMPL(type, clocks)
+
+	PROFILER_CLOCK_POLICY(Function, PROFILER_FUNCTION_CLOCKS)
+	PROFILER_CLOCK_POLICY(ForLoop, PROFILER_FOR_LOOP_CLOCKS)
+	PROFILER_CLOCK_POLICY(Frame, PROFILER_FRAME_CLOCKS)
+	PROFILER_CLOCK_POLICY(Thread, PROFILER_THREAD_CLOCKS)
+	PROFILER_CLOCK_POLICY(Memory, PROFILER_MEMORY_CLOCKS)
+	PROFILER_CLOCK_POLICY(Sample, PROFILER_SAMPLE_CLOCKS)
+
+#undef PROFILER_CLOCK_POLICY
+#undef PROFILER_CLOCK_POLICY_IMPL
+
+	template <EClockSource Source>
+	inline std::uint64_t ReadClock()
+	{
+		if constexpr (Source == EClockSource::Rdtsc)
+		{
+			return Utils::rdtsc();
+		}
+		else if constexpr (Source == EClockSource::Rdtscp)
+		{
+			return Utils::rdtscp();
+		}
+		else if constexpr (Source == EClockSource::LfenceRdtsc)
+		{
+			return Utils::lfenceRdtsc();
+		}
+		else
+		{
+#if BUILD_IS_SYSTEM_UNIX
+			timespec ts {};
+			clock_gettime(Source == EClockSource::MonotonicCoarse ? CLOCK_MONOTONIC_COARSE : CLOCK_MONOTONIC, &ts);
+			return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<std::uint64_t>(ts.tv_nsec);
+#else
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+		}
+	}
+
+	template <EClockSource Source>
+	inline void CaptureTimestamp(EventTimestamp& timestamp)
+	{
+		timestamp.Time = ReadClock<Source>();
+		timestamp.Type = IsHighResClock(Source);
+	}
+
+	template <EZoneType Type = EZoneType::Default>
 	inline void CaptureLowResTimestamp(EventTimestamp& timestamp)
 	{
-		timestamp.Time = std::chrono::high_resolution_clock::now().time_since_epoch().count();
-		timestamp.Type = 0;
+		CaptureTimestamp<ClockPolicy<Type>::LowRes>(timestamp);
 	}
 
+	template <EZoneType Type = EZoneType::Default>
 	inline void CaptureHighResTimestamp(EventTimestamp& timestamp)
 	{
-		timestamp.Time = Utils::rdtsc();
-		timestamp.Type = 1;
+		CaptureTimestamp<ClockPolicy<Type>::HighRes>(timestamp);
 	}
-} // namespace Profiler
\ No newline at end of file
+
+	// Converts a difference of two reads of Source to nanoseconds, HR durations stay in ticks without a TSC calibration.
+	template <EClockSource Source>
+	inline std::uint64_t DurationToNanoseconds(std::uint64_t duration)
+	{
+		if constexpr (!IsHighResClock(Source))
+			return duration;
+
+		std::uint64_t scale = g_State.InvariantClockScale;
+		if (!scale)
+			return duration;
+		std::uint64_t low = duration & 0xFFFF'FFFF;
+		return (duration >> 32) * scale + low * (scale >> 32) + ((low * (scale & 0xFFFF'FFFF)) >> 32);
+	}
+
+	struct ClockSourceInfo
+	{
+	public:
+		EClockSource Source;
+		bool         Supported;
+		double       Cost;       // Nanoseconds per read
+		double       Resolution; // Smallest step between two reads in nanoseconds
+	};
+
+	// Measures every clock source on the running machine, HR sources need the TSC calibration from Init().
+	ClockSourceInfo              MeasureClockSource(EClockSource source);
+	std::vector<ClockSourceInfo> MeasureClockSources();
+} // namespace Profiler
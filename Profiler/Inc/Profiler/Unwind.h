@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Utils/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Profiler
+{
+	// Registers of the frame an unwind starts at, PC is the exact instruction, e.g. taken from a signal's ucontext.
+	struct UnwindContext
+	{
+	public:
+		std::uintptr_t PC = 0;
+		std::uintptr_t SP = 0;
+		std::uintptr_t FP = 0;
+	};
+
+	// Compiles the .eh_frame CFI of every loaded module into one table sorted by PC, called by Init.
+	// Unwinding reads the published table without locks or allocation, frames without CFI fall back to frame pointers.
+	void LoadUnwindTables();
+	void FreeUnwindTables();
+	// Number of rows in the published table, 0 if CFI unwinding is unavailable.
+	std::size_t UnwindTableSize();
+
+	// Caches the stack bounds of the calling thread, unwinding in a signal handler only works on prepared threads.
+	// Init and thread registration prepare their thread.
+	void PrepareThreadUnwinding();
+
+	// Async signal safe, stores up to maxFrames addresses starting with context.PC.
+	std::size_t UnwindCallstack(const UnwindContext& context, void** frames, std::size_t maxFrames);
+} // namespace Profiler
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace Profiler::Utils
+{
+	// Pool of fixed size blocks allocated in slabs, blocks are never moved or freed while the pool lives.
+	// T has to provide a `std::atomic<T*> Next` member which is reused as the free list link.
+	template <class T, std::size_t SlabSize = 64>
+	class BlockPool
+	{
+	public:
+		BlockPool() = default;
+		BlockPool(const BlockPool&) = delete;
+		BlockPool& operator=(const BlockPool&) = delete;
+
+		~BlockPool()
+		{
+			for (auto slab : m_Slabs)
+				delete[] slab;
+		}
+
+		T* acquire()
+		{
+			T* block = pop();
+			if (!block)
+				block = grow();
+			block->Next.store(nullptr, std::memory_order_relaxed);
+			return block;
+		}
+
+		void release(T* block)
+		{
+			std::uint64_t head = m_Free.load(std::memory_order_relaxed);
+			std::uint64_t newHead;
+			do
+			{
+				block->Next.store(Untag(head), std::memory_order_relaxed);
+				newHead = Tag(block, head);
+			}
+			while (!m_Free.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		std::size_t allocatedCount() const { return m_AllocatedCount.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr std::uint64_t c_PtrMask = (1ULL << 48) - 1;
+
+		// The upper 16 bits of the free list head hold a generation counter to keep pops ABA safe.
+		static T* Untag(std::uint64_t head) { return reinterpret_cast<T*>(head & c_PtrMask); }
+
+		static std::uint64_t Tag(T* block, std::uint64_t prevHead) { return (reinterpret_cast<std::uint64_t>(block) & c_PtrMask) | ((prevHead & ~c_PtrMask) + (1ULL << 48)); }
+
+		T* pop()
+		{
+			std::uint64_t head = m_Free.load(std::memory_order_acquire);
+			while (Untag(head))
+			{
+				T*            block   = Untag(head);
+				std::uint64_t newHead = Tag(block->Next.load(std::memory_order_relaxed), head);
+				if (m_Free.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+					return block;
+			}
+			return nullptr;
+		}
+
+		T* grow()
+		{
+			T* slab = new T[SlabSize];
+			{
+				std::lock_guard lock(m_SlabMutex);
+				m_Slabs.emplace_back(slab);
+			}
+			m_AllocatedCount.fetch_add(SlabSize, std::memory_order_relaxed);
+			for (std::size_t i = 1; i < SlabSize; ++i)
+				release(&slab[i]);
+			return &slab[0];
+		}
+
+	private:
+		std::atomic_uint64_t m_Free           = 0;
+		std::atomic_size_t   m_AllocatedCount = 0;
+
+		std::mutex      m_SlabMutex;
+		std::vector<T*> m_Slabs;
+	};
+} // namespace Profiler::Utils
@@ -44,6 +44,12 @@
 	#define BUILD_NEVER_INLINE
 #endif
 
+#if BUILD_IS_TOOLSET_CLANG || BUILD_IS_TOOLSET_GCC
+	#define BUILD_NO_INSTRUMENT __attribute__((no_instrument_function))
+#else
+	#define BUILD_NO_INSTRUMENT
+#endif
+
 namespace Profiler::Core
 {
 	using EBuildConfig   = Utils::Flags<std::uint16_t>;
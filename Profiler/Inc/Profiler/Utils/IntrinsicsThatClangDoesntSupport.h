@@ -27,7 +27,7 @@ namespace Profiler::Utils
 		return __rdtsc();
 #elif BUILD_IS_TOOLSET_GCC || BUILD_IS_TOOLSET_CLANG
 		std::uint64_t result {};
-		asm("rdtsc\n"
+		asm volatile("rdtsc\n"
 			"shlq $32, %%rdx\n"
 			"orq %%rax, %%rdx\n"
 			"movq %%rdx, %0\n"
@@ -35,6 +35,45 @@ namespace Profiler::Utils
 			:
 			: "rax", "rdx");
 		return result;
+#endif
+	}
+
+	// Waits for all previous instructions to finish before reading the TSC.
+	inline std::uint64_t rdtscp()
+	{
+#if BUILD_IS_TOOLSET_MSVC
+		unsigned int aux;
+		return __rdtscp(&aux);
+#elif BUILD_IS_TOOLSET_GCC || BUILD_IS_TOOLSET_CLANG
+		std::uint64_t result {};
+		asm volatile("rdtscp\n"
+			"shlq $32, %%rdx\n"
+			"orq %%rax, %%rdx\n"
+			"movq %%rdx, %0\n"
+			: "=r"(result)
+			:
+			: "rax", "rcx", "rdx");
+		return result;
+#endif
+	}
+
+	// Same ordering as rdtscp, for CPUs without it.
+	inline std::uint64_t lfenceRdtsc()
+	{
+#if BUILD_IS_TOOLSET_MSVC
+		_mm_lfence();
+		return __rdtsc();
+#elif BUILD_IS_TOOLSET_GCC || BUILD_IS_TOOLSET_CLANG
+		std::uint64_t result {};
+		asm volatile("lfence\n"
+			"rdtsc\n"
+			"shlq $32, %%rdx\n"
+			"orq %%rax, %%rdx\n"
+			"movq %%rdx, %0\n"
+			: "=r"(result)
+			:
+			: "rax", "rdx", "memory");
+		return result;
 #endif
 	}
 } // namespace Profiler::Utils
\ No newline at end of file
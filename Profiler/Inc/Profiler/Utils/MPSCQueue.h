@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+
+namespace Profiler::Utils
+{
+	// Intrusive multi producer single consumer queue, T has to provide a `std::atomic<T*> Next` member.
+	// Pushing is a single exchange and a store, popping is only allowed from one consumer at a time.
+	template <class T>
+	class MPSCQueue
+	{
+	public:
+		MPSCQueue()
+			: m_Head(&m_Stub),
+			  m_Tail(&m_Stub)
+		{
+			m_Stub.Next.store(nullptr, std::memory_order_relaxed);
+		}
+
+		MPSCQueue(const MPSCQueue&) = delete;
+		MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+		void push(T* node)
+		{
+			node->Next.store(nullptr, std::memory_order_relaxed);
+			T* prev = m_Head.exchange(node, std::memory_order_acq_rel);
+			prev->Next.store(node, std::memory_order_release);
+		}
+
+		T* pop()
+		{
+			T* tail = m_Tail;
+			T* next = tail->Next.load(std::memory_order_acquire);
+			if (tail == &m_Stub)
+			{
+				if (!next)
+					return nullptr;
+				m_Tail = next;
+				tail   = next;
+				next   = next->Next.load(std::memory_order_acquire);
+			}
+			if (next)
+			{
+				m_Tail = next;
+				return tail;
+			}
+			// A producer is between its exchange and store, the node will show up on a later pop.
+			if (tail != m_Head.load(std::memory_order_acquire))
+				return nullptr;
+			push(&m_Stub);
+			next = tail->Next.load(std::memory_order_acquire);
+			if (next)
+			{
+				m_Tail = next;
+				return tail;
+			}
+			return nullptr;
+		}
+
+	private:
+		std::atomic<T*> m_Head;
+		T*              m_Tail;
+		T               m_Stub;
+	};
+} // namespace Profiler::Utils
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Profiler::Utils
+{
+	static constexpr std::size_t c_MaxVarintSize = 10;
+
+	inline std::uint64_t ZigZagEncode(std::int64_t value)
+	{
+		return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+	}
+
+	inline std::int64_t ZigZagDecode(std::uint64_t value)
+	{
+		return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+	}
+
+	inline void WriteVarint(std::uint8_t*& out, std::uint64_t value)
+	{
+		while (value >= 0x80)
+		{
+			*out++  = static_cast<std::uint8_t>(value | 0x80);
+			value >>= 7;
+		}
+		*out++ = static_cast<std::uint8_t>(value);
+	}
+
+	inline bool ReadVarint(const std::uint8_t*& in, const std::uint8_t* end, std::uint64_t& value)
+	{
+		value = 0;
+		for (std::uint32_t shift = 0; shift < 64 && in != end; shift += 7)
+		{
+			std::uint8_t byte  = *in++;
+			value             |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+} // namespace Profiler::Utils
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Profiler::Utils
+{
+	// Every worker owns a task deque, it pops its own work from the back and steals from the front of the others.
+	// Threads calling wait() help out with pending tasks instead of sleeping.
+	class WorkStealingPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+	public:
+		explicit WorkStealingPool(std::size_t threadCount = 0)
+		{
+			if (!threadCount)
+				threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+			m_Queues.reserve(threadCount);
+			for (std::size_t i = 0; i < threadCount; ++i)
+				m_Queues.emplace_back(std::make_unique<Queue>());
+			m_Workers.reserve(threadCount);
+			for (std::size_t i = 0; i < threadCount; ++i)
+				m_Workers.emplace_back(&WorkStealingPool::workerFunc, this, i);
+		}
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+		~WorkStealingPool()
+		{
+			{
+				std::lock_guard lock(m_SleepMutex);
+				m_Running = false;
+			}
+			m_SleepCondition.notify_all();
+			for (auto& worker : m_Workers)
+				worker.join();
+		}
+
+		std::size_t threadCount() const { return m_Workers.size(); }
+
+		void submit(Task task)
+		{
+			m_Pending.fetch_add(1, std::memory_order_acq_rel);
+			Queue& queue = *m_Queues[m_NextQueue.fetch_add(1, std::memory_order_relaxed) % m_Queues.size()];
+			{
+				std::lock_guard lock(queue.Mutex);
+				queue.Tasks.emplace_back(std::move(task));
+			}
+			{
+				std::lock_guard lock(m_SleepMutex);
+			}
+			m_SleepCondition.notify_one();
+		}
+
+		void wait()
+		{
+			while (m_Pending.load(std::memory_order_acquire))
+			{
+				Task task;
+				if (steal(0, task))
+					run(task);
+				else
+					std::this_thread::yield();
+			}
+		}
+
+		// Runs func(i) for every i in [0, count) split into roughly even batches, and waits for all of them.
+		template <class F>
+		void parallelFor(std::size_t count, F&& func)
+		{
+			std::size_t batches   = std::min<std::size_t>(count, threadCount() * 4);
+			std::size_t batchSize = batches ? (count + batches - 1) / batches : 0;
+			for (std::size_t start = 0; start < count; start += batchSize)
+			{
+				std::size_t end = std::min(start + batchSize, count);
+				submit([&func, start, end]() {
+					for (std::size_t i = start; i < end; ++i)
+						func(i);
+				});
+			}
+			wait();
+		}
+
+	private:
+		struct Queue
+		{
+			std::mutex       Mutex;
+			std::deque<Task> Tasks;
+		};
+
+	private:
+		bool popOwn(std::size_t index, Task& task)
+		{
+			Queue&          queue = *m_Queues[index];
+			std::lock_guard lock(queue.Mutex);
+			if (queue.Tasks.empty())
+				return false;
+			task = std::move(queue.Tasks.back());
+			queue.Tasks.pop_back();
+			return true;
+		}
+
+		bool steal(std::size_t first, Task& task)
+		{
+			for (std::size_t i = 0; i < m_Queues.size(); ++i)
+			{
+				Queue&          queue = *m_Queues[(first + i) % m_Queues.size()];
+				std::lock_guard lock(queue.Mutex);
+				if (queue.Tasks.empty())
+					continue;
+				task = std::move(queue.Tasks.front());
+				queue.Tasks.pop_front();
+				return true;
+			}
+			return false;
+		}
+
+		void run(Task& task)
+		{
+			task();
+			task = nullptr;
+			m_Pending.fetch_sub(1, std::memory_order_acq_rel);
+		}
+
+		void workerFunc(std::size_t index)
+		{
+			while (true)
+			{
+				Task task;
+				if (popOwn(index, task) || steal(index + 1, task))
+				{
+					run(task);
+					continue;
+				}
+
+				std::unique_lock lock(m_SleepMutex);
+				if (!m_Running)
+					return;
+				m_SleepCondition.wait_for(lock, std::chrono::milliseconds(1));
+			}
+		}
+
+	private:
+		std::vector<std::unique_ptr<Queue>> m_Queues;
+		std::vector<std::thread>            m_Workers;
+		std::atomic_size_t                  m_NextQueue = 0;
+		std::atomic_size_t                  m_Pending   = 0;
+
+		std::mutex              m_SleepMutex;
+		std::condition_variable m_SleepCondition;
+		bool                    m_Running = true;
+	};
+} // namespace Profiler::Utils
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "Function.h"
+#include "State.h"
+#include "Timestamp.h"
+#include "Utils/Core.h"
+
+#include <cstdint>
+
+#include <source_location>
+#include <string_view>
+
+namespace Profiler
+{
+	// Describes one instrumented call site, descriptors are static so zones do no string work at runtime.
+	struct ZoneDescriptor
+	{
+	public:
+		constexpr ZoneDescriptor(std::source_location location, const char* name = nullptr, std::uint32_t color = 0, const char* category = nullptr)
+			: Name(name ? name : location.function_name()),
+			  Function(location.function_name()),
+			  File(location.file_name()),
+			  Category(category ? category : ""),
+			  Line(location.line()),
+			  Color(color) {}
+
+	public:
+		const char*   Name;
+		const char*   Function;
+		const char*   File;
+		const char*   Category;
+		std::uint32_t Line;
+		std::uint32_t Color;
+	};
+
+	// Returns the ID events refer to the descriptor by, IDs start at 1 and stay valid for the life of the process.
+	std::uint32_t RegisterZone(const ZoneDescriptor* descriptor);
+
+	void SetZoneEnabled(std::uint32_t descriptorID, bool enabled);
+	// Matches zones by name or category, including zones that register later.
+	void SetZonesEnabled(std::string_view nameOrCategory, bool enabled);
+	// Counts zone calls for the next `frames` captured frames and silences zones averaging more than `maxCallsPerFrame`.
+	void AutoDisableHotZones(std::uint64_t frames, std::uint64_t maxCallsPerFrame);
+
+	inline bool IsZoneActive(std::uint32_t descriptorID)
+	{
+		if (descriptorID >= c_MaxFilteredZones)
+			return true;
+		return !((g_State.DisabledZones[descriptorID >> 6].load(std::memory_order_relaxed) >> (descriptorID & 63)) & 1);
+	}
+
+	namespace Detail
+	{
+		BUILD_NEVER_INLINE void ZoneBegin(ThreadState* state, std::uint32_t descriptorID);
+		BUILD_NEVER_INLINE void HRZoneBegin(ThreadState* state, std::uint32_t descriptorID);
+
+		// Reads PROFILER_DISABLED_ZONES, PROFILER_ZONE_FILTER and PROFILER_AUTO_DISABLE_ZONES, called by Init.
+		void LoadZoneFilters();
+		// Silences hot zones while AutoDisableFrames is set, called once per captured frame.
+		void UpdateHotZones();
+	} // namespace Detail
+
+	// Returns whether the zone began, the matching end must only be sent if it did.
+	inline bool ZoneBegin(std::uint32_t descriptorID)
+	{
+		if constexpr (!c_ProfilerEnabled)
+			return false;
+
+		ThreadState* state = GetThreadState();
+		if (!(state->Capture || state->Aggregate) || !IsZoneActive(descriptorID))
+			return false;
+		switch (BeginScope(state))
+		{
+		case EScopePath::Capture: Detail::ZoneBegin(state, descriptorID); break;
+		case EScopePath::Aggregate: Detail::AggregateBegin(state, c_AggregateZoneKey | descriptorID); break;
+		case EScopePath::None: break;
+		}
+		return true;
+	}
+
+	inline bool HRZoneBegin(std::uint32_t descriptorID)
+	{
+		if constexpr (!c_ProfilerEnabled)
+			return false;
+
+		ThreadState* state = GetThreadState();
+		if (!(state->Capture || state->Aggregate) || !IsZoneActive(descriptorID))
+			return false;
+		switch (BeginScope(state))
+		{
+		case EScopePath::Capture: Detail::HRZoneBegin(state, descriptorID); break;
+		case EScopePath::Aggregate: Detail::AggregateBegin(state, c_AggregateZoneKey | descriptorID); break;
+		case EScopePath::None: break;
+		}
+		return true;
+	}
+
+	struct RAIIZone
+	{
+	public:
+		RAIIZone(std::uint32_t descriptorID)
+			: m_Began(ZoneBegin(descriptorID)) {}
+
+		~RAIIZone()
+		{
+			if (m_Began)
+				FunctionEnd();
+		}
+
+	private:
+		bool m_Began;
+	};
+
+	struct RAIIHRZone
+	{
+	public:
+		RAIIHRZone(std::uint32_t descriptorID)
+			: m_Began(HRZoneBegin(descriptorID)) {}
+
+		~RAIIHRZone()
+		{
+			if (m_Began)
+				HRFunctionEnd();
+		}
+
+	private:
+		bool m_Began;
+	};
+
+	// Holds the zone when it passes the level gate, otherwise it is empty and the descriptor is never registered.
+	template <class T, bool Enabled>
+	struct ScopedZone
+	{
+	public:
+		template <class F>
+		ScopedZone(F&& getDescriptorID)
+			: m_Zone(getDescriptorID()) {}
+
+	private:
+		T m_Zone;
+	};
+
+	template <class T>
+	struct ScopedZone<T, false>
+	{
+	public:
+		template <class F>
+		ScopedZone(F&&)
+		{
+		}
+	};
+} // namespace Profiler
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b)      PROFILER_CONCAT_IMPL(a, b)
+
+#if PROFILER_ENABLED
+	#define PROFILER_ZONE_IMPL(type, level, ...) PROFILER_ZONE_NAMED(PROFILER_CONCAT(_profilerZone, __COUNTER__), type, level __VA_OPT__(, ) __VA_ARGS__)
+	#define PROFILER_ZONE_NAMED(name, type, level, ...) \
+		static constexpr ::Profiler::ZoneDescriptor PROFILER_CONCAT(name, Descriptor) { std::source_location::current() __VA_OPT__(, ) __VA_ARGS__ }; \
+		::Profiler::ScopedZone<::Profiler::type, ::Profiler::IsZoneEnabled(::Profiler::ELevel::level, PROFILER_CONCAT(name, Descriptor).Category)> name { [] { \
+			static const std::uint32_t id = ::Profiler::RegisterZone(&PROFILER_CONCAT(name, Descriptor)); \
+			return id; \
+		} }
+#else
+	#define PROFILER_ZONE_IMPL(type, level, ...) static_cast<void>(0)
+#endif
+
+// Profiles the rest of the enclosing scope, works in lambdas and member functions.
+// Takes an optional name, color and category, e.g. PROFILER_ZONE("Upload", 0xFF8000, "Render"), the name defaults to the enclosing function.
+// The _LEVEL variants take an ELevel first, e.g. PROFILER_ZONE_LEVEL(Verbose, "Inner"), zones without one are Normal.
+#define PROFILER_ZONE(...)                 PROFILER_ZONE_IMPL(RAIIZone, Normal, __VA_ARGS__)
+#define PROFILER_HR_ZONE(...)              PROFILER_ZONE_IMPL(RAIIHRZone, Normal, __VA_ARGS__)
+#define PROFILER_ZONE_LEVEL(level, ...)    PROFILER_ZONE_IMPL(RAIIZone, level, __VA_ARGS__)
+#define PROFILER_HR_ZONE_LEVEL(level, ...) PROFILER_ZONE_IMPL(RAIIHRZone, level, __VA_ARGS__)
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Utils/Core.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+
+namespace Profiler
+{
+	class ThreadState;
+
+	// Open zones a shadow stack stores, zones nested deeper are counted but not stored.
+	static constexpr std::size_t c_ZoneStackDepth = 64;
+
+	// Keys of the zones a thread has open, outermost first. Keys are function pointers, or c_AggregateZoneKey | descriptor ID
+	// for zones. Only the owning thread writes, other threads read through the seqlock in Sequence, which is odd mid write.
+	struct ZoneStack
+	{
+	public:
+		void push(std::uint64_t key)
+		{
+			std::uint32_t sequence = Sequence.load(std::memory_order_relaxed);
+			Sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			std::uint32_t depth = Depth.load(std::memory_order_relaxed);
+			if (depth < c_ZoneStackDepth)
+				Keys[depth].store(key, std::memory_order_relaxed);
+			Depth.store(depth + 1, std::memory_order_relaxed);
+			Sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		void pop()
+		{
+			std::uint32_t depth = Depth.load(std::memory_order_relaxed);
+			if (!depth)
+				return;
+			std::uint32_t sequence = Sequence.load(std::memory_order_relaxed);
+			Sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			Depth.store(depth - 1, std::memory_order_relaxed);
+			Sequence.store(sequence + 2, std::memory_order_release);
+		}
+
+		// Copies up to maxKeys keys and returns how many, 0 if the stack is empty or kept changing while being read.
+		std::size_t read(std::uint64_t* keys, std::size_t maxKeys) const
+		{
+			for (std::size_t attempt = 0; attempt < 16; ++attempt)
+			{
+				std::uint32_t sequence = Sequence.load(std::memory_order_acquire);
+				if (sequence & 1)
+					continue;
+
+				std::size_t count = Depth.load(std::memory_order_relaxed);
+				count             = count < c_ZoneStackDepth ? count : c_ZoneStackDepth;
+				count             = count < maxKeys ? count : maxKeys;
+				for (std::size_t i = 0; i < count; ++i)
+					keys[i] = Keys[i].load(std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (Sequence.load(std::memory_order_relaxed) == sequence)
+					return count;
+			}
+			return 0;
+		}
+
+	public:
+		std::atomic_uint32_t Sequence = 0;
+		std::atomic_uint32_t Depth    = 0;
+		std::atomic_uint64_t Keys[c_ZoneStackDepth] {};
+	};
+
+	// While running, capturing threads push and pop their functions and zones on their shadow stacks instead of storing
+	// events, arguments are dropped. A sampler thread reads every registered thread's stack `frequency` times per second
+	// and stores each non-empty one as a ZoneSample event. Start and stop it while not capturing.
+	bool StartZoneSampler(std::uint32_t frequency);
+	void StopZoneSampler();
+	bool IsZoneSamplerRunning();
+
+	namespace Detail
+	{
+		BUILD_NEVER_INLINE void ZoneStackBegin(ThreadState* state, std::uint64_t key);
+		BUILD_NEVER_INLINE void ZoneStackEnd(ThreadState* state);
+	} // namespace Detail
+} // namespace Profiler
@@ -0,0 +1,319 @@
+#include "Profiler/Aggregate.h"
+#include "Profiler/Timestamp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <unordered_map>
+
+namespace Profiler
+{
+	static constexpr EClockSource c_AggregateClock = ClockPolicy<EZoneType::Function>::HighRes;
+	static constexpr std::size_t  c_OverflowSlot   = c_AggregateTableSize;
+
+	// Only the owning thread writes an entry, relaxed atomics let snapshots read it without tearing single counters.
+	struct AggregateEntry
+	{
+	public:
+		std::atomic_uint64_t Key;
+		std::atomic_uint64_t Count;
+		std::atomic_uint64_t TotalTime;
+		std::atomic_uint64_t SelfTime;
+		std::atomic_uint64_t MinTime;
+		std::atomic_uint64_t MaxTime;
+		std::atomic_uint32_t Histogram[c_AggregateBuckets];
+	};
+
+	struct AggregateFrame
+	{
+	public:
+		std::uint32_t Slot;
+		std::uint64_t Begin;
+		std::uint64_t Children;
+	};
+
+	struct AggregateTable
+	{
+	public:
+		std::uint64_t        ThreadID = 0;
+		std::atomic_uint32_t Generation;
+		std::uint32_t        Epoch = 0;
+		std::size_t          Used  = 0;
+		std::size_t          Depth = 0;
+		AggregateEntry       Entries[c_AggregateTableSize + 1];
+		AggregateFrame       Stack[c_AggregateMaxDepth];
+	};
+
+	// Statistics of ended threads in HR ticks, guarded by ThreadsMutex. Stale once Generation is behind the global one.
+	static struct RetiredAggregates
+	{
+		std::unordered_map<std::uint64_t, AggregateStats> Stats;
+		std::uint32_t                                     Generation = 0;
+	} s_Retired;
+
+	template <class T, class U>
+	static void OwnerAdd(std::atomic<T>& value, U amount)
+	{
+		value.store(value.load(std::memory_order_relaxed) + static_cast<T>(amount), std::memory_order_relaxed);
+	}
+
+	static void ClearTable(AggregateTable* table)
+	{
+		for (auto& entry : table->Entries)
+		{
+			entry.Key.store(0, std::memory_order_relaxed);
+			entry.Count.store(0, std::memory_order_relaxed);
+			entry.TotalTime.store(0, std::memory_order_relaxed);
+			entry.SelfTime.store(0, std::memory_order_relaxed);
+			entry.MinTime.store(~0ULL, std::memory_order_relaxed);
+			entry.MaxTime.store(0, std::memory_order_relaxed);
+			for (auto& bucket : entry.Histogram)
+				bucket.store(0, std::memory_order_relaxed);
+		}
+		table->Used  = 0;
+		table->Depth = 0;
+		table->Generation.store(g_State.AggregateGeneration.load(std::memory_order_relaxed), std::memory_order_release);
+	}
+
+	static AggregateTable* GetTable(ThreadState* state)
+	{
+		AggregateTable* table = state->Aggregates;
+		if (!table)
+		{
+			std::lock_guard lock(g_State.ThreadsMutex);
+			if (g_State.FreeAggregateTables.empty())
+			{
+				table = new AggregateTable();
+			}
+			else
+			{
+				table = g_State.FreeAggregateTables.back();
+				g_State.FreeAggregateTables.pop_back();
+			}
+			table->ThreadID = state->ThreadID;
+			table->Epoch    = g_State.AggregateEpoch.load(std::memory_order_relaxed);
+			ClearTable(table);
+			g_State.AggregateTables.emplace_back(table);
+			state->Aggregates = table;
+		}
+		else if (table->Generation.load(std::memory_order_relaxed) != g_State.AggregateGeneration.load(std::memory_order_relaxed))
+		{
+			ClearTable(table);
+		}
+
+		std::uint32_t epoch = g_State.AggregateEpoch.load(std::memory_order_relaxed);
+		if (table->Epoch != epoch)
+		{
+			table->Epoch = epoch;
+			table->Depth = 0;
+		}
+		return table;
+	}
+
+	// Open addressing with linear probing, new keys go to the overflow entry once the table is three quarters full.
+	static std::uint32_t FindSlot(AggregateTable* table, std::uint64_t key)
+	{
+		if (!key)
+			return c_OverflowSlot;
+
+		std::size_t slot = static_cast<std::size_t>((key * 0x9E37'79B9'7F4A'7C15ULL) >> 54) & (c_AggregateTableSize - 1);
+		while (true)
+		{
+			std::uint64_t slotKey = table->Entries[slot].Key.load(std::memory_order_relaxed);
+			if (slotKey == key)
+				return static_cast<std::uint32_t>(slot);
+			if (!slotKey)
+				break;
+			slot = (slot + 1) & (c_AggregateTableSize - 1);
+		}
+
+		if (table->Used >= c_AggregateTableSize * 3 / 4)
+			return c_OverflowSlot;
+		++table->Used;
+		table->Entries[slot].Key.store(key, std::memory_order_release);
+		return static_cast<std::uint32_t>(slot);
+	}
+
+	void SetAggregating(bool aggregate)
+	{
+		std::lock_guard lock(g_State.ThreadsMutex);
+		if (aggregate && !g_State.Aggregating)
+			++g_State.AggregateEpoch;
+		g_State.Aggregating = aggregate;
+		for (auto tstate : g_State.Threads)
+			tstate->Aggregate = g_State.Initialized && aggregate;
+	}
+
+	bool IsAggregating()
+	{
+		return g_State.Aggregating;
+	}
+
+	void ResetAggregates()
+	{
+		++g_State.AggregateGeneration;
+	}
+
+	AggregateSnapshot SnapshotAggregates(bool perThread)
+	{
+		AggregateSnapshot snapshot;
+		for (std::size_t i = 0; i < c_AggregateBuckets; ++i)
+			snapshot.BucketLimits[i] = DurationToNanoseconds<c_AggregateClock>(1ULL << i);
+
+		std::unordered_map<std::uint64_t, std::size_t> merged;
+
+		auto statsFor = [&](std::uint64_t threadID, std::uint64_t key) -> AggregateStats& {
+			auto [itr, inserted] = merged.try_emplace(key, snapshot.Stats.size());
+			if (inserted)
+			{
+				auto& stats    = snapshot.Stats.emplace_back();
+				stats.ThreadID = perThread ? threadID : 0;
+				stats.MinTime  = ~0ULL;
+				if (key & c_AggregateZoneKey)
+					stats.DescriptorID = static_cast<std::uint32_t>(key & ~c_AggregateZoneKey);
+				else
+					stats.FunctionPtr = reinterpret_cast<void*>(key);
+			}
+			return snapshot.Stats[itr->second];
+		};
+
+		std::uint32_t   generation = g_State.AggregateGeneration.load(std::memory_order_relaxed);
+		std::lock_guard lock(g_State.ThreadsMutex);
+		for (auto table : g_State.AggregateTables)
+		{
+			if (table->Generation.load(std::memory_order_acquire) != generation)
+				continue;
+
+			if (perThread)
+				merged.clear();
+			for (std::size_t slot = 0; slot <= c_AggregateTableSize; ++slot)
+			{
+				auto&         entry = table->Entries[slot];
+				std::uint64_t key   = entry.Key.load(std::memory_order_acquire);
+				std::uint64_t count = entry.Count.load(std::memory_order_relaxed);
+				if ((!key && slot != c_OverflowSlot) || !count)
+					continue;
+
+				auto& stats      = statsFor(table->ThreadID, key);
+				stats.Count     += count;
+				stats.TotalTime += entry.TotalTime.load(std::memory_order_relaxed);
+				stats.SelfTime  += entry.SelfTime.load(std::memory_order_relaxed);
+				stats.MinTime    = std::min(stats.MinTime, entry.MinTime.load(std::memory_order_relaxed));
+				stats.MaxTime    = std::max(stats.MaxTime, entry.MaxTime.load(std::memory_order_relaxed));
+				for (std::size_t i = 0; i < c_AggregateBuckets; ++i)
+					stats.Histogram[i] += entry.Histogram[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		// Ended threads are reported together under thread ID 0.
+		if (s_Retired.Generation == generation)
+		{
+			if (perThread)
+				merged.clear();
+			for (auto& [key, retired] : s_Retired.Stats)
+			{
+				auto& stats      = statsFor(0, key);
+				stats.Count     += retired.Count;
+				stats.TotalTime += retired.TotalTime;
+				stats.SelfTime  += retired.SelfTime;
+				stats.MinTime    = std::min(stats.MinTime, retired.MinTime);
+				stats.MaxTime    = std::max(stats.MaxTime, retired.MaxTime);
+				for (std::size_t i = 0; i < c_AggregateBuckets; ++i)
+					stats.Histogram[i] += retired.Histogram[i];
+			}
+		}
+
+		for (auto& stats : snapshot.Stats)
+		{
+			stats.TotalTime = DurationToNanoseconds<c_AggregateClock>(stats.TotalTime);
+			stats.SelfTime  = DurationToNanoseconds<c_AggregateClock>(stats.SelfTime);
+			stats.MinTime   = DurationToNanoseconds<c_AggregateClock>(stats.MinTime);
+			stats.MaxTime   = DurationToNanoseconds<c_AggregateClock>(stats.MaxTime);
+		}
+		std::sort(snapshot.Stats.begin(), snapshot.Stats.end(),
+				  [](const AggregateStats& lhs, const AggregateStats& rhs) {
+					  return lhs.ThreadID != rhs.ThreadID ? lhs.ThreadID < rhs.ThreadID : lhs.TotalTime > rhs.TotalTime;
+				  });
+		return snapshot;
+	}
+
+	namespace Detail
+	{
+		void RetireAggregates(ThreadState* state)
+		{
+			AggregateTable* table = state->Aggregates;
+			if (!table)
+				return;
+
+			std::uint32_t generation = g_State.AggregateGeneration.load(std::memory_order_relaxed);
+			if (s_Retired.Generation != generation)
+			{
+				s_Retired.Stats.clear();
+				s_Retired.Generation = generation;
+			}
+			if (table->Generation.load(std::memory_order_relaxed) == generation)
+			{
+				for (std::size_t slot = 0; slot <= c_AggregateTableSize; ++slot)
+				{
+					auto&         entry = table->Entries[slot];
+					std::uint64_t key   = entry.Key.load(std::memory_order_relaxed);
+					std::uint64_t count = entry.Count.load(std::memory_order_relaxed);
+					if ((!key && slot != c_OverflowSlot) || !count)
+						continue;
+
+					auto [itr, inserted] = s_Retired.Stats.try_emplace(key);
+					auto& stats          = itr->second;
+					if (inserted)
+						stats.MinTime = ~0ULL;
+					stats.Count     += count;
+					stats.TotalTime += entry.TotalTime.load(std::memory_order_relaxed);
+					stats.SelfTime  += entry.SelfTime.load(std::memory_order_relaxed);
+					stats.MinTime    = std::min(stats.MinTime, entry.MinTime.load(std::memory_order_relaxed));
+					stats.MaxTime    = std::max(stats.MaxTime, entry.MaxTime.load(std::memory_order_relaxed));
+					for (std::size_t i = 0; i < c_AggregateBuckets; ++i)
+						stats.Histogram[i] += entry.Histogram[i].load(std::memory_order_relaxed);
+				}
+			}
+
+			std::erase(g_State.AggregateTables, table);
+			g_State.FreeAggregateTables.emplace_back(table);
+			state->Aggregates = nullptr;
+		}
+
+		void AggregateBegin(ThreadState* state, std::uint64_t key)
+		{
+			AggregateTable* table = GetTable(state);
+			if (table->Depth < c_AggregateMaxDepth)
+				table->Stack[table->Depth] = { FindSlot(table, key), 0, 0 };
+			++table->Depth;
+			if (table->Depth <= c_AggregateMaxDepth)
+				table->Stack[table->Depth - 1].Begin = ReadClock<c_AggregateClock>();
+		}
+
+		void AggregateEnd(ThreadState* state)
+		{
+			std::uint64_t   now   = ReadClock<c_AggregateClock>();
+			AggregateTable* table = GetTable(state);
+			if (!table->Depth)
+				return;
+			if (--table->Depth >= c_AggregateMaxDepth)
+				return;
+
+			AggregateFrame& frame    = table->Stack[table->Depth];
+			std::uint64_t   duration = now - frame.Begin;
+			std::uint64_t   self     = duration > frame.Children ? duration - frame.Children : 0;
+			if (table->Depth)
+				table->Stack[table->Depth - 1].Children += duration;
+
+			auto& entry = table->Entries[frame.Slot];
+			OwnerAdd(entry.Count, 1);
+			OwnerAdd(entry.TotalTime, duration);
+			OwnerAdd(entry.SelfTime, self);
+			if (duration < entry.MinTime.load(std::memory_order_relaxed))
+				entry.MinTime.store(duration, std::memory_order_relaxed);
+			if (duration > entry.MaxTime.load(std::memory_order_relaxed))
+				entry.MaxTime.store(duration, std::memory_order_relaxed);
+			OwnerAdd(entry.Histogram[std::min<std::size_t>(std::bit_width(duration), c_AggregateBuckets - 1)], 1);
+		}
+	} // namespace Detail
+} // namespace Profiler
@@ -0,0 +1,316 @@
+#include "Profiler/CallTree.h"
+#include "Profiler/Timestamp.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <unordered_map>
+
+namespace Profiler
+{
+	static constexpr EClockSource c_CallTreeClock = ClockPolicy<EZoneType::Function>::HighRes;
+
+	// Nodes of a thread's tree live in chunks that never move, chunk n holds c_CallTreeChunkSize << n nodes.
+	static constexpr std::size_t c_CallTreeChunkSize = 1024;
+	static constexpr std::size_t c_CallTreeChunks    = 22;
+
+	// Only the owning thread writes a node, relaxed atomics let merges read it without tearing single counters.
+	struct ThreadCallTreeNode
+	{
+	public:
+		std::atomic_uint64_t Key;
+		std::atomic_uint32_t Parent;
+		std::uint32_t        Padding;
+		std::atomic_uint64_t Count;
+		std::atomic_uint64_t InclusiveTime;
+	};
+
+	struct OpenCall
+	{
+	public:
+		std::uint32_t Node;
+		std::uint64_t Begin;
+	};
+
+	template <class T, class U>
+	static void OwnerAdd(std::atomic<T>& value, U amount)
+	{
+		value.store(value.load(std::memory_order_relaxed) + static_cast<T>(amount), std::memory_order_relaxed);
+	}
+
+	// Nodes are stored in creation order, children are found through an open addressed table keyed by (parent, key)
+	// holding node indices + 1. Only the owning thread adds nodes, NodeCount is raised with a release store once a node
+	// is written so merges can read the nodes below it while the owner keeps building. The owner clears its tree on its
+	// next call once Generation is behind the global one.
+	struct ThreadCallTree
+	{
+	public:
+		ThreadCallTree() { clear(); }
+
+		~ThreadCallTree()
+		{
+			for (auto& chunk : Chunks)
+				delete[] chunk.load(std::memory_order_relaxed);
+		}
+
+		void clear()
+		{
+			NodeCount.store(0, std::memory_order_relaxed);
+			addNode(0, 0);
+			Children.assign(1024, 0);
+			Stack.clear();
+			Current = 0;
+			Generation.store(g_State.CallTreeGeneration.load(std::memory_order_relaxed), std::memory_order_release);
+		}
+
+		static std::size_t hash(std::uint32_t parent, std::uint64_t key)
+		{
+			return static_cast<std::size_t>(((key ^ (static_cast<std::uint64_t>(parent) << 40)) * 0x9E37'79B9'7F4A'7C15ULL) >> 32);
+		}
+
+		ThreadCallTreeNode& node(std::uint32_t index) const
+		{
+			std::size_t chunk = std::bit_width(index / c_CallTreeChunkSize + 1) - 1;
+			std::size_t first = c_CallTreeChunkSize * ((std::size_t { 1 } << chunk) - 1);
+			return Chunks[chunk].load(std::memory_order_relaxed)[index - first];
+		}
+
+		std::uint32_t addNode(std::uint64_t key, std::uint32_t parent)
+		{
+			std::uint32_t index = NodeCount.load(std::memory_order_relaxed);
+			std::size_t   chunk = std::bit_width(index / c_CallTreeChunkSize + 1) - 1;
+			if (!Chunks[chunk].load(std::memory_order_relaxed))
+				Chunks[chunk].store(new ThreadCallTreeNode[c_CallTreeChunkSize << chunk], std::memory_order_relaxed);
+
+			auto& newNode  = node(index);
+			newNode.Key.store(key, std::memory_order_relaxed);
+			newNode.Parent.store(parent, std::memory_order_relaxed);
+			newNode.Count.store(0, std::memory_order_relaxed);
+			newNode.InclusiveTime.store(0, std::memory_order_relaxed);
+			NodeCount.store(index + 1, std::memory_order_release);
+			return index;
+		}
+
+		std::uint32_t child(std::uint32_t parent, std::uint64_t key)
+		{
+			std::size_t mask = Children.size() - 1;
+			std::size_t slot = hash(parent, key) & mask;
+			while (std::uint32_t index = Children[slot])
+			{
+				auto& childNode = node(index - 1);
+				if (childNode.Key.load(std::memory_order_relaxed) == key && childNode.Parent.load(std::memory_order_relaxed) == parent)
+					return index - 1;
+				slot = (slot + 1) & mask;
+			}
+
+			// Contexts past the last chunk are counted toward their caller.
+			if (NodeCount.load(std::memory_order_relaxed) >= c_CallTreeChunkSize * ((std::size_t { 1 } << c_CallTreeChunks) - 1))
+				return parent;
+
+			std::uint32_t index = addNode(key, parent);
+			Children[slot]      = index + 1;
+			if (static_cast<std::size_t>(index + 1) * 2 > Children.size())
+				grow();
+			return index;
+		}
+
+		void grow()
+		{
+			Children.assign(Children.size() * 2, 0);
+			std::size_t   mask  = Children.size() - 1;
+			std::uint32_t count = NodeCount.load(std::memory_order_relaxed);
+			for (std::uint32_t i = 1; i < count; ++i)
+			{
+				auto&       childNode = node(i);
+				std::size_t slot      = hash(childNode.Parent.load(std::memory_order_relaxed), childNode.Key.load(std::memory_order_relaxed)) & mask;
+				while (Children[slot])
+					slot = (slot + 1) & mask;
+				Children[slot] = i + 1;
+			}
+		}
+
+	public:
+		std::atomic<ThreadCallTreeNode*> Chunks[c_CallTreeChunks] {};
+		std::atomic_uint32_t             NodeCount;
+		std::atomic_uint32_t             Generation;
+		std::vector<std::uint32_t>       Children;
+		std::vector<OpenCall>            Stack;
+		std::uint32_t                    Current = 0;
+	};
+
+	// Trees of ended threads folded together, listed in CallTrees so merges include it, guarded by ThreadsMutex.
+	static ThreadCallTree* s_RetiredTree = nullptr;
+
+	void SetCallTreeCapture(bool enabled)
+	{
+		g_State.BuildCallTrees = enabled;
+	}
+
+	bool IsCallTreeCapture()
+	{
+		return g_State.BuildCallTrees;
+	}
+
+	void ClearCallTrees()
+	{
+		++g_State.CallTreeGeneration;
+	}
+
+	std::vector<CallTreeNode> MergeCallTrees()
+	{
+		std::vector<CallTreeNode> merged;
+		merged.emplace_back(CallTreeNode { 0, 0, 0, 0, 0, 0 });
+
+		struct PairHash
+		{
+			std::size_t operator()(const std::pair<std::uint32_t, std::uint64_t>& pair) const { return ThreadCallTree::hash(pair.first, pair.second); }
+		};
+		std::unordered_map<std::pair<std::uint32_t, std::uint64_t>, std::uint32_t, PairHash> lookup;
+		std::vector<std::uint32_t>                                                           remap;
+
+		std::uint32_t   generation = g_State.CallTreeGeneration.load(std::memory_order_relaxed);
+		std::lock_guard lock(g_State.ThreadsMutex);
+		for (auto tree : g_State.CallTrees)
+		{
+			if (tree->Generation.load(std::memory_order_acquire) != generation)
+				continue;
+
+			std::uint32_t count = tree->NodeCount.load(std::memory_order_acquire);
+			remap.assign(count, 0);
+			for (std::uint32_t i = 1; i < count; ++i)
+			{
+				auto&         node   = tree->node(i);
+				std::uint64_t key    = node.Key.load(std::memory_order_relaxed);
+				std::uint32_t parent = remap[node.Parent.load(std::memory_order_relaxed)];
+				auto [itr, inserted] = lookup.try_emplace({ parent, key }, static_cast<std::uint32_t>(merged.size()));
+				if (inserted)
+					merged.emplace_back(CallTreeNode { key, parent, merged[parent].Depth + 1, 0, 0, 0 });
+				auto& mergedNode          = merged[itr->second];
+				mergedNode.Count         += node.Count.load(std::memory_order_relaxed);
+				mergedNode.InclusiveTime += node.InclusiveTime.load(std::memory_order_relaxed);
+				remap[i]                  = itr->second;
+			}
+		}
+
+		for (auto& node : merged)
+		{
+			node.InclusiveTime = DurationToNanoseconds<c_CallTreeClock>(node.InclusiveTime);
+			node.ExclusiveTime = node.InclusiveTime;
+		}
+		for (std::size_t i = merged.size(); i-- > 1;)
+		{
+			auto& parent         = merged[merged[i].Parent];
+			parent.ExclusiveTime = parent.ExclusiveTime > merged[i].InclusiveTime ? parent.ExclusiveTime - merged[i].InclusiveTime : 0;
+		}
+		merged[0].ExclusiveTime = 0;
+		return merged;
+	}
+
+	std::vector<CallGraphEdge> BuildCallGraph(const std::vector<CallTreeNode>& tree)
+	{
+		struct PairHash
+		{
+			std::size_t operator()(const std::pair<std::uint64_t, std::uint64_t>& pair) const { return static_cast<std::size_t>((pair.first * 0x9E37'79B9'7F4A'7C15ULL) ^ pair.second); }
+		};
+		std::unordered_map<std::pair<std::uint64_t, std::uint64_t>, std::size_t, PairHash> lookup;
+
+		std::vector<CallGraphEdge> edges;
+		for (std::size_t i = 1; i < tree.size(); ++i)
+		{
+			std::uint64_t caller = tree[tree[i].Parent].Key;
+			auto [itr, inserted] = lookup.try_emplace({ caller, tree[i].Key }, edges.size());
+			if (inserted)
+				edges.emplace_back(CallGraphEdge { caller, tree[i].Key, 0, 0 });
+			edges[itr->second].Count += tree[i].Count;
+			edges[itr->second].Time  += tree[i].InclusiveTime;
+		}
+		std::sort(edges.begin(), edges.end(), [](const CallGraphEdge& lhs, const CallGraphEdge& rhs) { return lhs.Time > rhs.Time; });
+		return edges;
+	}
+
+	namespace Detail
+	{
+		void RetireCallTree(ThreadState* state)
+		{
+			ThreadCallTree* tree = state->CallTree;
+			if (!tree)
+				return;
+
+			std::uint32_t generation = g_State.CallTreeGeneration.load(std::memory_order_relaxed);
+			if (tree->Generation.load(std::memory_order_relaxed) == generation)
+			{
+				if (!s_RetiredTree)
+				{
+					s_RetiredTree = new ThreadCallTree();
+					g_State.CallTrees.emplace_back(s_RetiredTree);
+				}
+				else if (s_RetiredTree->Generation.load(std::memory_order_relaxed) != generation)
+				{
+					s_RetiredTree->clear();
+				}
+
+				// Parents precede their children, so every parent is already remapped into the retired tree.
+				std::uint32_t              count = tree->NodeCount.load(std::memory_order_relaxed);
+				std::vector<std::uint32_t> remap(count, 0);
+				for (std::uint32_t i = 1; i < count; ++i)
+				{
+					auto&         node    = tree->node(i);
+					std::uint32_t index   = s_RetiredTree->child(remap[node.Parent.load(std::memory_order_relaxed)], node.Key.load(std::memory_order_relaxed));
+					auto&         retired = s_RetiredTree->node(index);
+					OwnerAdd(retired.Count, node.Count.load(std::memory_order_relaxed));
+					OwnerAdd(retired.InclusiveTime, node.InclusiveTime.load(std::memory_order_relaxed));
+					remap[i] = index;
+				}
+			}
+
+			std::erase(g_State.CallTrees, tree);
+			g_State.FreeCallTrees.emplace_back(tree);
+			state->CallTree = nullptr;
+		}
+
+		void CallTreeBegin(ThreadState* state, std::uint64_t key)
+		{
+			ThreadCallTree* tree = state->CallTree;
+			if (!tree)
+			{
+				std::lock_guard lock(g_State.ThreadsMutex);
+				if (g_State.FreeCallTrees.empty())
+				{
+					tree = new ThreadCallTree();
+				}
+				else
+				{
+					tree = g_State.FreeCallTrees.back();
+					g_State.FreeCallTrees.pop_back();
+					tree->clear();
+				}
+				g_State.CallTrees.emplace_back(tree);
+				state->CallTree = tree;
+			}
+			else if (tree->Generation.load(std::memory_order_relaxed) != g_State.CallTreeGeneration.load(std::memory_order_relaxed))
+			{
+				tree->clear();
+			}
+
+			tree->Current = tree->child(tree->Current, key);
+			tree->Stack.emplace_back(OpenCall { tree->Current, ReadClock<c_CallTreeClock>() });
+			++state->FunctionDepth;
+		}
+
+		void CallTreeEnd(ThreadState* state)
+		{
+			std::uint64_t   now  = ReadClock<c_CallTreeClock>();
+			ThreadCallTree* tree = state->CallTree;
+			--state->FunctionDepth;
+			if (!tree || tree->Stack.empty())
+				return;
+
+			OpenCall call = tree->Stack.back();
+			tree->Stack.pop_back();
+			auto& node = tree->node(call.Node);
+			OwnerAdd(node.Count, 1);
+			OwnerAdd(node.InclusiveTime, now - call.Begin);
+			tree->Current = node.Parent.load(std::memory_order_relaxed);
+		}
+	} // namespace Detail
+} // namespace Profiler
@@ -1,25 +1,161 @@
 #include "Profiler/Callstack.h"
 #include "Profiler/Data.h"
 
-namespace Profiler::Detail
+#include <cstdint>
+#include <cstring>
+
+#include <mutex>
+#include <vector>
+
+namespace Profiler
 {
-	void Callstack(ThreadState* state, void** callstack, std::size_t callstackSize)
+	struct InternedCallstack
+	{
+	public:
+		std::uint64_t Hash;
+		std::uint64_t DataID;
+		std::uint32_t Offset;
+		std::uint32_t Size; // 0 for empty slots
+	};
+
+	// Open addressed table of the stacks a thread already emitted, the frames are kept to rule out hash collisions.
+	struct CallstackTable
+	{
+	public:
+		void clear()
+		{
+			Entries.assign(1024, InternedCallstack { 0, 0, 0, 0 });
+			Frames.clear();
+			Count = 0;
+		}
+
+		InternedCallstack* find(std::uint64_t hash, void** callstack, std::size_t size)
+		{
+			std::size_t mask = Entries.size() - 1;
+			for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask)
+			{
+				auto& entry = Entries[slot];
+				if (!entry.Size)
+					return &entry;
+				if (entry.Hash == hash && entry.Size == size && std::memcmp(Frames.data() + entry.Offset, callstack, size * sizeof(void*)) == 0)
+					return &entry;
+			}
+		}
+
+		void insert(InternedCallstack* entry, std::uint64_t hash, std::uint64_t dataID, void** callstack, std::size_t size)
+		{
+			*entry = { hash, dataID, static_cast<std::uint32_t>(Frames.size()), static_cast<std::uint32_t>(size) };
+			Frames.insert(Frames.end(), callstack, callstack + size);
+			if (++Count * 2 > Entries.size())
+				grow();
+		}
+
+		void grow()
+		{
+			std::vector<InternedCallstack> entries(Entries.size() * 2, InternedCallstack { 0, 0, 0, 0 });
+			std::size_t                    mask = entries.size() - 1;
+			for (auto& entry : Entries)
+			{
+				if (!entry.Size)
+					continue;
+				std::size_t slot = entry.Hash & mask;
+				while (entries[slot].Size)
+					slot = (slot + 1) & mask;
+				entries[slot] = entry;
+			}
+			Entries = std::move(entries);
+		}
+
+	public:
+		std::uint32_t                  Generation = 0;
+		std::vector<InternedCallstack> Entries;
+		std::vector<void*>             Frames;
+		std::size_t                    Count = 0;
+	};
+
+	static std::uint64_t HashCallstack(void** callstack, std::size_t size)
 	{
-		std::uint64_t id   = Data(state, callstack, callstackSize * sizeof(void*));
-		auto&         data = NewEvent<CallstackEvent>(state);
-		data.DataID        = id;
-		data.NumEntries    = callstackSize;
+		std::uint64_t hash = 0xCBF2'9CE4'8422'2325ULL ^ size;
+		for (std::size_t i = 0; i < size; ++i)
+			hash = (hash ^ reinterpret_cast<std::uintptr_t>(callstack[i])) * 0x9E37'79B9'7F4A'7C15ULL;
+		return hash ^ (hash >> 29);
 	}
 
 	void** CollectCallstack(std::size_t& size)
 	{
-		// TODO(MarcasRealAccount): Implement Callstack Collection
-		size = 0;
-		return nullptr;
+		void** callstack = new void*[c_MaxCallstackDepth];
+		size             = UnwindCallstack(callstack, c_MaxCallstackDepth, 1);
+		return callstack;
 	}
 
-	void FreeCallstack([[maybe_unused]] void** callstack)
+	void FreeCallstack(void** callstack)
 	{
-		// TODO(MarcasRealAccount): Implement Callstack Freeing
+		delete[] callstack;
 	}
-} // namespace Profiler::Detail
\ No newline at end of file
+
+	namespace Detail
+	{
+		void RetireCallstacks(ThreadState* state)
+		{
+			if (state->Callstacks)
+				g_State.FreeCallstackTables.emplace_back(state->Callstacks);
+			state->Callstacks = nullptr;
+		}
+
+		std::uint64_t InternCallstack(ThreadState* state, void** callstack, std::size_t callstackSize)
+		{
+			CallstackTable* table = state->Callstacks;
+			if (!table)
+			{
+				{
+					std::lock_guard lock(g_State.ThreadsMutex);
+					if (g_State.FreeCallstackTables.empty())
+					{
+						table = new CallstackTable();
+					}
+					else
+					{
+						table = g_State.FreeCallstackTables.back();
+						g_State.FreeCallstackTables.pop_back();
+					}
+				}
+				state->Callstacks = table;
+				table->clear();
+			}
+			std::uint32_t generation = g_State.CallstackGeneration.load(std::memory_order_relaxed);
+			if (table->Generation != generation || table->Count >= c_MaxInternedCallstacks)
+			{
+				table->Generation = generation;
+				table->clear();
+			}
+
+			if (!callstackSize)
+				return Data(state, callstack, 0);
+
+			std::uint64_t      hash  = HashCallstack(callstack, callstackSize);
+			InternedCallstack* entry = table->find(hash, callstack, callstackSize);
+			if (entry->Size)
+				return entry->DataID;
+
+			std::uint64_t id = Data(state, callstack, callstackSize * sizeof(void*));
+			table->insert(entry, hash, id, callstack, callstackSize);
+			return id;
+		}
+
+		void Callstack(ThreadState* state, void** callstack, std::size_t callstackSize)
+		{
+			std::uint64_t id = InternCallstack(state, callstack, callstackSize);
+
+			auto& data      = NewEvent<CallstackEvent>(state);
+			data.DataID     = id;
+			data.NumEntries = callstackSize;
+		}
+
+		void CaptureCallstack(ThreadState* state)
+		{
+			void*       callstack[c_MaxCallstackDepth];
+			std::size_t size = UnwindCallstack(callstack, c_MaxCallstackDepth, 1);
+			Callstack(state, callstack, size);
+		}
+	} // namespace Detail
+} // namespace Profiler
@@ -0,0 +1,619 @@
+#include "Profiler/Capture.h"
+#include "Profiler/CaptureReader.h"
+#include "Profiler/Collector.h"
+#include "Profiler/Compression.h"
+#include "Profiler/Zone.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <string_view>
+
+#include <fmt/format.h>
+
+namespace Profiler
+{
+	bool CaptureWriter::open(const std::filesystem::path& filepath)
+	{
+		close();
+#if BUILD_IS_SYSTEM_WINDOWS
+		m_File = _wfopen(filepath.c_str(), L"wb");
+#else
+		m_File = std::fopen(filepath.c_str(), "wb");
+#endif
+		if (!m_File)
+			return false;
+		std::setvbuf(m_File, nullptr, _IONBF, 0);
+		m_Buffer     = std::make_unique<std::uint8_t[]>(c_BufferSize);
+		m_BufferSize = 0;
+		m_Offset     = 0;
+		m_Good       = true;
+		m_Index.clear();
+		return true;
+	}
+
+	bool CaptureWriter::close()
+	{
+		if (!m_File)
+			return false;
+
+		if (m_Offset)
+		{
+			std::uint64_t indexOffset = m_Offset;
+			writeChunk(ECaptureChunkType::Index, 0, m_Index.data(), m_Index.size() * sizeof(CaptureIndexEntry));
+			writeChunk(ECaptureChunkType::Footer, 0, &indexOffset, sizeof(indexOffset));
+		}
+		flush();
+		m_Good = std::fclose(m_File) == 0 && m_Good;
+		m_File = nullptr;
+		m_Buffer.reset();
+		return m_Good;
+	}
+
+	void CaptureWriter::writeHeader()
+	{
+		CaptureHeader header {};
+		std::memcpy(header.Magic, c_CaptureMagic, sizeof(c_CaptureMagic));
+		header.Version               = c_CaptureVersion;
+		header.HeaderSize            = sizeof(CaptureHeader);
+		header.Abilities             = g_State.Abilities.Value;
+		header.Flags                 = 0;
+		header.LowResClockFrequency  = 1'000'000'000ULL;
+		header.HighResClockFrequency = g_State.InvariantClockFrequency;
+		header.HighResClockOffset    = g_State.InvariantClockOffset;
+		header.HighResClockEpoch     = g_State.InvariantClockEpoch;
+		header.HighResClockScale     = g_State.InvariantClockScale;
+		writeHeader(header);
+	}
+
+	void CaptureWriter::writeHeader(const CaptureHeader& header)
+	{
+		write(&header, sizeof(header));
+	}
+
+	void CaptureWriter::writeChunk(ECaptureChunkType type, std::uint32_t flags, const void* data, std::size_t size)
+	{
+		if (type != ECaptureChunkType::Index && type != ECaptureChunkType::Footer)
+			addIndexEntry(type, flags, size);
+
+		CaptureChunkHeader header {};
+		header.Type  = type;
+		header.Flags = flags;
+		header.Size  = size;
+		write(&header, sizeof(header));
+		write(data, size);
+	}
+
+	void CaptureWriter::copyChunk(const CaptureIndexEntry& entry, const std::uint8_t* data)
+	{
+		CaptureIndexEntry& copy = m_Index.emplace_back(entry);
+		copy.Offset             = m_Offset;
+
+		CaptureChunkHeader header {};
+		header.Type  = entry.Type;
+		header.Flags = entry.Flags;
+		header.Size  = entry.Size;
+		write(&header, sizeof(header));
+		write(data, entry.Size);
+	}
+
+	std::size_t CaptureWriter::writeZones(std::size_t first)
+	{
+		std::lock_guard lock(g_State.ZoneDescriptorsMutex);
+		auto&           descriptors = g_State.ZoneDescriptors;
+		if (first >= descriptors.size())
+			return descriptors.size();
+
+		std::vector<std::uint8_t> data;
+		auto append = [&data](const void* bytes, std::size_t size) {
+			data.insert(data.end(), static_cast<const std::uint8_t*>(bytes), static_cast<const std::uint8_t*>(bytes) + size);
+		};
+		for (std::size_t i = first; i < descriptors.size(); ++i)
+		{
+			const ZoneDescriptor* descriptor = descriptors[i];
+			std::string_view      name       = descriptor->Name;
+			std::string_view      function   = descriptor->Function;
+			std::string_view      file       = descriptor->File;
+			std::string_view      category   = descriptor->Category;
+
+			CaptureZoneEntry entry {};
+			entry.ID           = static_cast<std::uint32_t>(i + 1);
+			entry.Line         = descriptor->Line;
+			entry.Color        = descriptor->Color;
+			entry.NameSize     = static_cast<std::uint16_t>(std::min<std::size_t>(name.size(), 0xFFFF));
+			entry.FunctionSize = static_cast<std::uint16_t>(std::min<std::size_t>(function.size(), 0xFFFF));
+			entry.FileSize     = static_cast<std::uint16_t>(std::min<std::size_t>(file.size(), 0xFFFF));
+			entry.CategorySize = static_cast<std::uint16_t>(std::min<std::size_t>(category.size(), 0xFFFF));
+			append(&entry, sizeof(entry));
+			append(name.data(), entry.NameSize);
+			append(function.data(), entry.FunctionSize);
+			append(file.data(), entry.FileSize);
+			append(category.data(), entry.CategorySize);
+		}
+		writeChunk(ECaptureChunkType::Zones, 0, data.data(), data.size());
+		return descriptors.size();
+	}
+
+	void CaptureWriter::writeSymbols(const std::vector<ResolvedSymbol>& symbols)
+	{
+		std::vector<std::uint8_t> data;
+		for (auto& symbol : symbols)
+		{
+			CaptureSymbolEntry entry {};
+			entry.Address  = symbol.Address;
+			entry.Size     = symbol.Size;
+			entry.NameSize = static_cast<std::uint32_t>(symbol.Name.size());
+			data.insert(data.end(), reinterpret_cast<const std::uint8_t*>(&entry), reinterpret_cast<const std::uint8_t*>(&entry) + sizeof(entry));
+			data.insert(data.end(), symbol.Name.begin(), symbol.Name.end());
+		}
+		writeChunk(ECaptureChunkType::Symbols, 0, data.data(), data.size());
+	}
+
+	void CaptureWriter::writeLines(const ResolvedLines& lines)
+	{
+		std::vector<std::uint8_t> data;
+		auto append = [&data](const void* bytes, std::size_t size) {
+			data.insert(data.end(), static_cast<const std::uint8_t*>(bytes), static_cast<const std::uint8_t*>(bytes) + size);
+		};
+		CaptureLinesHeader header {};
+		header.StringCount   = static_cast<std::uint32_t>(lines.Strings.size());
+		header.LocationCount = static_cast<std::uint32_t>(lines.Locations.size());
+		header.FrameCount    = static_cast<std::uint32_t>(lines.Frames.size());
+		append(&header, sizeof(header));
+		append(lines.Locations.data(), lines.Locations.size() * sizeof(SourceLocation));
+		append(lines.Frames.data(), lines.Frames.size() * sizeof(SourceFrame));
+		for (auto& string : lines.Strings)
+		{
+			std::uint32_t size = static_cast<std::uint32_t>(string.size());
+			append(&size, sizeof(size));
+			append(string.data(), size);
+		}
+		writeChunk(ECaptureChunkType::Lines, 0, data.data(), data.size());
+	}
+
+	void CaptureWriter::writeModules(const std::vector<LoadedModule>& modules)
+	{
+		std::vector<std::uint8_t> data;
+		auto append = [&data](const void* bytes, std::size_t size) {
+			data.insert(data.end(), static_cast<const std::uint8_t*>(bytes), static_cast<const std::uint8_t*>(bytes) + size);
+		};
+		for (auto& module : modules)
+		{
+			CaptureModuleEntry entry {};
+			entry.Base        = module.Base;
+			entry.Start       = module.Start;
+			entry.End         = module.End;
+			entry.LoadTime    = module.LoadTime;
+			entry.UnloadTime  = module.UnloadTime;
+			entry.PathSize    = static_cast<std::uint16_t>(std::min<std::size_t>(module.Path.size(), 0xFFFF));
+			entry.BuildIDSize = static_cast<std::uint16_t>(std::min<std::size_t>(module.BuildID.size(), 0xFFFF));
+			append(&entry, sizeof(entry));
+			append(module.Path.data(), entry.PathSize);
+			append(module.BuildID.data(), entry.BuildIDSize);
+		}
+		writeChunk(ECaptureChunkType::Modules, 0, data.data(), data.size());
+	}
+
+	void CaptureWriter::writeEvents(const EncodedBlock* block)
+	{
+		const std::uint8_t* data     = block->Data;
+		std::size_t         dataSize = block->Size;
+		std::uint32_t       flags    = 0;
+		if (m_Compress)
+		{
+			if (!m_Scratch)
+				m_Scratch = std::make_unique<std::uint8_t[]>(CompressBound(c_EncodedBlockSize));
+			std::size_t compressedSize = Compress(block->Data, block->Size, m_Scratch.get(), CompressBound(c_EncodedBlockSize));
+			if (compressedSize && compressedSize < block->Size)
+			{
+				data      = m_Scratch.get();
+				dataSize  = compressedSize;
+				flags    |= c_CaptureChunkCompressed;
+			}
+		}
+
+		CaptureChunkHeader chunk {};
+		chunk.Type  = ECaptureChunkType::Events;
+		chunk.Flags = flags;
+		chunk.Size  = sizeof(CaptureEventsHeader) + dataSize;
+		CaptureEventsHeader header {};
+		header.ThreadID = block->ThreadID;
+		header.Count    = block->Count;
+		header.Size     = block->Size;
+		addIndexEntry(chunk.Type, chunk.Flags, chunk.Size, &header);
+		write(&chunk, sizeof(chunk));
+		write(&header, sizeof(header));
+		write(data, dataSize);
+	}
+
+	void CaptureWriter::addIndexEntry(ECaptureChunkType type, std::uint32_t flags, std::uint64_t size, const CaptureEventsHeader* events)
+	{
+		CaptureIndexEntry& entry = m_Index.emplace_back();
+		entry.Offset             = m_Offset;
+		entry.Size               = size;
+		entry.Type               = type;
+		entry.Flags              = flags;
+		entry.ThreadID           = events ? events->ThreadID : 0;
+		entry.Count              = events ? events->Count : 0;
+		entry.DataSize           = events ? events->Size : 0;
+	}
+
+	void CaptureWriter::write(const void* data, std::size_t size)
+	{
+		if (!m_File)
+			return;
+
+		m_Offset += size;
+		if (m_BufferSize + size > c_BufferSize)
+			flush();
+		if (size >= c_BufferSize)
+		{
+			m_Good = std::fwrite(data, 1, size, m_File) == size && m_Good;
+			return;
+		}
+		std::memcpy(m_Buffer.get() + m_BufferSize, data, size);
+		m_BufferSize += size;
+	}
+
+	void CaptureWriter::flush()
+	{
+		if (!m_File || !m_BufferSize)
+			return;
+		m_Good       = std::fwrite(m_Buffer.get(), 1, m_BufferSize, m_File) == m_BufferSize && m_Good;
+		m_BufferSize = 0;
+	}
+
+	bool WriteCaptures(const std::filesystem::path& filepath)
+	{
+		return WriteCaptures(filepath, true);
+	}
+
+	bool WriteCaptures(const std::filesystem::path& filepath, bool compress)
+	{
+		// A stopped capture is written whole, capture stopped by Frame only asked the threads to flush.
+		if (!g_State.Capturing)
+			FlushThreads();
+		FlushCollector();
+
+		CaptureWriter writer;
+		if (!writer.open(filepath))
+			return false;
+		writer.setCompression(compress);
+		writer.writeHeader();
+
+		if (!g_State.CallTrees.empty())
+		{
+			std::vector<CallTreeNode>  tree  = MergeCallTrees();
+			std::vector<CallGraphEdge> graph = BuildCallGraph(tree);
+			writer.writeChunk(ECaptureChunkType::CallTree, 0, tree.data(), tree.size() * sizeof(CallTreeNode));
+			writer.writeChunk(ECaptureChunkType::CallGraph, 0, graph.data(), graph.size() * sizeof(CallGraphEdge));
+		}
+
+		// Threads keep publishing while the capture is written, only the blocks counted here are written.
+		std::lock_guard                 readersLock(g_State.ChainReadersMutex);
+		std::vector<EventChain*>        chains = g_State.chains();
+		std::vector<CaptureThreadEntry> threads;
+		std::vector<std::size_t>        chainBlocks(chains.size());
+		for (std::size_t i = 0; i < chains.size(); ++i)
+		{
+			for (EncodedBlock* block = chains[i]->first(); block; block = EventChain::next(block))
+			{
+				++chainBlocks[i];
+				auto itr = std::find_if(threads.begin(), threads.end(), [block](const CaptureThreadEntry& entry) { return entry.ThreadID == block->ThreadID; });
+				if (itr == threads.end())
+					itr = threads.insert(threads.end(), CaptureThreadEntry { block->ThreadID, 0, 0 });
+				++itr->BlockCount;
+				itr->EventCount += block->Count;
+			}
+		}
+		writer.writeChunk(ECaptureChunkType::Threads, 0, threads.data(), threads.size() * sizeof(CaptureThreadEntry));
+
+		CaptureStats stats {};
+		stats.DroppedBlocks  = g_State.DroppedBlocks;
+		stats.DroppedEvents  = g_State.DroppedEvents;
+		stats.DroppedSamples = g_State.DroppedSamples;
+		writer.writeChunk(ECaptureChunkType::Stats, 0, &stats, sizeof(stats));
+
+		writer.writeZones(0);
+
+		UpdateModules();
+		writer.writeModules(ModuleSnapshot());
+		if (g_State.SymbolizeCaptures)
+		{
+			SymbolAddressCollector addresses;
+			for (std::size_t i = 0; i < chains.size(); ++i)
+			{
+				EncodedBlock* block = chains[i]->first();
+				for (std::size_t j = 0; j < chainBlocks[i]; ++j, block = EventChain::next(block))
+					addresses.collect(block);
+			}
+			writer.writeSymbols(ResolveSymbols(addresses.addresses()));
+			writer.writeLines(ResolveLines(addresses.addresses(), addresses.returnAddresses()));
+		}
+
+		RecordClockSample(true);
+		{
+			std::lock_guard clockLock(g_State.ClockSamplesMutex);
+			writer.writeChunk(ECaptureChunkType::Clocks, 0, g_State.ClockSamples.data(), g_State.ClockSamples.size() * sizeof(ClockSample));
+		}
+
+		for (std::size_t i = 0; i < chains.size(); ++i)
+		{
+			EncodedBlock* block = chains[i]->first();
+			for (std::size_t j = 0; j < chainBlocks[i]; ++j, block = EventChain::next(block))
+				writer.writeEvents(block);
+		}
+		return writer.close();
+	}
+
+	bool SymbolizeCapture(const std::filesystem::path& input, const std::filesystem::path& output, const std::vector<std::filesystem::path>& searchPaths)
+	{
+		CaptureReader reader;
+		if (!reader.open(input))
+			return false;
+
+		CaptureWriter writer;
+		if (!writer.open(output))
+			return false;
+		// Chunks are copied as they are, older versions differ only in the header, which is rewritten at the current size.
+		CaptureHeader header = reader.header();
+		header.Version       = c_CaptureVersion;
+		header.HeaderSize    = sizeof(CaptureHeader);
+		writer.writeHeader(header);
+		for (auto& entry : reader.index())
+		{
+			// Symbols the capture was written with are replaced, not merged.
+			if (entry.Type != ECaptureChunkType::Symbols && entry.Type != ECaptureChunkType::Lines)
+				writer.copyChunk(entry, reader.chunkData(entry));
+		}
+
+		bool                   result = true;
+		SymbolAddressCollector addresses;
+		CaptureEventRange      range;
+		for (auto& block : reader.blocks())
+		{
+			if (!range.reset(block))
+			{
+				result = false;
+				continue;
+			}
+			for (auto& event : range)
+				addresses.collect(block.ThreadID, event.Data, event.Type);
+		}
+
+		std::vector<LoadedModule> modules;
+		for (auto& module : reader.modules())
+			modules.emplace_back(LoadedModule { module.Base, module.Start, module.End, module.LoadTime, module.UnloadTime, std::string { module.Path }, std::string { module.BuildID } });
+		std::stable_sort(modules.begin(), modules.end(), [](const LoadedModule& lhs, const LoadedModule& rhs) { return lhs.Start < rhs.Start; });
+		writer.writeSymbols(ResolveSymbols(addresses.addresses(), modules, searchPaths));
+		writer.writeLines(ResolveLines(addresses.addresses(), addresses.returnAddresses(), modules, searchPaths));
+		return writer.close() && result;
+	}
+
+	static std::string FunctionName(const CaptureReader& reader, std::uint64_t address)
+	{
+		const CapturedSymbol* symbol = reader.symbol(address);
+		std::string           name   = symbol ? std::string { symbol->Name } : fmt::format("{:#x}", address);
+		auto                  frames = reader.sourceFrames(address);
+		if (!frames.empty())
+			name += fmt::format(" ({}:{})", frames.back().File, frames.back().Line);
+		return name;
+	}
+
+	static void WriteEvent(std::ostream& stream, const CaptureReader& reader, const Event* event)
+	{
+		switch (event->Type)
+		{
+		case EEventType::ThreadBounds:
+		{
+			const ThreadBoundsEvent* data = reinterpret_cast<const ThreadBoundsEvent*>(event);
+			stream << fmt::format("Thread Bounds {}, length: {}\n", data->ThreadID, data->Length);
+			break;
+		}
+		case EEventType::ThreadBegin:
+		{
+			const ThreadBeginEvent* data = reinterpret_cast<const ThreadBeginEvent*>(event);
+			stream << fmt::format("Thread Begin, time: {}, type: {}\n", static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::ThreadEnd:
+		{
+			const ThreadEndEvent* data = reinterpret_cast<const ThreadEndEvent*>(event);
+			stream << fmt::format("Thread End, time: {}, type: {}\n", static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::Frame:
+		{
+			const FrameEvent* data = reinterpret_cast<const FrameEvent*>(event);
+			stream << fmt::format("Frame {}, time: {}, type: {}\n", data->FrameNum, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::FunctionBegin:
+		{
+			const FunctionBeginEvent* data = reinterpret_cast<const FunctionBeginEvent*>(event);
+			stream << fmt::format("Function Begin {}, time: {}, type: {}\n", FunctionName(reader, reinterpret_cast<std::uintptr_t>(data->FunctionPtr)), static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::ZoneBegin:
+		{
+			const ZoneBeginEvent* data = reinterpret_cast<const ZoneBeginEvent*>(event);
+			stream << fmt::format("Zone Begin {}, time: {}, type: {}\n", data->DescriptorID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::FunctionEnd:
+		{
+			const FunctionEndEvent* data = reinterpret_cast<const FunctionEndEvent*>(event);
+			stream << fmt::format("Function End, time: {}, type: {}\n", static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::Callstack:
+		{
+			const CallstackEvent* data = reinterpret_cast<const CallstackEvent*>(event);
+			stream << fmt::format("    Callstack {}, entries: {}\n", data->DataID, data->NumEntries);
+			break;
+		}
+		case EEventType::Sample:
+		{
+			const SampleEvent* data = reinterpret_cast<const SampleEvent*>(event);
+			stream << fmt::format("Sample {}, entries: {}, time: {}, type: {}\n", data->DataID, data->NumEntries, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::ZoneSample:
+		{
+			const ZoneSampleEvent* data = reinterpret_cast<const ZoneSampleEvent*>(event);
+			stream << fmt::format("Zone Sample {} of thread {}, entries: {}, time: {}, type: {}\n", data->DataID, data->ThreadID, data->NumEntries, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::BoolArgument:
+		{
+			const BoolArgumentEvent* data = reinterpret_cast<const BoolArgumentEvent*>(event);
+			stream << fmt::format("    Argument {} = {}\n", data->Offset, data->Value);
+			break;
+		}
+		case EEventType::IntArgument:
+		{
+			const IntArgumentEvent* data = reinterpret_cast<const IntArgumentEvent*>(event);
+			switch (data->Size)
+			{
+			case 1:
+				stream << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0] & 0xFF);
+				break;
+			case 2:
+				stream << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0] & 0xFFFF);
+				break;
+			case 4:
+				stream << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0] & 0xFFFF'FFFF);
+				break;
+			case 8:
+				stream << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0] & 0xFFFF'FFFF'FFFF'FFFF);
+				break;
+			}
+			break;
+		}
+		case EEventType::FloatArgument:
+		{
+			const FloatArgumentEvent* data = reinterpret_cast<const FloatArgumentEvent*>(event);
+			switch (data->Size)
+			{
+			case 4:
+			{
+				float v;
+				std::memcpy(&v, data->Data, sizeof(v));
+				stream << fmt::format("    Argument {} = {}\n", data->Offset, v);
+				break;
+			}
+			case 8:
+			{
+				double v;
+				std::memcpy(&v, data->Data, sizeof(v));
+				stream << fmt::format("    Argument {} = {}\n", data->Offset, v);
+				break;
+			}
+			}
+			break;
+		}
+		case EEventType::FlagsArgument:
+		{
+			const FlagsArgumentEvent* data = reinterpret_cast<const FlagsArgumentEvent*>(event);
+			stream << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0]);
+			break;
+		}
+		case EEventType::PtrArgument:
+		{
+			const PtrArgumentEvent* data = reinterpret_cast<const PtrArgumentEvent*>(event);
+			stream << fmt::format("    Argument {} = {}\n", data->Offset, data->Ptr);
+			break;
+		}
+		case EEventType::ForLoopBegin:
+		{
+			const ForLoopBeginEvent* data = reinterpret_cast<const ForLoopBeginEvent*>(event);
+			stream << fmt::format("For Loop Begin, id: {}, time: {}, type: {}\n", data->ID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::ForLoopEnd:
+		{
+			const ForLoopEndEvent* data = reinterpret_cast<const ForLoopEndEvent*>(event);
+			stream << fmt::format("For Loop End, id: {}, time: {}, type: {}\n", data->ID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::ForLoopIterBegin:
+		{
+			const ForLoopIterBeginEvent* data = reinterpret_cast<const ForLoopIterBeginEvent*>(event);
+			stream << fmt::format("For Loop Iter Begin {}, id: {}, time: {}, type: {}\n", data->Index[0], data->ID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::ForLoopIterEnd:
+		{
+			const ForLoopIterEndEvent* data = reinterpret_cast<const ForLoopIterEndEvent*>(event);
+			stream << fmt::format("For Loop Iter End, id: {}, time: {}, type: {}\n", data->ID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::MemAlloc:
+		{
+			const MemAllocEvent* data = reinterpret_cast<const MemAllocEvent*>(event);
+			stream << fmt::format("Mem Alloc {}, size: {}, time: {}, type: {}\n", data->Memory, data->Size, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		case EEventType::MemFree:
+		{
+			const MemFreeEvent* data = reinterpret_cast<const MemFreeEvent*>(event);
+			stream << fmt::format("Mem Free {}, time: {}, type: {}\n", data->Memory, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	bool DumpCapture(const std::filesystem::path& filepath, std::ostream& stream)
+	{
+		CaptureReader reader;
+		if (!reader.open(filepath))
+			return false;
+
+		const CaptureHeader& header = reader.header();
+		stream << fmt::format("Capture version {}, abilities: {:#x}, LR frequency: {}, HR frequency: {}\n", header.Version, header.Abilities, header.LowResClockFrequency, header.HighResClockFrequency);
+		for (auto& thread : reader.threads())
+			stream << fmt::format("Thread {}, blocks: {}, events: {}\n", thread.ThreadID, thread.BlockCount, thread.EventCount);
+		stream << fmt::format("Dropped blocks: {}, dropped events: {}, dropped samples: {}\n", reader.stats().DroppedBlocks, reader.stats().DroppedEvents, reader.stats().DroppedSamples);
+		stream << fmt::format("Clock samples: {}\n", reader.clockSamples().size());
+		for (auto& module : reader.modules())
+			stream << fmt::format("Module {:#x}-{:#x} {}, build ID: {}, base: {:#x}, loaded: {}, unloaded: {}\n", module.Start, module.End, module.Path, module.BuildID, module.Base, module.LoadTime, module.UnloadTime);
+		stream << fmt::format("Symbols: {}, source locations: {}\n", reader.symbols().size(), reader.sourceLocations().size());
+		for (auto& zone : reader.zoneDescriptors())
+		{
+			if (zone.ID)
+				stream << fmt::format("Zone {}: {} ({}:{}), category: {}, color: {:#08x}\n", zone.ID, zone.Name, zone.File, zone.Line, zone.Category, zone.Color);
+		}
+
+		auto keyName = [&reader](std::uint64_t key) {
+			if (!(key & c_AggregateZoneKey))
+				return FunctionName(reader, key);
+			auto zone = reader.zoneDescriptor(static_cast<std::uint32_t>(key & ~c_AggregateZoneKey));
+			return zone ? std::string { zone->Name } : fmt::format("Zone {}", key & ~c_AggregateZoneKey);
+		};
+		auto& tree = reader.callTree();
+		for (std::size_t i = 1; i < tree.size(); ++i)
+			stream << fmt::format("{:{}}Call {}, count: {}, inclusive: {}, exclusive: {}\n", "", tree[i].Depth * 2, keyName(tree[i].Key), tree[i].Count, tree[i].InclusiveTime, tree[i].ExclusiveTime);
+		for (auto& edge : reader.callGraph())
+			stream << fmt::format("Edge {} -> {}, count: {}, time: {}\n", edge.Caller ? keyName(edge.Caller) : "root", keyName(edge.Callee), edge.Count, edge.Time);
+
+		bool              result = true;
+		CaptureEventRange range;
+		for (auto& block : reader.blocks())
+		{
+			stream << fmt::format("Thread Bounds {}, length: {}\n", block.ThreadID, block.Count);
+			if (!range.reset(block))
+			{
+				result = false;
+				continue;
+			}
+			for (auto& event : range)
+			{
+				if (event.Type != EEventType::DataSection)
+					WriteEvent(stream, reader, &event.Data);
+			}
+		}
+		return result;
+	}
+} // namespace Profiler
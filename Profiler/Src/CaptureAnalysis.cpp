@@ -0,0 +1,246 @@
+#include "Profiler/CaptureAnalysis.h"
+#include "Profiler/Utils/WorkStealingPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <unordered_map>
+#include <utility>
+
+namespace Profiler
+{
+	namespace Detail
+	{
+		using ZoneArgument = std::pair<std::uint32_t, CapturedEvent>;
+
+		// Ends and arguments seen while the block's own zone stack was empty, they belong to zones
+		// opened in earlier blocks and are replayed in order once those are known.
+		struct CarriedOp
+		{
+		public:
+			bool           IsEnd = false;
+			EventTimestamp Timestamp {};
+			CapturedEvent  Argument;
+		};
+
+		// Zones are kept in begin order so stitching never has to sort.
+		// Their depths are relative to the carried stack before any of the block's ends, which is
+		// why they are stored minus the carried ends seen so far and may wrap around until stitched.
+		struct BlockZones
+		{
+		public:
+			std::vector<Zone>          Zones;
+			std::vector<std::uint32_t> Open;
+			std::vector<CarriedOp>     Carried;
+			std::vector<ZoneArgument>  Arguments;
+			bool                       Failed = false;
+		};
+
+		static bool IsArgument(EEventType type)
+		{
+			switch (type)
+			{
+			case EEventType::BoolArgument:
+			case EEventType::IntArgument:
+			case EEventType::FloatArgument:
+			case EEventType::FlagsArgument:
+			case EEventType::PtrArgument:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		static void PairBlock(const CaptureBlock& block, std::uint64_t blockIndex, BlockZones& result)
+		{
+			thread_local CaptureEventRange range;
+			if (!range.reset(block))
+			{
+				result.Failed = true;
+				return;
+			}
+
+			result.Zones.reserve(block.Count / 2);
+			std::uint64_t sequence = blockIndex << 32;
+			std::uint32_t popped   = 0;
+			for (auto& event : range)
+			{
+				switch (event.Type)
+				{
+				case EEventType::FunctionBegin:
+				{
+					auto& begin      = event.as<FunctionBeginEvent>();
+					Zone& zone       = result.Zones.emplace_back();
+					zone.FunctionPtr = begin.FunctionPtr;
+					zone.Begin       = begin.Timestamp;
+					zone.Sequence    = sequence;
+					zone.Depth       = static_cast<std::uint32_t>(result.Open.size()) - popped;
+					result.Open.emplace_back(static_cast<std::uint32_t>(result.Zones.size() - 1));
+					break;
+				}
+				case EEventType::ZoneBegin:
+				{
+					auto& begin       = event.as<ZoneBeginEvent>();
+					Zone& zone        = result.Zones.emplace_back();
+					zone.DescriptorID = begin.DescriptorID;
+					zone.Begin        = begin.Timestamp;
+					zone.Sequence     = sequence;
+					zone.Depth        = static_cast<std::uint32_t>(result.Open.size()) - popped;
+					result.Open.emplace_back(static_cast<std::uint32_t>(result.Zones.size() - 1));
+					break;
+				}
+				case EEventType::FunctionEnd:
+				{
+					auto& end = event.as<FunctionEndEvent>();
+					if (result.Open.empty())
+					{
+						result.Carried.emplace_back(CarriedOp { true, end.Timestamp, {} });
+						++popped;
+						break;
+					}
+					Zone& zone  = result.Zones[result.Open.back()];
+					zone.End    = end.Timestamp;
+					zone.Closed = true;
+					result.Open.pop_back();
+					break;
+				}
+				default:
+					if (!IsArgument(event.Type))
+						break;
+					if (result.Open.empty())
+						result.Carried.emplace_back(CarriedOp { false, {}, event });
+					else
+						result.Arguments.emplace_back(result.Open.back(), event);
+					break;
+				}
+				++sequence;
+			}
+		}
+
+		static void StitchThread(std::vector<BlockZones*>& blocks, const ClockConverter& clocks, ThreadZones& thread, CaptureAnalysis& analysis)
+		{
+			// Carried zones are patched in place inside the block that opened them, arguments are
+			// remembered by their index in the final zone table.
+			std::vector<std::pair<Zone*, std::uint32_t>> carried;
+			std::vector<ZoneArgument>                    carriedArguments;
+			std::vector<std::uint32_t>                   offsets;
+			std::uint32_t                                offset        = 0;
+			std::size_t                                  failedBlocks  = 0;
+			std::size_t                                  unmatchedEnds = 0;
+			offsets.reserve(blocks.size());
+			for (auto block : blocks)
+			{
+				offsets.emplace_back(offset);
+				if (block->Failed)
+				{
+					++failedBlocks;
+					continue;
+				}
+
+				std::uint32_t base = static_cast<std::uint32_t>(carried.size());
+				for (auto& op : block->Carried)
+				{
+					if (carried.empty())
+					{
+						if (op.IsEnd)
+						{
+							++unmatchedEnds;
+							++base;
+						}
+						continue;
+					}
+					if (op.IsEnd)
+					{
+						Zone* zone   = carried.back().first;
+						zone->End    = op.Timestamp;
+						zone->Closed = true;
+						carried.pop_back();
+					}
+					else
+					{
+						carriedArguments.emplace_back(carried.back().second, op.Argument);
+					}
+				}
+
+				for (auto& zone : block->Zones)
+					zone.Depth += base;
+				for (auto index : block->Open)
+					carried.emplace_back(&block->Zones[index], offset + index);
+				offset += static_cast<std::uint32_t>(block->Zones.size());
+			}
+
+			thread.Zones.reserve(offset);
+			for (auto block : blocks)
+				thread.Zones.insert(thread.Zones.end(), block->Zones.begin(), block->Zones.end());
+
+			// Counting sort of the arguments by zone, the order within a zone stays the capture order.
+			for (std::size_t i = 0; i < blocks.size(); ++i)
+			{
+				for (auto& argument : blocks[i]->Arguments)
+					++thread.Zones[offsets[i] + argument.first].ArgumentCount;
+			}
+			for (auto& argument : carriedArguments)
+				++thread.Zones[argument.first].ArgumentCount;
+			std::uint32_t argumentCount = 0;
+			for (auto& zone : thread.Zones)
+			{
+				zone.BeginTime      = clocks.toNanoseconds(zone.Begin);
+				zone.EndTime        = zone.Closed ? clocks.toNanoseconds(zone.End) : 0;
+				zone.FirstArgument  = argumentCount;
+				argumentCount      += zone.ArgumentCount;
+				zone.ArgumentCount  = 0;
+			}
+			thread.Arguments.resize(argumentCount);
+			auto place = [&thread](std::uint32_t index, const CapturedEvent& argument) {
+				Zone& zone                                                  = thread.Zones[index];
+				thread.Arguments[zone.FirstArgument + zone.ArgumentCount++] = argument;
+			};
+			for (std::size_t i = 0; i < blocks.size(); ++i)
+			{
+				for (auto& argument : blocks[i]->Arguments)
+					place(offsets[i] + argument.first, argument.second);
+				*blocks[i] = {};
+			}
+			for (auto& argument : carriedArguments)
+				place(argument.first, argument.second);
+
+			std::atomic_ref(analysis.FailedBlocks).fetch_add(failedBlocks, std::memory_order_relaxed);
+			std::atomic_ref(analysis.UnmatchedEnds).fetch_add(unmatchedEnds, std::memory_order_relaxed);
+			std::atomic_ref(analysis.UnclosedZones).fetch_add(carried.size(), std::memory_order_relaxed);
+		}
+	} // namespace Detail
+
+	CaptureAnalysis AnalyzeCapture(const CaptureReader& reader, std::size_t threadCount)
+	{
+		CaptureAnalysis analysis;
+
+		auto&                           blocks = reader.blocks();
+		std::vector<Detail::BlockZones> blockZones(blocks.size());
+
+		// Blocks of one thread keep their relative order in the file, so grouping them by first appearance is enough.
+		std::vector<std::vector<Detail::BlockZones*>>  threadBlocks;
+		std::unordered_map<std::uint64_t, std::size_t> threadIndices;
+		for (std::size_t i = 0; i < blocks.size(); ++i)
+		{
+			auto [itr, inserted] = threadIndices.try_emplace(blocks[i].ThreadID, threadBlocks.size());
+			if (inserted)
+			{
+				threadBlocks.emplace_back();
+				analysis.Threads.emplace_back().ThreadID = blocks[i].ThreadID;
+			}
+			threadBlocks[itr->second].emplace_back(&blockZones[i]);
+		}
+
+		ClockConverter          clocks(reader);
+		Utils::WorkStealingPool pool(threadCount);
+		pool.parallelFor(blocks.size(), [&](std::size_t i) {
+			Detail::PairBlock(blocks[i], i, blockZones[i]);
+		});
+		pool.parallelFor(threadBlocks.size(), [&](std::size_t i) {
+			Detail::StitchThread(threadBlocks[i], clocks, analysis.Threads[i], analysis);
+		});
+
+		for (auto& thread : analysis.Threads)
+			analysis.ZoneCount += thread.Zones.size();
+		return analysis;
+	}
+} // namespace Profiler
@@ -0,0 +1,426 @@
+#include "Profiler/CaptureReader.h"
+#include "Profiler/Compression.h"
+
+#include <cstring>
+
+#include <algorithm>
+
+#if BUILD_IS_SYSTEM_WINDOWS
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace Profiler
+{
+	bool CaptureEventRange::reset(const CaptureBlock& block)
+	{
+		if (block.Flags & c_CaptureChunkCompressed)
+		{
+			// Blocks are compressed whole, a larger size is corrupt and must not decide the allocation.
+			if (block.Size > c_EncodedBlockSize)
+			{
+				m_Decoder.reset(nullptr, 0);
+				return false;
+			}
+			m_Buffer.resize(block.Size);
+			if (Decompress(block.Data, block.DataSize, m_Buffer.data(), m_Buffer.size()) != block.Size)
+			{
+				m_Decoder.reset(nullptr, 0);
+				return false;
+			}
+			m_Decoder.reset(m_Buffer.data(), m_Buffer.size());
+		}
+		else
+		{
+			m_Decoder.reset(block.Data, std::min<std::size_t>(block.Size, block.DataSize));
+		}
+		return true;
+	}
+
+	bool CaptureReader::open(const std::filesystem::path& filepath)
+	{
+		close();
+
+#if BUILD_IS_SYSTEM_WINDOWS
+		HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER size {};
+		if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+		m_File    = file;
+		m_Mapping = mapping;
+		m_Data    = static_cast<const std::uint8_t*>(data);
+		m_Size    = static_cast<std::size_t>(size.QuadPart);
+#else
+		int fd = ::open(filepath.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat st {};
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			::close(fd);
+			return false;
+		}
+		void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED)
+			return false;
+		m_Data = static_cast<const std::uint8_t*>(data);
+		m_Size = static_cast<std::size_t>(st.st_size);
+#endif
+
+		if (m_Size < c_CaptureHeaderV1Size)
+		{
+			close();
+			return false;
+		}
+		std::memcpy(&m_Header, m_Data, c_CaptureHeaderV1Size);
+		if (std::memcmp(m_Header.Magic, c_CaptureMagic, sizeof(c_CaptureMagic)) != 0 ||
+			m_Header.Version > c_CaptureVersion ||
+			m_Header.HeaderSize < c_CaptureHeaderV1Size ||
+			m_Header.HeaderSize > m_Size)
+		{
+			close();
+			return false;
+		}
+		// Older headers are shorter, the fields they lack stay zero.
+		std::memcpy(&m_Header, m_Data, std::min<std::size_t>(m_Header.HeaderSize, sizeof(m_Header)));
+
+		// Captures that were never closed properly have no index, those have to be scanned chunk by chunk.
+		if (!readIndex() && !scanChunks())
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void CaptureReader::close()
+	{
+		if (m_Data)
+		{
+#if BUILD_IS_SYSTEM_WINDOWS
+			UnmapViewOfFile(m_Data);
+			CloseHandle(m_Mapping);
+			CloseHandle(m_File);
+			m_Mapping = nullptr;
+			m_File    = nullptr;
+#else
+			munmap(const_cast<std::uint8_t*>(m_Data), m_Size);
+#endif
+		}
+		m_Data   = nullptr;
+		m_Size   = 0;
+		m_Header = {};
+		m_Stats  = {};
+		m_Threads.clear();
+		m_ClockSamples.clear();
+		m_Blocks.clear();
+		m_Index.clear();
+		m_Chunks.clear();
+		m_CallTree.clear();
+		m_CallGraph.clear();
+		m_ZoneDescriptors.clear();
+		m_Symbols.clear();
+		m_SourceLocations.clear();
+		m_SourceFrames.clear();
+		m_Modules.clear();
+	}
+
+	bool CaptureReader::readIndex()
+	{
+		constexpr std::size_t c_FooterSize = sizeof(CaptureChunkHeader) + sizeof(std::uint64_t);
+		if (m_Size < m_Header.HeaderSize + c_FooterSize)
+			return false;
+
+		CaptureChunkHeader footer;
+		std::uint64_t      indexOffset;
+		std::memcpy(&footer, m_Data + m_Size - c_FooterSize, sizeof(footer));
+		std::memcpy(&indexOffset, m_Data + m_Size - sizeof(indexOffset), sizeof(indexOffset));
+		if (footer.Type != ECaptureChunkType::Footer || footer.Size != sizeof(indexOffset) || indexOffset > m_Size - c_FooterSize - sizeof(CaptureChunkHeader))
+			return false;
+
+		CaptureChunkHeader index;
+		std::memcpy(&index, m_Data + indexOffset, sizeof(index));
+		if (index.Type != ECaptureChunkType::Index || index.Size > m_Size - indexOffset - sizeof(index))
+			return false;
+
+		std::size_t count = index.Size / sizeof(CaptureIndexEntry);
+		m_Blocks.reserve(count);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			CaptureIndexEntry entry;
+			std::memcpy(&entry, m_Data + indexOffset + sizeof(index) + i * sizeof(entry), sizeof(entry));
+			addChunk(entry);
+		}
+		return true;
+	}
+
+	bool CaptureReader::scanChunks()
+	{
+		std::size_t offset = m_Header.HeaderSize;
+		while (m_Size - offset >= sizeof(CaptureChunkHeader))
+		{
+			CaptureChunkHeader chunk;
+			std::memcpy(&chunk, m_Data + offset, sizeof(chunk));
+			if (chunk.Size > m_Size - offset - sizeof(chunk))
+				break;
+
+			CaptureIndexEntry entry {};
+			entry.Offset = offset;
+			entry.Size   = chunk.Size;
+			entry.Type   = chunk.Type;
+			entry.Flags  = chunk.Flags;
+			if (chunk.Type == ECaptureChunkType::Events && chunk.Size >= sizeof(CaptureEventsHeader))
+			{
+				CaptureEventsHeader events;
+				std::memcpy(&events, m_Data + offset + sizeof(chunk), sizeof(events));
+				entry.ThreadID = events.ThreadID;
+				entry.Count    = events.Count;
+				entry.DataSize = events.Size;
+			}
+			addChunk(entry);
+			offset += sizeof(chunk) + chunk.Size;
+		}
+		return true;
+	}
+
+	void CaptureReader::addChunk(const CaptureIndexEntry& entry)
+	{
+		// Offsets and sizes come from the file, compared by subtraction so that neither can overflow.
+		if (entry.Offset > m_Size || m_Size - entry.Offset < sizeof(CaptureChunkHeader) || entry.Size > m_Size - entry.Offset - sizeof(CaptureChunkHeader))
+			return;
+
+		const std::uint8_t* data = chunkData(entry);
+		if (entry.Type != ECaptureChunkType::Index && entry.Type != ECaptureChunkType::Footer)
+			m_Index.emplace_back(entry);
+		switch (entry.Type)
+		{
+		case ECaptureChunkType::Threads:
+		{
+			std::size_t count = entry.Size / sizeof(CaptureThreadEntry);
+			std::size_t first = m_Threads.size();
+			m_Threads.resize(first + count);
+			std::memcpy(m_Threads.data() + first, data, count * sizeof(CaptureThreadEntry));
+			break;
+		}
+		case ECaptureChunkType::Events:
+		{
+			if (entry.Size < sizeof(CaptureEventsHeader))
+				break;
+			CaptureBlock& block = m_Blocks.emplace_back();
+			block.ThreadID      = entry.ThreadID;
+			block.Count         = entry.Count;
+			block.Size          = entry.DataSize;
+			block.Flags         = entry.Flags;
+			block.Data          = data + sizeof(CaptureEventsHeader);
+			block.DataSize      = entry.Size - sizeof(CaptureEventsHeader);
+			break;
+		}
+		case ECaptureChunkType::Stats:
+			std::memcpy(&m_Stats, data, std::min<std::size_t>(sizeof(m_Stats), entry.Size));
+			break;
+		case ECaptureChunkType::Clocks:
+		{
+			std::size_t count = entry.Size / sizeof(ClockSample);
+			std::size_t first = m_ClockSamples.size();
+			m_ClockSamples.resize(first + count);
+			std::memcpy(m_ClockSamples.data() + first, data, count * sizeof(ClockSample));
+			break;
+		}
+		case ECaptureChunkType::Zones:
+			addZones(data, entry.Size);
+			break;
+		case ECaptureChunkType::CallTree:
+		{
+			std::size_t count = entry.Size / sizeof(CallTreeNode);
+			m_CallTree.resize(count);
+			std::memcpy(m_CallTree.data(), data, count * sizeof(CallTreeNode));
+			break;
+		}
+		case ECaptureChunkType::CallGraph:
+		{
+			std::size_t count = entry.Size / sizeof(CallGraphEdge);
+			m_CallGraph.resize(count);
+			std::memcpy(m_CallGraph.data(), data, count * sizeof(CallGraphEdge));
+			break;
+		}
+		case ECaptureChunkType::Symbols:
+			addSymbols(data, entry.Size);
+			break;
+		case ECaptureChunkType::Lines:
+			addLines(data, entry.Size);
+			break;
+		case ECaptureChunkType::Modules:
+			addModules(data, entry.Size);
+			break;
+		case ECaptureChunkType::Index:
+		case ECaptureChunkType::Footer:
+			break;
+		default:
+			m_Chunks.emplace_back(entry);
+			break;
+		}
+	}
+
+	void CaptureReader::addZones(const std::uint8_t* data, std::size_t size)
+	{
+		// IDs are dense from 1, one past what the chunk can hold is a corrupt entry rather than a reason to allocate.
+		const std::uint8_t* end   = data + size;
+		std::size_t         maxID = m_ZoneDescriptors.size() + size / sizeof(CaptureZoneEntry);
+		while (static_cast<std::size_t>(end - data) >= sizeof(CaptureZoneEntry))
+		{
+			CaptureZoneEntry entry;
+			std::memcpy(&entry, data, sizeof(entry));
+			data += sizeof(entry);
+
+			std::size_t stringsSize = entry.NameSize + entry.FunctionSize + entry.FileSize + entry.CategorySize;
+			if (!entry.ID || entry.ID > maxID || static_cast<std::size_t>(end - data) < stringsSize)
+				break;
+
+			auto readString = [&data](std::uint16_t length) {
+				std::string_view string { reinterpret_cast<const char*>(data), length };
+				data += length;
+				return string;
+			};
+			if (m_ZoneDescriptors.size() < entry.ID)
+				m_ZoneDescriptors.resize(entry.ID);
+			CapturedZoneDescriptor& descriptor = m_ZoneDescriptors[entry.ID - 1];
+			descriptor.ID                      = entry.ID;
+			descriptor.Line                    = entry.Line;
+			descriptor.Color                   = entry.Color;
+			descriptor.Name                    = readString(entry.NameSize);
+			descriptor.Function                = readString(entry.FunctionSize);
+			descriptor.File                    = readString(entry.FileSize);
+			descriptor.Category                = readString(entry.CategorySize);
+		}
+	}
+
+	void CaptureReader::addSymbols(const std::uint8_t* data, std::size_t size)
+	{
+		const std::uint8_t* end = data + size;
+		while (static_cast<std::size_t>(end - data) >= sizeof(CaptureSymbolEntry))
+		{
+			CaptureSymbolEntry entry;
+			std::memcpy(&entry, data, sizeof(entry));
+			data += sizeof(entry);
+			if (static_cast<std::size_t>(end - data) < entry.NameSize)
+				break;
+
+			m_Symbols.emplace_back(CapturedSymbol { entry.Address, entry.Size, std::string_view { reinterpret_cast<const char*>(data), entry.NameSize } });
+			data += entry.NameSize;
+		}
+		std::sort(m_Symbols.begin(), m_Symbols.end(), [](const CapturedSymbol& lhs, const CapturedSymbol& rhs) { return lhs.Address < rhs.Address; });
+	}
+
+	const CapturedSymbol* CaptureReader::symbol(std::uint64_t address) const
+	{
+		auto itr = std::upper_bound(m_Symbols.begin(), m_Symbols.end(), address, [](std::uint64_t value, const CapturedSymbol& symbol) { return value < symbol.Address; });
+		if (itr == m_Symbols.begin())
+			return nullptr;
+		const CapturedSymbol& symbol = *(itr - 1);
+		if (symbol.Size ? address >= symbol.Address + symbol.Size : address != symbol.Address)
+			return nullptr;
+		return &symbol;
+	}
+
+	void CaptureReader::addLines(const std::uint8_t* data, std::size_t size)
+	{
+		CaptureLinesHeader header;
+		if (size < sizeof(header))
+			return;
+		std::memcpy(&header, data, sizeof(header));
+		std::size_t tableSize = sizeof(header) + static_cast<std::size_t>(header.LocationCount) * sizeof(SourceLocation) + static_cast<std::size_t>(header.FrameCount) * sizeof(SourceFrame);
+		if (tableSize > size)
+			return;
+
+		const std::uint8_t*           cur = data + tableSize;
+		const std::uint8_t*           end = data + size;
+		std::vector<std::string_view> strings;
+		strings.reserve(std::min<std::size_t>(header.StringCount, static_cast<std::size_t>(end - cur) / sizeof(std::uint32_t)));
+		for (std::uint32_t i = 0; i < header.StringCount; ++i)
+		{
+			std::uint32_t length;
+			if (static_cast<std::size_t>(end - cur) < sizeof(length))
+				return;
+			std::memcpy(&length, cur, sizeof(length));
+			cur += sizeof(length);
+			if (static_cast<std::size_t>(end - cur) < length)
+				return;
+			strings.emplace_back(reinterpret_cast<const char*>(cur), length);
+			cur += length;
+		}
+		auto string = [&strings](std::uint32_t id) { return id < strings.size() ? strings[id] : std::string_view {}; };
+
+		std::size_t firstFrame = m_SourceFrames.size();
+		const auto* frames     = data + sizeof(header) + static_cast<std::size_t>(header.LocationCount) * sizeof(SourceLocation);
+		for (std::uint32_t i = 0; i < header.FrameCount; ++i)
+		{
+			SourceFrame frame;
+			std::memcpy(&frame, frames + i * sizeof(SourceFrame), sizeof(frame));
+			m_SourceFrames.emplace_back(CapturedSourceFrame { string(frame.Function), string(frame.File), frame.Line, frame.Column });
+		}
+		for (std::uint32_t i = 0; i < header.LocationCount; ++i)
+		{
+			SourceLocation location;
+			std::memcpy(&location, data + sizeof(header) + i * sizeof(SourceLocation), sizeof(location));
+			if (location.FirstFrame > header.FrameCount || location.FrameCount > header.FrameCount - location.FirstFrame)
+				continue;
+			location.FirstFrame += static_cast<std::uint32_t>(firstFrame);
+			m_SourceLocations.emplace_back(location);
+		}
+		std::sort(m_SourceLocations.begin(), m_SourceLocations.end(), [](const SourceLocation& lhs, const SourceLocation& rhs) { return lhs.Address < rhs.Address; });
+	}
+
+	std::span<const CapturedSourceFrame> CaptureReader::sourceFrames(std::uint64_t address) const
+	{
+		auto itr = std::lower_bound(m_SourceLocations.begin(), m_SourceLocations.end(), address, [](const SourceLocation& location, std::uint64_t value) { return location.Address < value; });
+		if (itr == m_SourceLocations.end() || itr->Address != address)
+			return {};
+		return { m_SourceFrames.data() + itr->FirstFrame, itr->FrameCount };
+	}
+
+	void CaptureReader::addModules(const std::uint8_t* data, std::size_t size)
+	{
+		const std::uint8_t* end = data + size;
+		while (static_cast<std::size_t>(end - data) >= sizeof(CaptureModuleEntry))
+		{
+			CaptureModuleEntry entry;
+			std::memcpy(&entry, data, sizeof(entry));
+			data += sizeof(entry);
+			if (static_cast<std::size_t>(end - data) < static_cast<std::size_t>(entry.PathSize) + entry.BuildIDSize)
+				break;
+
+			CapturedModule& module = m_Modules.emplace_back();
+			module.Base            = entry.Base;
+			module.Start           = entry.Start;
+			module.End             = entry.End;
+			module.LoadTime        = entry.LoadTime;
+			module.UnloadTime      = entry.UnloadTime;
+			module.Path            = std::string_view { reinterpret_cast<const char*>(data), entry.PathSize };
+			module.BuildID         = std::string_view { reinterpret_cast<const char*>(data) + entry.PathSize, entry.BuildIDSize };
+			data += static_cast<std::size_t>(entry.PathSize) + entry.BuildIDSize;
+		}
+	}
+} // namespace Profiler
@@ -0,0 +1,69 @@
+#include "Profiler/ClockDomain.h"
+
+#include <algorithm>
+
+namespace Profiler
+{
+	void ClockConverter::reset(const CaptureReader& reader)
+	{
+		const CaptureHeader& header = reader.header();
+
+		std::vector<Point> highRes;
+		std::vector<Point> lowRes;
+		highRes.reserve(reader.clockSamples().size() + 1);
+		lowRes.reserve(reader.clockSamples().size());
+		if (header.HighResClockScale)
+			highRes.emplace_back(Point { header.HighResClockOffset, header.HighResClockEpoch });
+		for (auto& sample : reader.clockSamples())
+		{
+			highRes.emplace_back(Point { sample.Ticks, sample.Nanoseconds });
+			lowRes.emplace_back(Point { sample.LowResTime, sample.Nanoseconds });
+		}
+
+		double highResSlope = header.HighResClockFrequency ? 1e9 / static_cast<double>(header.HighResClockFrequency) : 1.0;
+		double lowResSlope  = header.LowResClockFrequency ? 1e9 / static_cast<double>(header.LowResClockFrequency) : 1.0;
+		m_HighRes.reset(std::move(highRes), highResSlope);
+		m_LowRes.reset(std::move(lowRes), lowResSlope);
+	}
+
+	void ClockConverter::Mapping::reset(std::vector<Point> points, double defaultSlope)
+	{
+		// Samples are recorded in order, but streamed captures may repeat them, so only keep strictly increasing ones.
+		std::sort(points.begin(), points.end(), [](const Point& lhs, const Point& rhs) { return lhs.From < rhs.From; });
+		Points.clear();
+		for (auto& point : points)
+		{
+			if (Points.empty() || (point.From > Points.back().From && point.To > Points.back().To))
+				Points.emplace_back(point);
+		}
+		DefaultSlope = defaultSlope;
+	}
+
+	std::uint64_t ClockConverter::Mapping::map(std::uint64_t value) const
+	{
+		if (Points.empty())
+			return static_cast<std::uint64_t>(static_cast<double>(value) * DefaultSlope);
+
+		const Point* lhs   = nullptr;
+		const Point* rhs   = nullptr;
+		double       slope = DefaultSlope;
+		if (Points.size() == 1)
+		{
+			lhs = &Points[0];
+		}
+		else
+		{
+			auto itr = std::upper_bound(Points.begin(), Points.end(), value, [](std::uint64_t value, const Point& point) { return value < point.From; });
+			if (itr == Points.begin())
+				++itr;
+			else if (itr == Points.end())
+				--itr;
+			lhs   = &*(itr - 1);
+			rhs   = &*itr;
+			slope = static_cast<double>(rhs->To - lhs->To) / static_cast<double>(rhs->From - lhs->From);
+		}
+
+		double offset = value >= lhs->From ? static_cast<double>(value - lhs->From) * slope : -static_cast<double>(lhs->From - value) * slope;
+		return static_cast<std::uint64_t>(static_cast<std::int64_t>(lhs->To) + static_cast<std::int64_t>(offset));
+	}
+} // namespace Profiler
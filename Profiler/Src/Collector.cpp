@@ -0,0 +1,223 @@
+#include "Profiler/Capture.h"
+#include "Profiler/Collector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace Profiler
+{
+	static struct CollectorData
+	{
+		~CollectorData()
+		{
+			g_State.UseCollector = false;
+			Running              = false;
+			if (Thread.joinable())
+				Thread.join();
+		}
+
+		std::thread          Thread;
+		std::atomic_bool     Running      = false;
+		std::atomic_uint64_t FlushRequest = 0;
+		std::atomic_uint64_t FlushAck     = 0;
+		std::atomic_bool     FinalStream  = false;
+
+		std::mutex                      StreamMutex;
+		CaptureWriter                   Writer;
+		std::vector<CaptureThreadEntry> StreamedThreads;
+		std::size_t                     StreamedClockSamples = 0;
+		std::size_t                     StreamedZones        = 0;
+		SymbolAddressCollector          StreamedAddresses;
+	} s_Collector;
+
+	// Stores at most the blocks queued when called, so a flush request is answered even while producers keep pushing.
+	static bool CollectPending()
+	{
+		std::size_t pending   = g_State.PendingCount.load(std::memory_order_acquire);
+		bool        collected = false;
+		for (; pending; --pending)
+		{
+			EventBlock* block = g_State.PendingBlocks.pop();
+			if (!block)
+				break;
+			g_State.PendingCount.fetch_sub(1, std::memory_order_relaxed);
+			block->Chain->store(block);
+			collected = true;
+		}
+		return collected;
+	}
+
+	// Runs once UseCollector is cleared, threads that saw it set have already raised PendingCount.
+	static void DrainPending()
+	{
+		while (g_State.PendingCount.load(std::memory_order_seq_cst))
+		{
+			if (!CollectPending())
+				std::this_thread::yield();
+		}
+	}
+
+	static void StreamBlocks()
+	{
+		std::lock_guard streamLock(s_Collector.StreamMutex);
+		if (!s_Collector.Writer.isOpen())
+			return;
+
+		s_Collector.StreamedZones = s_Collector.Writer.writeZones(s_Collector.StreamedZones);
+		{
+			std::lock_guard clockLock(g_State.ClockSamplesMutex);
+			auto&           samples = g_State.ClockSamples;
+			if (s_Collector.StreamedClockSamples < samples.size())
+			{
+				s_Collector.Writer.writeChunk(ECaptureChunkType::Clocks, 0, samples.data() + s_Collector.StreamedClockSamples, (samples.size() - s_Collector.StreamedClockSamples) * sizeof(ClockSample));
+				s_Collector.StreamedClockSamples = samples.size();
+			}
+		}
+
+		// Taken blocks belong to the collector, writing them needs no lock beyond keeping capture writers off the chains.
+		std::lock_guard readersLock(g_State.ChainReadersMutex);
+		for (auto chain : g_State.chains())
+		{
+			EncodedBlock* block = chain->take();
+			while (block)
+			{
+				EncodedBlock* nextBlock = EventChain::next(block);
+				s_Collector.Writer.writeEvents(block);
+				if (g_State.SymbolizeCaptures)
+					s_Collector.StreamedAddresses.collect(block);
+
+				auto& threads = s_Collector.StreamedThreads;
+				auto  itr     = std::find_if(threads.begin(), threads.end(), [block](const CaptureThreadEntry& entry) { return entry.ThreadID == block->ThreadID; });
+				if (itr == threads.end())
+					itr = threads.insert(threads.end(), CaptureThreadEntry { block->ThreadID, 0, 0 });
+				++itr->BlockCount;
+				itr->EventCount += block->Count;
+
+				g_State.EncodedBlocks.release(block);
+				block = nextBlock;
+			}
+		}
+	}
+
+	static void CollectorFunc()
+	{
+		while (s_Collector.Running.load(std::memory_order_acquire))
+		{
+			std::uint64_t request     = s_Collector.FlushRequest.load(std::memory_order_acquire);
+			bool          finalStream = s_Collector.FinalStream.load(std::memory_order_acquire);
+			bool          collected   = CollectPending();
+			RecordClockSample();
+			// Chains are only taken from here, the collector is the thread storing into them.
+			if (finalStream || g_State.Streaming.load(std::memory_order_relaxed))
+				StreamBlocks();
+			s_Collector.FlushAck.store(request, std::memory_order_release);
+			if (!collected)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		DrainPending();
+	}
+
+	void StartCollector()
+	{
+		if (s_Collector.Running)
+			return;
+
+		s_Collector.Running = true;
+		s_Collector.Thread  = std::thread(&CollectorFunc);
+		g_State.UseCollector.store(true, std::memory_order_release);
+	}
+
+	void StopCollector()
+	{
+		if (!s_Collector.Running)
+			return;
+
+		StopStreaming();
+		// Threads storing directly would race the collector on their chains, they wait until it has drained.
+		g_State.CollectorDraining.store(true, std::memory_order_release);
+		g_State.UseCollector.store(false, std::memory_order_seq_cst);
+		s_Collector.Running = false;
+		s_Collector.Thread.join();
+		g_State.CollectorDraining.store(false, std::memory_order_release);
+	}
+
+	void FlushCollector()
+	{
+		if (!s_Collector.Running)
+			return;
+
+		std::uint64_t request = s_Collector.FlushRequest.fetch_add(1, std::memory_order_acq_rel) + 1;
+		while (s_Collector.FlushAck.load(std::memory_order_acquire) < request)
+			std::this_thread::yield();
+	}
+
+	bool IsCollectorRunning()
+	{
+		return s_Collector.Running;
+	}
+
+	bool StartStreaming(const std::filesystem::path& filepath, const StreamingOptions& options)
+	{
+		if (g_State.Streaming)
+			return false;
+
+		{
+			std::lock_guard lock(s_Collector.StreamMutex);
+			if (!s_Collector.Writer.open(filepath))
+				return false;
+			s_Collector.Writer.setCompression(options.Compress);
+			s_Collector.Writer.writeHeader();
+			s_Collector.StreamedThreads.clear();
+			s_Collector.StreamedClockSamples = 0;
+			s_Collector.StreamedZones        = 0;
+			s_Collector.StreamedAddresses.clear();
+		}
+		UpdateModules();
+		g_State.StreamingPolicy        = options.Policy;
+		g_State.StreamingHighWaterMark = options.HighWaterMark;
+		g_State.DroppedBlocks          = 0;
+		g_State.DroppedEvents          = 0;
+		g_State.DroppedSamples         = 0;
+		++g_State.CallstackGeneration;
+		StartCollector();
+		g_State.Streaming = true;
+		return true;
+	}
+
+	bool StopStreaming()
+	{
+		if (!g_State.Streaming)
+			return false;
+
+		g_State.Streaming = false;
+		RecordClockSample(true);
+		s_Collector.FinalStream.store(true, std::memory_order_release);
+		FlushCollector();
+		s_Collector.FinalStream.store(false, std::memory_order_release);
+
+		std::lock_guard lock(s_Collector.StreamMutex);
+		auto&           threads = s_Collector.StreamedThreads;
+		s_Collector.Writer.writeChunk(ECaptureChunkType::Threads, 0, threads.data(), threads.size() * sizeof(CaptureThreadEntry));
+		CaptureStats stats {};
+		stats.DroppedBlocks  = g_State.DroppedBlocks;
+		stats.DroppedEvents  = g_State.DroppedEvents;
+		stats.DroppedSamples = g_State.DroppedSamples;
+		s_Collector.Writer.writeChunk(ECaptureChunkType::Stats, 0, &stats, sizeof(stats));
+		UpdateModules();
+		s_Collector.Writer.writeModules(ModuleSnapshot());
+		if (g_State.SymbolizeCaptures)
+		{
+			s_Collector.Writer.writeSymbols(ResolveSymbols(s_Collector.StreamedAddresses.addresses()));
+			s_Collector.Writer.writeLines(ResolveLines(s_Collector.StreamedAddresses.addresses(), s_Collector.StreamedAddresses.returnAddresses()));
+		}
+		s_Collector.StreamedAddresses.clear();
+		return s_Collector.Writer.close();
+	}
+
+	bool IsStreaming()
+	{
+		return g_State.Streaming;
+	}
+} // namespace Profiler
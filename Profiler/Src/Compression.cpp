@@ -0,0 +1,239 @@
+#include "Profiler/Compression.h"
+
+#include <cstring>
+
+#include <bit>
+
+namespace Profiler
+{
+	static constexpr std::size_t   c_MinMatch     = 4;
+	static constexpr std::size_t   c_LastLiterals = 5;
+	static constexpr std::size_t   c_MatchSafety  = 12;
+	static constexpr std::size_t   c_MaxOffset    = 65535;
+	static constexpr std::uint32_t c_SkipStrength = 6;
+	// Room the fast decoding paths need past what they copy, they copy whole words.
+	static constexpr std::size_t c_WildCopySize = 16;
+
+	static std::uint32_t Read32(const std::uint8_t* ptr)
+	{
+		std::uint32_t value;
+		std::memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	static std::uint64_t Read64(const std::uint8_t* ptr)
+	{
+		std::uint64_t value;
+		std::memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	// Hashes the next 5 bytes, spreading positions better than 4 bytes do on event data.
+	template <std::uint32_t HashLog>
+	static std::uint32_t Hash(const std::uint8_t* ptr)
+	{
+		return static_cast<std::uint32_t>(((Read64(ptr) << 24) * 889523592379ULL) >> (64 - HashLog));
+	}
+
+	static bool WriteLength(std::uint8_t*& out, std::uint8_t* end, std::size_t length)
+	{
+		while (length >= 255)
+		{
+			if (out == end)
+				return false;
+			*out++  = 255;
+			length -= 255;
+		}
+		if (out == end)
+			return false;
+		*out++ = static_cast<std::uint8_t>(length);
+		return true;
+	}
+
+	static bool WriteSequence(std::uint8_t*& out, std::uint8_t* end, const std::uint8_t* literals, std::size_t literalCount, std::size_t offset, std::size_t matchLength)
+	{
+		if (out == end)
+			return false;
+		std::uint8_t* token = out++;
+		*token              = static_cast<std::uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4);
+		if (literalCount >= 15 && !WriteLength(out, end, literalCount - 15))
+			return false;
+		if (static_cast<std::size_t>(end - out) < literalCount)
+			return false;
+		// Literals before a match start well before the input's end, so a whole word can be copied.
+		if (matchLength && literalCount <= 8 && end - out >= 8)
+			std::memcpy(out, literals, 8);
+		else
+			std::memcpy(out, literals, literalCount);
+		out += literalCount;
+		if (!matchLength)
+			return true;
+
+		if (end - out < 2)
+			return false;
+		*out++ = static_cast<std::uint8_t>(offset);
+		*out++ = static_cast<std::uint8_t>(offset >> 8);
+
+		std::size_t length  = matchLength - c_MinMatch;
+		*token             |= length >= 15 ? 15 : length;
+		return length < 15 || WriteLength(out, end, length - 15);
+	}
+
+	// Positions are stored as T, inputs under 64 KiB fit a table of 16 bit positions twice the size for the same memory.
+	template <class T, std::uint32_t HashLog>
+	static std::size_t CompressBlock(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstCapacity)
+	{
+		std::uint8_t* out    = dst;
+		std::uint8_t* outEnd = dst + dstCapacity;
+
+		const std::uint8_t* anchor = src;
+		if (srcSize > c_MatchSafety)
+		{
+			T table[1 << HashLog];
+			std::memset(table, 0, sizeof(table));
+
+			const std::uint8_t* matchLimit = src + srcSize - c_LastLiterals;
+			const std::uint8_t* searchEnd  = src + srcSize - c_MatchSafety;
+			const std::uint8_t* ip         = src + 1;
+			std::uint32_t       attempts   = 1 << c_SkipStrength;
+			while (ip < searchEnd)
+			{
+				T&                  entry    = table[Hash<HashLog>(ip)];
+				std::size_t         position = static_cast<std::size_t>(ip - src);
+				const std::uint8_t* match    = src + entry;
+				bool                found    = entry < position && position - entry <= c_MaxOffset && Read32(match) == Read32(ip);
+				entry                        = static_cast<T>(position);
+				if (!found)
+				{
+					// Step further the longer no match has been found, incompressible data is skipped quickly.
+					ip += attempts++ >> c_SkipStrength;
+					continue;
+				}
+				attempts = 1 << c_SkipStrength;
+
+				while (ip > anchor && match > src && ip[-1] == match[-1])
+				{
+					--ip;
+					--match;
+				}
+
+				const std::uint8_t* matchEnd = ip + c_MinMatch;
+				const std::uint8_t* ref      = match + c_MinMatch;
+				std::uint64_t       diff     = 0;
+				while (matchEnd + 8 <= matchLimit && !(diff = Read64(matchEnd) ^ Read64(ref)))
+				{
+					matchEnd += 8;
+					ref      += 8;
+				}
+				if (diff)
+				{
+					matchEnd += std::countr_zero(diff) / 8;
+				}
+				else
+				{
+					while (matchEnd < matchLimit && *matchEnd == *ref)
+					{
+						++matchEnd;
+						++ref;
+					}
+				}
+
+				if (!WriteSequence(out, outEnd, anchor, ip - anchor, ip - match, matchEnd - ip))
+					return 0;
+				ip     = matchEnd;
+				anchor = ip;
+				if (ip < searchEnd)
+					table[Hash<HashLog>(ip - 2)] = static_cast<T>(ip - 2 - src);
+			}
+		}
+
+		if (!WriteSequence(out, outEnd, anchor, src + srcSize - anchor, 0, 0))
+			return 0;
+		return out - dst;
+	}
+
+	std::size_t Compress(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstCapacity)
+	{
+		if (srcSize < 65536)
+			return CompressBlock<std::uint16_t, 13>(src, srcSize, dst, dstCapacity);
+		return CompressBlock<std::uint32_t, 12>(src, srcSize, dst, dstCapacity);
+	}
+
+	static bool ReadLength(const std::uint8_t*& in, const std::uint8_t* end, std::size_t& length)
+	{
+		std::uint8_t byte;
+		do
+		{
+			if (in == end)
+				return false;
+			byte    = *in++;
+			length += byte;
+		}
+		while (byte == 255);
+		return true;
+	}
+
+	std::size_t Decompress(const std::uint8_t* src, std::size_t srcSize, std::uint8_t* dst, std::size_t dstCapacity)
+	{
+		const std::uint8_t* ip    = src;
+		const std::uint8_t* ipEnd = src + srcSize;
+		std::uint8_t*       op    = dst;
+		std::uint8_t*       opEnd = dst + dstCapacity;
+
+		while (ip < ipEnd)
+		{
+			std::uint8_t token   = *ip++;
+			std::size_t  literal = token >> 4;
+			if (literal < 15 && static_cast<std::size_t>(ipEnd - ip) >= c_WildCopySize && static_cast<std::size_t>(opEnd - op) >= c_WildCopySize)
+			{
+				std::memcpy(op, ip, c_WildCopySize);
+			}
+			else
+			{
+				if (literal == 15 && !ReadLength(ip, ipEnd, literal))
+					return 0;
+				if (static_cast<std::size_t>(ipEnd - ip) < literal || static_cast<std::size_t>(opEnd - op) < literal)
+					return 0;
+				std::memcpy(op, ip, literal);
+			}
+			ip += literal;
+			op += literal;
+			if (ip == ipEnd)
+				break;
+
+			if (ipEnd - ip < 2)
+				return 0;
+			std::size_t offset = ip[0] | (ip[1] << 8);
+			ip                += 2;
+			if (!offset || offset > static_cast<std::size_t>(op - dst))
+				return 0;
+
+			std::size_t length = token & 15;
+			if (length == 15 && !ReadLength(ip, ipEnd, length))
+				return 0;
+			length += c_MinMatch;
+			if (static_cast<std::size_t>(opEnd - op) < length)
+				return 0;
+
+			// Matches may overlap their own output, words can be copied as long as the offset spans a whole word.
+			const std::uint8_t* match = op - offset;
+			if (offset >= 8 && static_cast<std::size_t>(opEnd - op) >= length + 8)
+			{
+				for (std::size_t i = 0; i < length; i += 8)
+					std::memcpy(op + i, match + i, 8);
+				op += length;
+			}
+			else if (offset >= length)
+			{
+				std::memcpy(op, match, length);
+				op += length;
+			}
+			else
+			{
+				for (std::size_t i = 0; i < length; ++i)
+					*op++ = *match++;
+			}
+		}
+		return op - dst;
+	}
+} // namespace Profiler
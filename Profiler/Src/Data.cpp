@@ -11,10 +11,12 @@ namespace Profiler::Detail
 		auto&         header = NewEvent<DataHeaderEvent>(state);
 		header.ID            = id;
 		header.Size          = size;
+		state->DataSlots     = (size + sizeof(DataSectionEvent) - 1) / sizeof(DataSectionEvent);
 		while (size > 0)
 		{
 			std::size_t toTransfer = std::min<std::size_t>(size, 32);
 			auto&       section    = NewEvent<DataSectionEvent>(state);
+			--state->DataSlots;
 			std::memcpy(section.Data, ptr, toTransfer);
 			size -= toTransfer;
 			ptr  += toTransfer;
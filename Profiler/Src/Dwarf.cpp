@@ -0,0 +1,1146 @@
+#include "Profiler/Dwarf.h"
+
+#if BUILD_IS_SYSTEM_LINUX
+	#include <cstdlib>
+	#include <cstring>
+
+	#include <algorithm>
+	#include <string_view>
+	#include <unordered_map>
+
+	#include <cxxabi.h>
+
+namespace Profiler
+{
+	namespace Dw
+	{
+		enum ETag : std::uint32_t
+		{
+			TagCompileUnit       = 0x11,
+			TagInlinedSubroutine = 0x1D,
+			TagSubprogram        = 0x2E
+		};
+
+		enum EAttribute : std::uint32_t
+		{
+			AtName            = 0x03,
+			AtStmtList        = 0x10,
+			AtLowPc           = 0x11,
+			AtHighPc          = 0x12,
+			AtCompDir         = 0x1B,
+			AtAbstractOrigin  = 0x31,
+			AtSpecification   = 0x47,
+			AtRanges          = 0x55,
+			AtCallColumn      = 0x57,
+			AtCallFile        = 0x58,
+			AtCallLine        = 0x59,
+			AtLinkageName     = 0x6E,
+			AtStrOffsetsBase  = 0x72,
+			AtAddrBase        = 0x73,
+			AtRngListsBase    = 0x74,
+			AtMIPSLinkageName = 0x2007
+		};
+
+		enum EForm : std::uint32_t
+		{
+			FormAddr          = 0x01,
+			FormBlock2        = 0x03,
+			FormBlock4        = 0x04,
+			FormData2         = 0x05,
+			FormData4         = 0x06,
+			FormData8         = 0x07,
+			FormString        = 0x08,
+			FormBlock         = 0x09,
+			FormBlock1        = 0x0A,
+			FormData1         = 0x0B,
+			FormFlag          = 0x0C,
+			FormSData         = 0x0D,
+			FormStrp          = 0x0E,
+			FormUData         = 0x0F,
+			FormRefAddr       = 0x10,
+			FormRef1          = 0x11,
+			FormRef2          = 0x12,
+			FormRef4          = 0x13,
+			FormRef8          = 0x14,
+			FormRefUData      = 0x15,
+			FormIndirect      = 0x16,
+			FormSecOffset     = 0x17,
+			FormExprLoc       = 0x18,
+			FormFlagPresent   = 0x19,
+			FormStrx          = 0x1A,
+			FormAddrx         = 0x1B,
+			FormRefSup4       = 0x1C,
+			FormStrpSup       = 0x1D,
+			FormData16        = 0x1E,
+			FormLineStrp      = 0x1F,
+			FormRefSig8       = 0x20,
+			FormImplicitConst = 0x21,
+			FormLocListx      = 0x22,
+			FormRngListx      = 0x23,
+			FormRefSup8       = 0x24,
+			FormStrx1         = 0x25,
+			FormStrx2         = 0x26,
+			FormStrx3         = 0x27,
+			FormStrx4         = 0x28,
+			FormAddrx1        = 0x29,
+			FormAddrx2        = 0x2A,
+			FormAddrx3        = 0x2B,
+			FormAddrx4        = 0x2C,
+			FormGNUAddrIndex  = 0x1F01,
+			FormGNUStrIndex   = 0x1F02,
+			FormGNURefAlt     = 0x1F20,
+			FormGNUStrpAlt    = 0x1F21
+		};
+
+		enum ELineContent : std::uint32_t
+		{
+			LnctPath           = 0x1,
+			LnctDirectoryIndex = 0x2
+		};
+	} // namespace Dw
+
+	class DwarfReader
+	{
+	public:
+		DwarfReader(ElfSection section, std::uint64_t offset = 0)
+			: m_Data(section.Data), m_Cur(std::min<std::uint64_t>(offset, section.Size)), m_End(section.Size), m_Good(offset <= section.Size) {}
+
+		bool          good() const { return m_Good; }
+		bool          done() const { return m_Cur >= m_End; }
+		std::uint64_t offset() const { return m_Cur; }
+		void          limit(std::uint64_t end) { m_End = std::min(end, m_End); }
+
+		void skip(std::uint64_t count)
+		{
+			if (count > m_End - m_Cur)
+			{
+				m_Cur  = m_End;
+				m_Good = false;
+				return;
+			}
+			m_Cur += count;
+		}
+
+		template <class T>
+		T read()
+		{
+			T value {};
+			if (m_End - m_Cur < sizeof(T))
+			{
+				m_Cur  = m_End;
+				m_Good = false;
+				return value;
+			}
+			std::memcpy(&value, m_Data + m_Cur, sizeof(T));
+			m_Cur += sizeof(T);
+			return value;
+		}
+
+		std::uint64_t sized(std::uint8_t size)
+		{
+			switch (size)
+			{
+			case 1: return read<std::uint8_t>();
+			case 2: return read<std::uint16_t>();
+			case 3:
+			{
+				std::uint64_t low = read<std::uint16_t>();
+				return low | static_cast<std::uint64_t>(read<std::uint8_t>()) << 16;
+			}
+			case 4: return read<std::uint32_t>();
+			case 8: return read<std::uint64_t>();
+			default: m_Good = false; return 0;
+			}
+		}
+
+		std::uint64_t uleb()
+		{
+			std::uint64_t value = 0;
+			std::uint32_t shift = 0;
+			while (true)
+			{
+				if (m_Cur >= m_End)
+				{
+					m_Good = false;
+					break;
+				}
+				std::uint8_t byte = m_Data[m_Cur++];
+				if (shift < 64)
+					value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+				shift += 7;
+				if (!(byte & 0x80))
+					break;
+			}
+			return value;
+		}
+
+		std::int64_t sleb()
+		{
+			std::int64_t  value = 0;
+			std::uint32_t shift = 0;
+			std::uint8_t  byte  = 0;
+			while (true)
+			{
+				if (m_Cur >= m_End)
+				{
+					m_Good = false;
+					break;
+				}
+				byte = m_Data[m_Cur++];
+				if (shift < 64)
+					value |= static_cast<std::int64_t>(byte & 0x7F) << shift;
+				shift += 7;
+				if (!(byte & 0x80))
+					break;
+			}
+			if (shift < 64 && (byte & 0x40))
+				value |= -(static_cast<std::int64_t>(1) << shift);
+			return value;
+		}
+
+		// Returns nullptr if the string is not terminated inside the section.
+		const char* string()
+		{
+			const char* value = reinterpret_cast<const char*>(m_Data + m_Cur);
+			const void* end   = std::memchr(value, 0, m_End - m_Cur);
+			if (!end)
+			{
+				m_Cur  = m_End;
+				m_Good = false;
+				return nullptr;
+			}
+			m_Cur = static_cast<const std::uint8_t*>(end) - m_Data + 1;
+			return value;
+		}
+
+		// Reads a unit length, switching to 8 byte offsets for 64 bit DWARF.
+		std::uint64_t unitLength(std::uint8_t& offsetSize)
+		{
+			std::uint64_t length = read<std::uint32_t>();
+			offsetSize           = 4;
+			if (length == 0xFFFF'FFFF)
+			{
+				length     = read<std::uint64_t>();
+				offsetSize = 8;
+			}
+			return length;
+		}
+
+	private:
+		const std::uint8_t* m_Data;
+		std::uint64_t       m_Cur;
+		std::uint64_t       m_End;
+		bool                m_Good;
+	};
+
+	struct DwarfAttributeSpec
+	{
+	public:
+		std::uint32_t Name;
+		std::uint32_t Form;
+		std::int64_t  ImplicitConst;
+	};
+
+	struct DwarfAbbrev
+	{
+	public:
+		std::uint32_t Tag      = 0;
+		bool          Children = false;
+		std::uint32_t First    = 0;
+		std::uint32_t Count    = 0;
+	};
+
+	struct DwarfAbbrevTable
+	{
+	public:
+		std::vector<DwarfAbbrev>        Abbrevs; // Indexed by code
+		std::vector<DwarfAttributeSpec> Attributes;
+	};
+
+	struct DwarfValue
+	{
+	public:
+		std::uint32_t       Form  = 0;
+		std::uint64_t       Value = 0;
+		const std::uint8_t* Data  = nullptr;
+	};
+
+	// The attributes of a DIE the index uses, an attribute is missing if its Form is 0.
+	struct DwarfDie
+	{
+	public:
+		std::uint32_t Tag      = 0;
+		bool          Children = false;
+		DwarfValue    Name;
+		DwarfValue    LinkageName;
+		DwarfValue    LowPc;
+		DwarfValue    HighPc;
+		DwarfValue    Ranges;
+		DwarfValue    AbstractOrigin;
+		DwarfValue    Specification;
+		DwarfValue    CallFile;
+		DwarfValue    CallLine;
+		DwarfValue    CallColumn;
+		DwarfValue    StmtList;
+		DwarfValue    CompDir;
+		DwarfValue    StrOffsetsBase;
+		DwarfValue    AddrBase;
+		DwarfValue    RngListsBase;
+	};
+
+	struct DwarfUnit
+	{
+	public:
+		std::uint64_t           Offset      = 0;
+		std::uint64_t           End         = 0;
+		std::uint64_t           DieOffset   = 0;
+		std::uint16_t           Version     = 0;
+		std::uint8_t            AddressSize = 8;
+		std::uint8_t            OffsetSize  = 4;
+		const DwarfAbbrevTable* Abbrevs     = nullptr;
+
+		std::uint64_t StrOffsetsBase = 0;
+		std::uint64_t AddrBase       = 0;
+		std::uint64_t RngListsBase   = 0;
+		std::uint64_t BaseAddress    = 0;
+		std::uint64_t LineOffset     = ~0ULL;
+		const char*   CompDir        = nullptr;
+
+		const std::vector<std::uint32_t>* Files = nullptr;
+	};
+
+	// Discarded functions keep their DWARF with a zero or tombstone address.
+	static bool IsDiscardedAddress(std::uint64_t address)
+	{
+		return address == 0 || address >= ~1ULL;
+	}
+
+	static std::string JoinPath(std::string_view directory, std::string_view path)
+	{
+		if (directory.empty() || path.starts_with('/'))
+			return std::string { path };
+		std::string result { directory };
+		if (result.back() != '/')
+			result += '/';
+		result += path;
+		return result;
+	}
+
+	class DwarfBuilder
+	{
+	public:
+		DwarfBuilder(const ElfFile& elf, DwarfIndex& index)
+			: m_Index(index)
+		{
+			m_Info       = elf.section(".debug_info");
+			m_Abbrev     = elf.section(".debug_abbrev");
+			m_Line       = elf.section(".debug_line");
+			m_Str        = elf.section(".debug_str");
+			m_LineStr    = elf.section(".debug_line_str");
+			m_StrOffsets = elf.section(".debug_str_offsets");
+			m_Addr       = elf.section(".debug_addr");
+			m_Ranges     = elf.section(".debug_ranges");
+			m_RngLists   = elf.section(".debug_rnglists");
+		}
+
+		bool build()
+		{
+			if (!m_Line.Data)
+				return false;
+
+			readUnits();
+			for (auto& unit : m_Units)
+			{
+				if (unit.LineOffset != ~0ULL)
+					unit.Files = &decodeLines(unit);
+			}
+			for (auto& unit : m_Units)
+				readScopes(unit);
+
+			finishLines();
+			finishRanges();
+			m_Index.m_Lines.shrink_to_fit();
+			m_Index.m_Scopes.shrink_to_fit();
+			return !m_Index.m_Lines.empty();
+		}
+
+	private:
+		struct ScopeEntry
+		{
+		public:
+			std::uint64_t Low;
+			std::uint64_t High;
+			std::uint32_t Depth;
+			std::uint32_t Scope;
+		};
+
+	private:
+		std::uint32_t intern(std::string_view string)
+		{
+			auto itr = m_StringIDs.find(std::string { string });
+			if (itr != m_StringIDs.end())
+				return itr->second;
+			std::uint32_t id = static_cast<std::uint32_t>(m_Index.m_Strings.size());
+			m_Index.m_Strings.emplace_back(string);
+			m_StringIDs.emplace(m_Index.m_Strings.back(), id);
+			return id;
+		}
+
+		const DwarfAbbrevTable* abbrevs(std::uint64_t offset)
+		{
+			auto itr = m_AbbrevTables.find(offset);
+			if (itr != m_AbbrevTables.end())
+				return &itr->second;
+
+			DwarfAbbrevTable& table = m_AbbrevTables[offset];
+			DwarfReader       reader(m_Abbrev, offset);
+			while (reader.good() && !reader.done())
+			{
+				std::uint64_t code = reader.uleb();
+				if (!code || code > (1 << 20))
+					break;
+				if (table.Abbrevs.size() <= code)
+					table.Abbrevs.resize(code + 1);
+				DwarfAbbrev& abbrev = table.Abbrevs[code];
+				abbrev.Tag          = static_cast<std::uint32_t>(reader.uleb());
+				abbrev.Children     = reader.read<std::uint8_t>() != 0;
+				abbrev.First        = static_cast<std::uint32_t>(table.Attributes.size());
+				while (reader.good())
+				{
+					DwarfAttributeSpec spec {};
+					spec.Name = static_cast<std::uint32_t>(reader.uleb());
+					spec.Form = static_cast<std::uint32_t>(reader.uleb());
+					if (!spec.Name && !spec.Form)
+						break;
+					if (spec.Form == Dw::FormImplicitConst)
+						spec.ImplicitConst = reader.sleb();
+					table.Attributes.emplace_back(spec);
+				}
+				abbrev.Count = static_cast<std::uint32_t>(table.Attributes.size()) - abbrev.First;
+			}
+			return &table;
+		}
+
+		void readUnits()
+		{
+			DwarfReader reader(m_Info);
+			while (reader.good() && !reader.done())
+			{
+				DwarfUnit     unit;
+				unit.Offset         = reader.offset();
+				std::uint64_t length = reader.unitLength(unit.OffsetSize);
+				unit.End            = reader.offset() + length;
+				if (!reader.good() || unit.End > m_Info.Size || unit.End <= unit.Offset)
+					break;
+
+				unit.Version            = reader.read<std::uint16_t>();
+				std::uint8_t  unitType  = 1;
+				std::uint64_t abbrevOff = 0;
+				if (unit.Version >= 5)
+				{
+					unitType         = reader.read<std::uint8_t>();
+					unit.AddressSize = reader.read<std::uint8_t>();
+					abbrevOff        = reader.sized(unit.OffsetSize);
+				}
+				else
+				{
+					abbrevOff        = reader.sized(unit.OffsetSize);
+					unit.AddressSize = reader.read<std::uint8_t>();
+				}
+				unit.DieOffset = reader.offset();
+
+				// Only compile and partial units, type units and split DWARF skeletons are not indexed.
+				if (reader.good() && unit.Version >= 2 && unit.Version <= 5 && (unitType == 1 || unitType == 3))
+				{
+					unit.Abbrevs = abbrevs(abbrevOff);
+					DwarfReader dieReader(m_Info, unit.DieOffset);
+					dieReader.limit(unit.End);
+					DwarfDie root;
+					if (readDie(unit, dieReader, root))
+					{
+						if (root.StrOffsetsBase.Form)
+							unit.StrOffsetsBase = root.StrOffsetsBase.Value;
+						if (root.AddrBase.Form)
+							unit.AddrBase = root.AddrBase.Value;
+						if (root.RngListsBase.Form)
+							unit.RngListsBase = root.RngListsBase.Value;
+						if (root.StmtList.Form)
+							unit.LineOffset = root.StmtList.Value;
+						if (root.LowPc.Form)
+							unit.BaseAddress = address(unit, root.LowPc);
+						unit.CompDir = string(unit, root.CompDir);
+						m_Units.emplace_back(unit);
+					}
+				}
+
+				reader = DwarfReader(m_Info, unit.End);
+			}
+		}
+
+		bool readValue(const DwarfUnit& unit, DwarfReader& reader, std::uint32_t form, std::int64_t implicitConst, DwarfValue& value)
+		{
+			value.Form = form;
+			switch (form)
+			{
+			case Dw::FormAddr: value.Value = reader.sized(unit.AddressSize); break;
+			case Dw::FormBlock2:
+				value.Value = reader.read<std::uint16_t>();
+				reader.skip(value.Value);
+				break;
+			case Dw::FormBlock4:
+				value.Value = reader.read<std::uint32_t>();
+				reader.skip(value.Value);
+				break;
+			case Dw::FormBlock:
+			case Dw::FormExprLoc:
+				value.Value = reader.uleb();
+				reader.skip(value.Value);
+				break;
+			case Dw::FormBlock1:
+				value.Value = reader.read<std::uint8_t>();
+				reader.skip(value.Value);
+				break;
+			case Dw::FormData16: reader.skip(16); break;
+			case Dw::FormString: value.Data = reinterpret_cast<const std::uint8_t*>(reader.string()); break;
+			case Dw::FormData1:
+			case Dw::FormFlag:
+			case Dw::FormRef1:
+			case Dw::FormStrx1:
+			case Dw::FormAddrx1: value.Value = reader.read<std::uint8_t>(); break;
+			case Dw::FormData2:
+			case Dw::FormRef2:
+			case Dw::FormStrx2:
+			case Dw::FormAddrx2: value.Value = reader.read<std::uint16_t>(); break;
+			case Dw::FormStrx3:
+			case Dw::FormAddrx3: value.Value = reader.sized(3); break;
+			case Dw::FormData4:
+			case Dw::FormRef4:
+			case Dw::FormRefSup4:
+			case Dw::FormStrx4:
+			case Dw::FormAddrx4: value.Value = reader.read<std::uint32_t>(); break;
+			case Dw::FormData8:
+			case Dw::FormRef8:
+			case Dw::FormRefSig8:
+			case Dw::FormRefSup8: value.Value = reader.read<std::uint64_t>(); break;
+			case Dw::FormSData: value.Value = static_cast<std::uint64_t>(reader.sleb()); break;
+			case Dw::FormUData:
+			case Dw::FormRefUData:
+			case Dw::FormStrx:
+			case Dw::FormAddrx:
+			case Dw::FormLocListx:
+			case Dw::FormRngListx:
+			case Dw::FormGNUAddrIndex:
+			case Dw::FormGNUStrIndex: value.Value = reader.uleb(); break;
+			case Dw::FormStrp:
+			case Dw::FormSecOffset:
+			case Dw::FormStrpSup:
+			case Dw::FormLineStrp:
+			case Dw::FormGNURefAlt:
+			case Dw::FormGNUStrpAlt: value.Value = reader.sized(unit.OffsetSize); break;
+			case Dw::FormRefAddr: value.Value = reader.sized(unit.Version <= 2 ? unit.AddressSize : unit.OffsetSize); break;
+			case Dw::FormFlagPresent: value.Value = 1; break;
+			case Dw::FormImplicitConst: value.Value = static_cast<std::uint64_t>(implicitConst); break;
+			case Dw::FormIndirect: return readValue(unit, reader, static_cast<std::uint32_t>(reader.uleb()), implicitConst, value);
+			default: return false;
+			}
+			return reader.good();
+		}
+
+		// Returns false on malformed data, a null entry ending a list of children has a Tag of 0.
+		bool readDie(const DwarfUnit& unit, DwarfReader& reader, DwarfDie& die)
+		{
+			std::uint64_t code = reader.uleb();
+			if (!reader.good())
+				return false;
+			if (!code)
+				return true;
+			if (code >= unit.Abbrevs->Abbrevs.size() || !unit.Abbrevs->Abbrevs[code].Tag)
+				return false;
+
+			const DwarfAbbrev& abbrev = unit.Abbrevs->Abbrevs[code];
+			die.Tag                   = abbrev.Tag;
+			die.Children              = abbrev.Children;
+			for (std::uint32_t i = 0; i < abbrev.Count; ++i)
+			{
+				const DwarfAttributeSpec& spec = unit.Abbrevs->Attributes[abbrev.First + i];
+				DwarfValue                value;
+				if (!readValue(unit, reader, spec.Form, spec.ImplicitConst, value))
+					return false;
+				switch (spec.Name)
+				{
+				case Dw::AtName: die.Name = value; break;
+				case Dw::AtLinkageName:
+				case Dw::AtMIPSLinkageName: die.LinkageName = value; break;
+				case Dw::AtLowPc: die.LowPc = value; break;
+				case Dw::AtHighPc: die.HighPc = value; break;
+				case Dw::AtRanges: die.Ranges = value; break;
+				case Dw::AtAbstractOrigin: die.AbstractOrigin = value; break;
+				case Dw::AtSpecification: die.Specification = value; break;
+				case Dw::AtCallFile: die.CallFile = value; break;
+				case Dw::AtCallLine: die.CallLine = value; break;
+				case Dw::AtCallColumn: die.CallColumn = value; break;
+				case Dw::AtStmtList: die.StmtList = value; break;
+				case Dw::AtCompDir: die.CompDir = value; break;
+				case Dw::AtStrOffsetsBase: die.StrOffsetsBase = value; break;
+				case Dw::AtAddrBase: die.AddrBase = value; break;
+				case Dw::AtRngListsBase: die.RngListsBase = value; break;
+				default: break;
+				}
+			}
+			return true;
+		}
+
+		const char* sectionString(ElfSection section, std::uint64_t offset)
+		{
+			DwarfReader reader(section, offset);
+			return reader.good() ? reader.string() : nullptr;
+		}
+
+		const char* string(const DwarfUnit& unit, const DwarfValue& value)
+		{
+			switch (value.Form)
+			{
+			case Dw::FormString: return reinterpret_cast<const char*>(value.Data);
+			case Dw::FormStrp: return sectionString(m_Str, value.Value);
+			case Dw::FormLineStrp: return sectionString(m_LineStr, value.Value);
+			case Dw::FormStrx:
+			case Dw::FormStrx1:
+			case Dw::FormStrx2:
+			case Dw::FormStrx3:
+			case Dw::FormStrx4:
+			case Dw::FormGNUStrIndex:
+			{
+				DwarfReader   reader(m_StrOffsets, unit.StrOffsetsBase + value.Value * unit.OffsetSize);
+				std::uint64_t offset = reader.sized(unit.OffsetSize);
+				return reader.good() ? sectionString(m_Str, offset) : nullptr;
+			}
+			default: return nullptr;
+			}
+		}
+
+		std::uint64_t address(const DwarfUnit& unit, const DwarfValue& value)
+		{
+			switch (value.Form)
+			{
+			case Dw::FormAddr: return value.Value;
+			case Dw::FormAddrx:
+			case Dw::FormAddrx1:
+			case Dw::FormAddrx2:
+			case Dw::FormAddrx3:
+			case Dw::FormAddrx4:
+			case Dw::FormGNUAddrIndex: return indexedAddress(unit, value.Value);
+			default: return 0;
+			}
+		}
+
+		std::uint64_t indexedAddress(const DwarfUnit& unit, std::uint64_t index)
+		{
+			DwarfReader   reader(m_Addr, unit.AddrBase + index * unit.AddressSize);
+			std::uint64_t value = reader.sized(unit.AddressSize);
+			return reader.good() ? value : 0;
+		}
+
+		// Absolute .debug_info offset of a reference, ~0 for references into other files or type units.
+		static std::uint64_t reference(const DwarfUnit& unit, const DwarfValue& value)
+		{
+			switch (value.Form)
+			{
+			case Dw::FormRef1:
+			case Dw::FormRef2:
+			case Dw::FormRef4:
+			case Dw::FormRef8:
+			case Dw::FormRefUData: return unit.Offset + value.Value;
+			case Dw::FormRefAddr: return value.Value;
+			default: return ~0ULL;
+			}
+		}
+
+		void ranges(const DwarfUnit& unit, const DwarfDie& die, std::vector<std::pair<std::uint64_t, std::uint64_t>>& result)
+		{
+			result.clear();
+			if (die.LowPc.Form)
+			{
+				std::uint64_t low  = address(unit, die.LowPc);
+				std::uint64_t high = 0;
+				if (die.HighPc.Form == Dw::FormAddr || (die.HighPc.Form >= Dw::FormAddrx1 && die.HighPc.Form <= Dw::FormAddrx4) || die.HighPc.Form == Dw::FormAddrx)
+					high = address(unit, die.HighPc);
+				else if (die.HighPc.Form)
+					high = low + die.HighPc.Value;
+				if (high > low && !IsDiscardedAddress(low))
+					result.emplace_back(low, high);
+				return;
+			}
+			if (!die.Ranges.Form)
+				return;
+
+			if (unit.Version < 5)
+			{
+				DwarfReader   reader(m_Ranges, die.Ranges.Value);
+				std::uint64_t base    = unit.BaseAddress;
+				std::uint64_t maxAddr = unit.AddressSize == 4 ? 0xFFFF'FFFFULL : ~0ULL;
+				while (reader.good() && !reader.done())
+				{
+					std::uint64_t begin = reader.sized(unit.AddressSize);
+					std::uint64_t end   = reader.sized(unit.AddressSize);
+					if (!begin && !end)
+						break;
+					if (begin == maxAddr)
+						base = end;
+					else
+						addRange(result, base + begin, base + end);
+				}
+				return;
+			}
+
+			std::uint64_t offset = die.Ranges.Value;
+			if (die.Ranges.Form == Dw::FormRngListx)
+			{
+				DwarfReader table(m_RngLists, unit.RngListsBase + die.Ranges.Value * unit.OffsetSize);
+				offset = unit.RngListsBase + table.sized(unit.OffsetSize);
+				if (!table.good())
+					return;
+			}
+
+			DwarfReader   reader(m_RngLists, offset);
+			std::uint64_t base = unit.BaseAddress;
+			while (reader.good() && !reader.done())
+			{
+				std::uint8_t kind = reader.read<std::uint8_t>();
+				switch (kind)
+				{
+				case 0: return; // DW_RLE_end_of_list
+				case 1: base = indexedAddress(unit, reader.uleb()); break;
+				case 2:
+				{
+					std::uint64_t begin = indexedAddress(unit, reader.uleb());
+					addRange(result, begin, indexedAddress(unit, reader.uleb()));
+					break;
+				}
+				case 3:
+				{
+					std::uint64_t begin = indexedAddress(unit, reader.uleb());
+					addRange(result, begin, begin + reader.uleb());
+					break;
+				}
+				case 4:
+				{
+					std::uint64_t begin = reader.uleb();
+					addRange(result, base + begin, base + reader.uleb());
+					break;
+				}
+				case 5: base = reader.sized(unit.AddressSize); break;
+				case 6:
+				{
+					std::uint64_t begin = reader.sized(unit.AddressSize);
+					addRange(result, begin, reader.sized(unit.AddressSize));
+					break;
+				}
+				case 7:
+				{
+					std::uint64_t begin = reader.sized(unit.AddressSize);
+					addRange(result, begin, begin + reader.uleb());
+					break;
+				}
+				default: return;
+				}
+			}
+		}
+
+		static void addRange(std::vector<std::pair<std::uint64_t, std::uint64_t>>& result, std::uint64_t low, std::uint64_t high)
+		{
+			if (high > low && !IsDiscardedAddress(low))
+				result.emplace_back(low, high);
+		}
+
+		// Prefers the demangled linkage name anywhere along the origin and specification chain over a plain name.
+		std::uint32_t functionName(const DwarfUnit& unit, const DwarfDie& die, std::uint32_t depth)
+		{
+			if (const char* linkageName = string(unit, die.LinkageName))
+			{
+				int   status    = 0;
+				char* demangled = linkageName[0] == '_' && linkageName[1] == 'Z' ? abi::__cxa_demangle(linkageName, nullptr, nullptr, &status) : nullptr;
+				std::uint32_t id = intern(demangled && status == 0 ? demangled : linkageName);
+				std::free(demangled);
+				return id;
+			}
+			if (depth < 8)
+			{
+				for (const DwarfValue* link : { &die.AbstractOrigin, &die.Specification })
+				{
+					if (!link->Form)
+						continue;
+					std::uint32_t name = functionName(reference(unit, *link), depth + 1);
+					if (name != c_DwarfNone)
+						return name;
+				}
+			}
+			const char* name = string(unit, die.Name);
+			return name ? intern(name) : c_DwarfNone;
+		}
+
+		std::uint32_t functionName(std::uint64_t offset, std::uint32_t depth)
+		{
+			auto itr = m_FunctionNames.find(offset);
+			if (itr != m_FunctionNames.end())
+				return itr->second;
+
+			std::uint32_t name = c_DwarfNone;
+			auto          unit = std::upper_bound(m_Units.begin(), m_Units.end(), offset, [](std::uint64_t value, const DwarfUnit& entry) { return value < entry.Offset; });
+			if (unit != m_Units.begin() && offset < (unit - 1)->End)
+			{
+				DwarfReader reader(m_Info, offset);
+				reader.limit((unit - 1)->End);
+				DwarfDie die;
+				if (readDie(*(unit - 1), reader, die) && die.Tag)
+					name = functionName(*(unit - 1), die, depth);
+			}
+			m_FunctionNames.emplace(offset, name);
+			return name;
+		}
+
+		// Decodes a line program once, returns the string IDs of its file table.
+		const std::vector<std::uint32_t>& decodeLines(const DwarfUnit& unit)
+		{
+			auto itr = m_LinePrograms.find(unit.LineOffset);
+			if (itr != m_LinePrograms.end())
+				return itr->second;
+			std::vector<std::uint32_t>& files = m_LinePrograms[unit.LineOffset];
+
+			DwarfReader   reader(m_Line, unit.LineOffset);
+			std::uint8_t  offsetSize = 4;
+			std::uint64_t length     = reader.unitLength(offsetSize);
+			std::uint64_t end        = reader.offset() + length;
+			reader.limit(end);
+			std::uint16_t version     = reader.read<std::uint16_t>();
+			std::uint8_t  addressSize = unit.AddressSize;
+			if (version >= 5)
+			{
+				addressSize = reader.read<std::uint8_t>();
+				reader.read<std::uint8_t>(); // segment_selector_size
+			}
+			std::uint64_t headerLength = reader.sized(offsetSize);
+			std::uint64_t program      = reader.offset() + headerLength;
+			std::uint8_t  minLength    = reader.read<std::uint8_t>();
+			if (version >= 4)
+				reader.read<std::uint8_t>(); // maximum_operations_per_instruction, VLIW is not supported
+			reader.read<std::uint8_t>(); // default_is_stmt, every row is kept
+			std::int8_t  lineBase   = reader.read<std::int8_t>();
+			std::uint8_t lineRange  = reader.read<std::uint8_t>();
+			std::uint8_t opcodeBase = reader.read<std::uint8_t>();
+			std::uint8_t opcodeLengths[256] {};
+			for (std::uint32_t i = 1; i < opcodeBase; ++i)
+				opcodeLengths[i] = reader.read<std::uint8_t>();
+			if (!reader.good() || version < 2 || version > 5 || !lineRange || end > m_Line.Size)
+				return files;
+
+			std::string_view compDir = unit.CompDir ? unit.CompDir : "";
+			if (version >= 5)
+			{
+				std::vector<std::string> directories;
+				auto                     readEntries = [&](auto&& onEntry) {
+					std::uint8_t                                         formatCount = reader.read<std::uint8_t>();
+					std::vector<std::pair<std::uint32_t, std::uint32_t>> formats;
+					for (std::uint8_t i = 0; i < formatCount; ++i)
+					{
+						std::uint32_t type = static_cast<std::uint32_t>(reader.uleb());
+						formats.emplace_back(type, static_cast<std::uint32_t>(reader.uleb()));
+					}
+					std::uint64_t count = reader.uleb();
+					for (std::uint64_t i = 0; i < count && reader.good(); ++i)
+					{
+						const char*   path      = nullptr;
+						std::uint64_t directory = 0;
+						for (auto& [type, form] : formats)
+						{
+							DwarfValue value;
+							if (!readValue(unit, reader, form, 0, value))
+								return;
+							if (type == Dw::LnctPath)
+								path = string(unit, value);
+							else if (type == Dw::LnctDirectoryIndex)
+								directory = value.Value;
+						}
+						onEntry(path ? path : "", directory);
+					}
+				};
+				readEntries([&](std::string_view path, std::uint64_t) { directories.emplace_back(JoinPath(compDir, path)); });
+				readEntries([&](std::string_view path, std::uint64_t directory) {
+					files.emplace_back(intern(JoinPath(directory < directories.size() ? std::string_view { directories[directory] } : compDir, path)));
+				});
+			}
+			else
+			{
+				std::vector<std::string> directories { std::string { compDir } };
+				while (reader.good())
+				{
+					const char* directory = reader.string();
+					if (!directory || !*directory)
+						break;
+					directories.emplace_back(JoinPath(compDir, directory));
+				}
+				files.emplace_back(c_DwarfNone);
+				while (reader.good())
+				{
+					const char* path = reader.string();
+					if (!path || !*path)
+						break;
+					std::uint64_t directory = reader.uleb();
+					reader.uleb(); // Modification time
+					reader.uleb(); // Size
+					files.emplace_back(intern(JoinPath(directory < directories.size() ? std::string_view { directories[directory] } : compDir, path)));
+				}
+			}
+
+			reader = DwarfReader(m_Line, program);
+			reader.limit(end);
+			runLineProgram(reader, files, addressSize, minLength, lineBase, lineRange, opcodeBase, opcodeLengths);
+			return files;
+		}
+
+		void runLineProgram(DwarfReader& reader, const std::vector<std::uint32_t>& files, std::uint8_t addressSize, std::uint8_t minLength, std::int8_t lineBase, std::uint8_t lineRange, std::uint8_t opcodeBase, const std::uint8_t* opcodeLengths)
+		{
+			std::uint64_t address = 0;
+			std::uint64_t file    = 1;
+			std::int64_t  line    = 1;
+			std::uint64_t column  = 0;
+			std::size_t   first   = m_Index.m_Lines.size();
+
+			auto fileID = [&files](std::uint64_t index) { return index < files.size() ? files[index] : c_DwarfNone; };
+			auto emit   = [&](bool endSequence) {
+				m_Index.m_Lines.emplace_back(DwarfIndex::LineRow { address, endSequence ? c_DwarfNone : fileID(file), endSequence ? 0 : static_cast<std::uint32_t>(std::max<std::int64_t>(line, 1)), static_cast<std::uint32_t>(column) });
+			};
+			auto reset = [&]() {
+				address = 0;
+				file    = 1;
+				line    = 1;
+				column  = 0;
+				first   = m_Index.m_Lines.size();
+			};
+
+			while (reader.good() && !reader.done())
+			{
+				std::uint8_t opcode = reader.read<std::uint8_t>();
+				if (opcode >= opcodeBase)
+				{
+					std::uint8_t adjusted  = opcode - opcodeBase;
+					address               += static_cast<std::uint64_t>(adjusted / lineRange) * minLength;
+					line                  += lineBase + adjusted % lineRange;
+					emit(false);
+					continue;
+				}
+
+				switch (opcode)
+				{
+				case 0:
+				{
+					std::uint64_t length = reader.uleb();
+					std::uint64_t next   = reader.offset() + length;
+					if (!length)
+						break;
+					std::uint8_t extended = reader.read<std::uint8_t>();
+					if (extended == 1) // DW_LNE_end_sequence
+					{
+						emit(true);
+						if (IsDiscardedAddress(m_Index.m_Lines[first].Address))
+							m_Index.m_Lines.resize(first);
+						reset();
+					}
+					else if (extended == 2) // DW_LNE_set_address
+					{
+						address = reader.sized(static_cast<std::uint8_t>(std::min<std::uint64_t>(length - 1, addressSize)));
+					}
+					reader = skipTo(reader, next);
+					break;
+				}
+				case 1: emit(false); break;                                                     // DW_LNS_copy
+				case 2: address += reader.uleb() * minLength; break;                            // DW_LNS_advance_pc
+				case 3: line += reader.sleb(); break;                                           // DW_LNS_advance_line
+				case 4: file = reader.uleb(); break;                                            // DW_LNS_set_file
+				case 5: column = reader.uleb(); break;                                          // DW_LNS_set_column
+				case 8: address += static_cast<std::uint64_t>((255 - opcodeBase) / lineRange) * minLength; break; // DW_LNS_const_add_pc
+				case 9: address += reader.read<std::uint16_t>(); break;                         // DW_LNS_fixed_advance_pc
+				default:
+					for (std::uint8_t i = 0; i < opcodeLengths[opcode]; ++i)
+						reader.uleb();
+					break;
+				}
+			}
+			// A sequence the program did not end is dropped.
+			m_Index.m_Lines.resize(first);
+		}
+
+		static DwarfReader skipTo(DwarfReader reader, std::uint64_t offset)
+		{
+			if (offset > reader.offset())
+				reader.skip(offset - reader.offset());
+			return reader;
+		}
+
+		void readScopes(const DwarfUnit& unit)
+		{
+			struct Level
+			{
+			public:
+				std::uint32_t Scope;
+				std::uint32_t Depth;
+			};
+
+			std::vector<Level>                                   levels;
+			std::vector<std::pair<std::uint64_t, std::uint64_t>> scratch;
+			DwarfReader                                          reader(m_Info, unit.DieOffset);
+			reader.limit(unit.End);
+			while (reader.good() && !reader.done())
+			{
+				DwarfDie die;
+				if (!readDie(unit, reader, die))
+					break;
+				if (!die.Tag)
+				{
+					if (levels.empty())
+						break;
+					levels.pop_back();
+					continue;
+				}
+
+				Level parent = levels.empty() ? Level { c_DwarfNone, 0 } : levels.back();
+				Level self   = parent;
+				if (die.Tag == Dw::TagSubprogram || (die.Tag == Dw::TagInlinedSubroutine && parent.Scope != c_DwarfNone))
+				{
+					ranges(unit, die, scratch);
+					if (!scratch.empty())
+					{
+						bool          inlined = die.Tag == Dw::TagInlinedSubroutine;
+						std::uint32_t id      = static_cast<std::uint32_t>(m_Index.m_Scopes.size());
+						DwarfIndex::Scope scope {};
+						scope.Function   = functionName(unit, die, 0);
+						scope.CallFile   = inlined && die.CallFile.Form && unit.Files && die.CallFile.Value < unit.Files->size() ? (*unit.Files)[die.CallFile.Value] : c_DwarfNone;
+						scope.CallLine   = inlined ? static_cast<std::uint32_t>(die.CallLine.Value) : 0;
+						scope.CallColumn = inlined ? static_cast<std::uint32_t>(die.CallColumn.Value) : 0;
+						scope.Parent     = inlined ? parent.Scope : c_DwarfNone;
+						m_Index.m_Scopes.emplace_back(scope);
+
+						self = Level { id, inlined ? parent.Depth + 1 : 0 };
+						for (auto& [low, high] : scratch)
+							m_ScopeEntries.emplace_back(ScopeEntry { low, high, self.Depth, id });
+					}
+				}
+				if (die.Children)
+					levels.emplace_back(self);
+			}
+		}
+
+		// Keeps the last row per address, end of sequence markers sort before rows starting at the same address.
+		void finishLines()
+		{
+			auto& lines = m_Index.m_Lines;
+			std::stable_sort(lines.begin(), lines.end(), [](const DwarfIndex::LineRow& lhs, const DwarfIndex::LineRow& rhs) { return lhs.Address < rhs.Address || (lhs.Address == rhs.Address && !lhs.Line && rhs.Line); });
+
+			std::size_t count = 0;
+			for (std::size_t i = 0; i < lines.size(); ++i)
+			{
+				if (i + 1 < lines.size() && lines[i + 1].Address == lines[i].Address)
+					continue;
+				if (count && lines[count - 1].File == lines[i].File && lines[count - 1].Line == lines[i].Line && lines[count - 1].Column == lines[i].Column)
+					continue;
+				lines[count++] = lines[i];
+			}
+			lines.resize(count);
+		}
+
+		// Paints the properly nested scope ranges onto one sorted list of segments holding the innermost scope.
+		void finishRanges()
+		{
+			std::sort(m_ScopeEntries.begin(), m_ScopeEntries.end(), [](const ScopeEntry& lhs, const ScopeEntry& rhs) { return lhs.Low < rhs.Low || (lhs.Low == rhs.Low && (lhs.Depth < rhs.Depth || (lhs.Depth == rhs.Depth && lhs.High > rhs.High))); });
+
+			auto& ranges = m_Index.m_Ranges;
+			auto  emit   = [&ranges](std::uint64_t start, std::uint32_t scope) {
+				if (!ranges.empty() && ranges.back().Start == start)
+					ranges.back().Scope = scope;
+				else if (ranges.empty() || ranges.back().Scope != scope)
+					ranges.emplace_back(DwarfIndex::ScopeRange { start, scope });
+			};
+
+			std::vector<ScopeEntry> open;
+			for (ScopeEntry entry : m_ScopeEntries)
+			{
+				while (!open.empty() && open.back().High <= entry.Low)
+				{
+					std::uint64_t end = open.back().High;
+					open.pop_back();
+					emit(end, open.empty() ? c_DwarfNone : open.back().Scope);
+				}
+				// Overlapping siblings are clipped to their enclosing range.
+				if (!open.empty())
+					entry.High = std::min(entry.High, open.back().High);
+				if (entry.Low >= entry.High)
+					continue;
+				open.emplace_back(entry);
+				emit(entry.Low, entry.Scope);
+			}
+			while (!open.empty())
+			{
+				std::uint64_t end = open.back().High;
+				open.pop_back();
+				emit(end, open.empty() ? c_DwarfNone : open.back().Scope);
+			}
+			ranges.shrink_to_fit();
+		}
+
+	private:
+		DwarfIndex& m_Index;
+
+		ElfSection m_Info;
+		ElfSection m_Abbrev;
+		ElfSection m_Line;
+		ElfSection m_Str;
+		ElfSection m_LineStr;
+		ElfSection m_StrOffsets;
+		ElfSection m_Addr;
+		ElfSection m_Ranges;
+		ElfSection m_RngLists;
+
+		std::vector<DwarfUnit>                                         m_Units;
+		std::unordered_map<std::uint64_t, DwarfAbbrevTable>            m_AbbrevTables;
+		std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> m_LinePrograms;
+		std::unordered_map<std::uint64_t, std::uint32_t>               m_FunctionNames;
+		std::unordered_map<std::string, std::uint32_t>                 m_StringIDs;
+		std::vector<ScopeEntry>                                        m_ScopeEntries;
+	};
+
+	bool DwarfIndex::build(const ElfFile& elf)
+	{
+		m_Lines.clear();
+		m_Scopes.clear();
+		m_Ranges.clear();
+		m_Strings.clear();
+		DwarfBuilder builder(elf, *this);
+		return builder.build();
+	}
+
+	void DwarfIndex::lookup(std::uint64_t address, std::vector<DwarfFrame>& frames) const
+	{
+		auto row = std::upper_bound(m_Lines.begin(), m_Lines.end(), address, [](std::uint64_t value, const LineRow& entry) { return value < entry.Address; });
+		if (row == m_Lines.begin() || !(row - 1)->Line)
+			return;
+		--row;
+
+		auto          range = std::upper_bound(m_Ranges.begin(), m_Ranges.end(), address, [](std::uint64_t value, const ScopeRange& entry) { return value < entry.Start; });
+		std::uint32_t scope = range == m_Ranges.begin() ? c_DwarfNone : (range - 1)->Scope;
+
+		DwarfFrame frame { c_DwarfNone, row->File, row->Line, row->Column };
+		if (scope == c_DwarfNone)
+		{
+			frames.emplace_back(frame);
+			return;
+		}
+		for (std::uint32_t i = 0; scope != c_DwarfNone && i < m_Scopes.size(); ++i)
+		{
+			const Scope& entry = m_Scopes[scope];
+			frame.Function     = entry.Function;
+			frames.emplace_back(frame);
+			frame = DwarfFrame { c_DwarfNone, entry.CallFile, entry.CallLine, entry.CallColumn };
+			scope = entry.Parent;
+		}
+	}
+} // namespace Profiler
+#endif
@@ -0,0 +1,130 @@
+#include "Profiler/Elf.h"
+
+#if BUILD_IS_SYSTEM_LINUX
+	#include <cstdio>
+	#include <cstring>
+
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+
+namespace Profiler
+{
+	ElfFile::ElfFile(const std::string& path)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return;
+		struct stat st {};
+		if (fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(Elf64_Ehdr))
+		{
+			void* data = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data != MAP_FAILED)
+			{
+				m_Data = static_cast<const std::uint8_t*>(data);
+				m_Size = static_cast<std::size_t>(st.st_size);
+			}
+		}
+		::close(fd);
+
+		const Elf64_Ehdr* header = at<Elf64_Ehdr>(0);
+		if (!header || std::memcmp(header->e_ident, ELFMAG, SELFMAG) != 0 || header->e_ident[EI_CLASS] != ELFCLASS64)
+			return;
+		m_Header = header;
+	}
+
+	ElfFile::~ElfFile()
+	{
+		if (m_Data)
+			munmap(const_cast<std::uint8_t*>(m_Data), m_Size);
+	}
+
+	std::string ReadBuildIDNote(const std::uint8_t* notes, std::size_t size)
+	{
+		std::size_t offset = 0;
+		while (size - offset >= sizeof(Elf64_Nhdr))
+		{
+			Elf64_Nhdr note;
+			std::memcpy(&note, notes + offset, sizeof(note));
+			std::size_t name = offset + sizeof(Elf64_Nhdr);
+			std::size_t desc = name + ((note.n_namesz + 3ULL) & ~3ULL);
+			offset           = desc + ((note.n_descsz + 3ULL) & ~3ULL);
+			if (desc + note.n_descsz > size || offset > size)
+				break;
+			if (note.n_type != NT_GNU_BUILD_ID || note.n_namesz != 4 || std::memcmp(notes + name, "GNU", 4) != 0)
+				continue;
+
+			std::string id;
+			for (std::uint32_t i = 0; i < note.n_descsz; ++i)
+			{
+				char hex[3];
+				std::snprintf(hex, sizeof(hex), "%02x", notes[desc + i]);
+				id += hex;
+			}
+			return id;
+		}
+		return {};
+	}
+
+	std::string ElfFile::buildID() const
+	{
+		const Elf64_Phdr* headers = programHeaders();
+		for (std::size_t i = 0; i < programHeaderCount(); ++i)
+		{
+			if (headers[i].p_type != PT_NOTE)
+				continue;
+			const std::uint8_t* notes = at<std::uint8_t>(headers[i].p_offset, headers[i].p_filesz);
+			std::string         id    = notes ? ReadBuildIDNote(notes, headers[i].p_filesz) : std::string {};
+			if (!id.empty())
+				return id;
+		}
+		// Separate debug files keep the note as a section without a program header.
+		ElfSection notes = section(".note.gnu.build-id");
+		return notes.Data ? ReadBuildIDNote(notes.Data, notes.Size) : std::string {};
+	}
+
+	bool ElfFile::hasSection(std::uint32_t type) const
+	{
+		const Elf64_Shdr* sections = sectionHeaders();
+		for (std::size_t i = 0; i < sectionHeaderCount(); ++i)
+		{
+			if (sections[i].sh_type == type)
+				return true;
+		}
+		return false;
+	}
+
+	ElfSection ElfFile::section(std::string_view name) const
+	{
+		const Elf64_Shdr* sections = sectionHeaders();
+		std::size_t       count    = sectionHeaderCount();
+		if (m_Header->e_shstrndx >= count)
+			return {};
+		const Elf64_Shdr& names     = sections[m_Header->e_shstrndx];
+		const char*       nameTable = at<char>(names.sh_offset, names.sh_size);
+		if (!nameTable)
+			return {};
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const Elf64_Shdr& section = sections[i];
+			if (section.sh_name >= names.sh_size || section.sh_type == SHT_NOBITS || (section.sh_flags & SHF_COMPRESSED))
+				continue;
+			const char* sectionName = nameTable + section.sh_name;
+			if (std::string_view { sectionName, strnlen(sectionName, names.sh_size - section.sh_name) } != name)
+				continue;
+			const std::uint8_t* data = at<std::uint8_t>(section.sh_offset, section.sh_size);
+			return data ? ElfSection { data, section.sh_size } : ElfSection {};
+		}
+		return {};
+	}
+
+	std::string ElfDebugFilePath(const std::string& buildID)
+	{
+		if (buildID.size() <= 2)
+			return {};
+		return "/usr/lib/debug/.build-id/" + buildID.substr(0, 2) + "/" + buildID.substr(2) + ".debug";
+	}
+} // namespace Profiler
+#endif
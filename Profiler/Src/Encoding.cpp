@@ -0,0 +1,493 @@
+#include "Profiler/Encoding.h"
+#include "Profiler/Utils/Varint.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <bit>
+
+namespace Profiler
+{
+	static std::uint8_t SizeCode(std::uint8_t size)
+	{
+		return static_cast<std::uint8_t>(std::countr_zero(size) & 0x7);
+	}
+
+	static std::uint8_t CodeSize(std::uint8_t code)
+	{
+		return static_cast<std::uint8_t>(1U << code);
+	}
+
+	static std::uint64_t MaskValue(std::uint64_t value, std::uint8_t size)
+	{
+		return size < 8 ? value & ((1ULL << (size * 8)) - 1) : value;
+	}
+
+	static void WriteWords(std::uint8_t*& out, const std::uint64_t* values, std::uint8_t size)
+	{
+		if (size < 8)
+		{
+			Utils::WriteVarint(out, MaskValue(values[0], size));
+			return;
+		}
+		for (std::uint8_t i = 0; i < size / 8; ++i)
+			Utils::WriteVarint(out, values[i]);
+	}
+
+	static bool ReadWords(const std::uint8_t*& in, const std::uint8_t* end, std::uint64_t* values, std::uint8_t size)
+	{
+		std::uint8_t words = std::max<std::uint8_t>(size / 8, 1);
+		for (std::uint8_t i = 0; i < words; ++i)
+		{
+			if (!Utils::ReadVarint(in, end, values[i]))
+				return false;
+		}
+		return true;
+	}
+
+	void EventEncoder::beginBlock()
+	{
+		m_LastTimestamps[0] = 0;
+		m_LastTimestamps[1] = 0;
+		m_FunctionCount     = 0;
+		++m_Generation;
+	}
+
+	void EventEncoder::reset()
+	{
+		beginBlock();
+		m_DataRemaining = 0;
+	}
+
+	void EventEncoder::writeTimestamp(std::uint8_t*& out, EventTimestamp timestamp)
+	{
+		std::uint64_t& last  = m_LastTimestamps[timestamp.Type];
+		std::int64_t   delta = static_cast<std::int64_t>(timestamp.Time - last);
+		last                 = timestamp.Time;
+		Utils::WriteVarint(out, (Utils::ZigZagEncode(delta) << 1) | timestamp.Type);
+	}
+
+	bool EventEncoder::findFunction(void* functionPtr, std::uint64_t& index)
+	{
+		std::size_t hash = (reinterpret_cast<std::uintptr_t>(functionPtr) * 0x9E37'79B9'7F4A'7C15ULL) >> 54;
+		for (std::size_t i = 0; i < c_MaxProbes; ++i)
+		{
+			DictionaryEntry& entry = m_Dictionary[(hash + i) & (c_DictionarySize - 1)];
+			if (entry.Generation != m_Generation)
+			{
+				entry.FunctionPtr = functionPtr;
+				entry.Index       = m_FunctionCount;
+				entry.Generation  = m_Generation;
+				break;
+			}
+			if (entry.FunctionPtr == functionPtr)
+			{
+				index = entry.Index;
+				return true;
+			}
+		}
+		// Not in the dictionary, the pointer gets the next index even if the table had no room for it.
+		index = m_FunctionCount++;
+		return false;
+	}
+
+	std::size_t EventEncoder::encode(const Event& event, std::uint8_t* out)
+	{
+		std::uint8_t* begin = out;
+		if (m_DataRemaining)
+		{
+			std::uint8_t size  = static_cast<std::uint8_t>(std::min<std::uint64_t>(m_DataRemaining, sizeof(DataSectionEvent)));
+			*out++             = static_cast<std::uint8_t>(EEventType::DataSection);
+			*out++             = size;
+			std::memcpy(out, &event, size);
+			out             += size;
+			m_DataRemaining -= size;
+			return out - begin;
+		}
+
+		std::uint8_t* tag = out++;
+		*tag              = static_cast<std::uint8_t>(event.Type);
+		switch (event.Type)
+		{
+		case EEventType::ThreadBegin:
+		{
+			auto& data = reinterpret_cast<const ThreadBeginEvent&>(event);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::ThreadEnd:
+		{
+			auto& data = reinterpret_cast<const ThreadEndEvent&>(event);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::Frame:
+		{
+			auto& data = reinterpret_cast<const FrameEvent&>(event);
+			Utils::WriteVarint(out, data.FrameNum);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::FunctionBegin:
+		{
+			auto&         data = reinterpret_cast<const FunctionBeginEvent&>(event);
+			std::uint64_t index;
+			if (findFunction(data.FunctionPtr, index))
+			{
+				Utils::WriteVarint(out, index);
+			}
+			else
+			{
+				*tag |= 1 << 5;
+				Utils::WriteVarint(out, reinterpret_cast<std::uintptr_t>(data.FunctionPtr));
+			}
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::FunctionEnd:
+		{
+			auto& data = reinterpret_cast<const FunctionEndEvent&>(event);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::Callstack:
+		{
+			auto& data = reinterpret_cast<const CallstackEvent&>(event);
+			Utils::WriteVarint(out, data.DataID);
+			Utils::WriteVarint(out, data.NumEntries);
+			break;
+		}
+		case EEventType::BoolArgument:
+		{
+			auto& data  = reinterpret_cast<const BoolArgumentEvent&>(event);
+			*tag       |= (data.Value ? 1 : 0) << 5;
+			*out++      = data.Offset;
+			break;
+		}
+		case EEventType::IntArgument:
+		{
+			auto& data  = reinterpret_cast<const IntArgumentEvent&>(event);
+			*tag       |= SizeCode(data.Size) << 5;
+			*out++      = data.Offset;
+			*out++      = data.Base;
+			WriteWords(out, data.Data, data.Size);
+			break;
+		}
+		case EEventType::FloatArgument:
+		{
+			auto& data  = reinterpret_cast<const FloatArgumentEvent&>(event);
+			*tag       |= SizeCode(data.Size) << 5;
+			*out++      = data.Offset;
+			std::memcpy(out, data.Data, data.Size);
+			out += data.Size;
+			break;
+		}
+		case EEventType::FlagsArgument:
+		{
+			auto& data = reinterpret_cast<const FlagsArgumentEvent&>(event);
+			*out++     = data.Offset;
+			Utils::WriteVarint(out, data.FlagsType);
+			Utils::WriteVarint(out, data.Data[0]);
+			Utils::WriteVarint(out, data.Data[1]);
+			break;
+		}
+		case EEventType::PtrArgument:
+		{
+			auto& data = reinterpret_cast<const PtrArgumentEvent&>(event);
+			*out++     = data.Offset;
+			Utils::WriteVarint(out, reinterpret_cast<std::uintptr_t>(data.Ptr));
+			break;
+		}
+		case EEventType::ForLoopBegin:
+		{
+			auto& data = reinterpret_cast<const ForLoopBeginEvent&>(event);
+			Utils::WriteVarint(out, data.ID);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::ForLoopEnd:
+		{
+			auto& data = reinterpret_cast<const ForLoopEndEvent&>(event);
+			Utils::WriteVarint(out, data.ID);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::ForLoopIterBegin:
+		{
+			auto& data  = reinterpret_cast<const ForLoopIterBeginEvent&>(event);
+			*tag       |= SizeCode(data.Size) << 5;
+			Utils::WriteVarint(out, data.ID);
+			writeTimestamp(out, data.Timestamp);
+			WriteWords(out, data.Index, data.Size);
+			break;
+		}
+		case EEventType::ForLoopIterEnd:
+		{
+			auto& data = reinterpret_cast<const ForLoopIterEndEvent&>(event);
+			Utils::WriteVarint(out, data.ID);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::MemAlloc:
+		{
+			auto& data = reinterpret_cast<const MemAllocEvent&>(event);
+			Utils::WriteVarint(out, reinterpret_cast<std::uintptr_t>(data.Memory));
+			Utils::WriteVarint(out, data.Size);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::MemFree:
+		{
+			auto& data = reinterpret_cast<const MemFreeEvent&>(event);
+			Utils::WriteVarint(out, reinterpret_cast<std::uintptr_t>(data.Memory));
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::DataHeader:
+		{
+			auto& data = reinterpret_cast<const DataHeaderEvent&>(event);
+			Utils::WriteVarint(out, data.Size);
+			Utils::WriteVarint(out, data.ID);
+			m_DataRemaining = data.Size;
+			break;
+		}
+		case EEventType::ZoneBegin:
+		{
+			auto& data = reinterpret_cast<const ZoneBeginEvent&>(event);
+			Utils::WriteVarint(out, data.DescriptorID);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::Sample:
+		{
+			auto& data = reinterpret_cast<const SampleEvent&>(event);
+			Utils::WriteVarint(out, data.DataID);
+			Utils::WriteVarint(out, data.NumEntries);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		case EEventType::ZoneSample:
+		{
+			auto& data = reinterpret_cast<const ZoneSampleEvent&>(event);
+			*out++     = data.NumEntries;
+			Utils::WriteVarint(out, data.ThreadID);
+			Utils::WriteVarint(out, data.DataID);
+			writeTimestamp(out, data.Timestamp);
+			break;
+		}
+		default:
+			return 0;
+		}
+		return out - begin;
+	}
+
+	void EventDecoder::reset(const std::uint8_t* data, std::size_t size)
+	{
+		m_Cur               = data;
+		m_End               = data + size;
+		m_LastTimestamps[0] = 0;
+		m_LastTimestamps[1] = 0;
+		m_Functions.clear();
+	}
+
+	bool EventDecoder::readTimestamp(EventTimestamp& timestamp)
+	{
+		std::uint64_t value;
+		if (!Utils::ReadVarint(m_Cur, m_End, value))
+			return false;
+		std::uint64_t& last = m_LastTimestamps[value & 1];
+		last               += Utils::ZigZagDecode(value >> 1);
+		timestamp.Time      = last;
+		timestamp.Type      = value & 1;
+		return true;
+	}
+
+	bool EventDecoder::next(Event& event, EEventType& type)
+	{
+		if (m_Cur == m_End)
+			return false;
+
+		std::uint8_t tag     = *m_Cur++;
+		std::uint8_t payload = tag >> 5;
+		type                 = static_cast<EEventType>(tag & 0x1F);
+		event                = Event { type };
+		switch (type)
+		{
+		case EEventType::ThreadBegin:
+		{
+			auto& data = reinterpret_cast<ThreadBeginEvent&>(event);
+			return readTimestamp(data.Timestamp);
+		}
+		case EEventType::ThreadEnd:
+		{
+			auto& data = reinterpret_cast<ThreadEndEvent&>(event);
+			return readTimestamp(data.Timestamp);
+		}
+		case EEventType::Frame:
+		{
+			auto& data = reinterpret_cast<FrameEvent&>(event);
+			return Utils::ReadVarint(m_Cur, m_End, data.FrameNum) && readTimestamp(data.Timestamp);
+		}
+		case EEventType::FunctionBegin:
+		{
+			auto&         data = reinterpret_cast<FunctionBeginEvent&>(event);
+			std::uint64_t value;
+			if (!Utils::ReadVarint(m_Cur, m_End, value))
+				return false;
+			if (payload & 1)
+			{
+				data.FunctionPtr = reinterpret_cast<void*>(value);
+				m_Functions.emplace_back(data.FunctionPtr);
+			}
+			else
+			{
+				if (value >= m_Functions.size())
+					return false;
+				data.FunctionPtr = m_Functions[value];
+			}
+			return readTimestamp(data.Timestamp);
+		}
+		case EEventType::FunctionEnd:
+		{
+			auto& data = reinterpret_cast<FunctionEndEvent&>(event);
+			return readTimestamp(data.Timestamp);
+		}
+		case EEventType::Callstack:
+		{
+			auto& data = reinterpret_cast<CallstackEvent&>(event);
+			return Utils::ReadVarint(m_Cur, m_End, data.DataID) && Utils::ReadVarint(m_Cur, m_End, data.NumEntries);
+		}
+		case EEventType::BoolArgument:
+		{
+			auto& data = reinterpret_cast<BoolArgumentEvent&>(event);
+			if (m_Cur == m_End)
+				return false;
+			data.Offset = *m_Cur++;
+			data.Value  = payload & 1;
+			return true;
+		}
+		case EEventType::IntArgument:
+		{
+			auto& data = reinterpret_cast<IntArgumentEvent&>(event);
+			if (m_End - m_Cur < 2)
+				return false;
+			data.Offset = *m_Cur++;
+			data.Base   = *m_Cur++;
+			data.Size   = CodeSize(payload);
+			return ReadWords(m_Cur, m_End, data.Data, data.Size);
+		}
+		case EEventType::FloatArgument:
+		{
+			auto& data = reinterpret_cast<FloatArgumentEvent&>(event);
+			data.Size  = CodeSize(payload);
+			if (m_End - m_Cur < 1 + data.Size || data.Size > sizeof(data.Data))
+				return false;
+			data.Offset = *m_Cur++;
+			std::memcpy(data.Data, m_Cur, data.Size);
+			m_Cur += data.Size;
+			return true;
+		}
+		case EEventType::FlagsArgument:
+		{
+			auto& data = reinterpret_cast<FlagsArgumentEvent&>(event);
+			if (m_Cur == m_End)
+				return false;
+			data.Offset = *m_Cur++;
+			return Utils::ReadVarint(m_Cur, m_End, data.FlagsType) && Utils::ReadVarint(m_Cur, m_End, data.Data[0]) && Utils::ReadVarint(m_Cur, m_End, data.Data[1]);
+		}
+		case EEventType::PtrArgument:
+		{
+			auto&         data = reinterpret_cast<PtrArgumentEvent&>(event);
+			std::uint64_t value;
+			if (m_Cur == m_End)
+				return false;
+			data.Offset = *m_Cur++;
+			if (!Utils::ReadVarint(m_Cur, m_End, value))
+				return false;
+			data.Ptr = reinterpret_cast<void*>(value);
+			return true;
+		}
+		case EEventType::ForLoopBegin:
+		{
+			auto& data = reinterpret_cast<ForLoopBeginEvent&>(event);
+			return Utils::ReadVarint(m_Cur, m_End, data.ID) && readTimestamp(data.Timestamp);
+		}
+		case EEventType::ForLoopEnd:
+		{
+			auto& data = reinterpret_cast<ForLoopEndEvent&>(event);
+			return Utils::ReadVarint(m_Cur, m_End, data.ID) && readTimestamp(data.Timestamp);
+		}
+		case EEventType::ForLoopIterBegin:
+		{
+			auto& data = reinterpret_cast<ForLoopIterBeginEvent&>(event);
+			data.Size  = CodeSize(payload);
+			if (data.Size > sizeof(data.Index))
+				return false;
+			return Utils::ReadVarint(m_Cur, m_End, data.ID) && readTimestamp(data.Timestamp) && ReadWords(m_Cur, m_End, data.Index, data.Size);
+		}
+		case EEventType::ForLoopIterEnd:
+		{
+			auto& data = reinterpret_cast<ForLoopIterEndEvent&>(event);
+			return Utils::ReadVarint(m_Cur, m_End, data.ID) && readTimestamp(data.Timestamp);
+		}
+		case EEventType::MemAlloc:
+		{
+			auto&         data = reinterpret_cast<MemAllocEvent&>(event);
+			std::uint64_t value;
+			if (!Utils::ReadVarint(m_Cur, m_End, value))
+				return false;
+			data.Memory = reinterpret_cast<void*>(value);
+			return Utils::ReadVarint(m_Cur, m_End, data.Size) && readTimestamp(data.Timestamp);
+		}
+		case EEventType::MemFree:
+		{
+			auto&         data = reinterpret_cast<MemFreeEvent&>(event);
+			std::uint64_t value;
+			if (!Utils::ReadVarint(m_Cur, m_End, value))
+				return false;
+			data.Memory = reinterpret_cast<void*>(value);
+			return readTimestamp(data.Timestamp);
+		}
+		case EEventType::DataHeader:
+		{
+			auto& data = reinterpret_cast<DataHeaderEvent&>(event);
+			return Utils::ReadVarint(m_Cur, m_End, data.Size) && Utils::ReadVarint(m_Cur, m_End, data.ID);
+		}
+		case EEventType::DataSection:
+		{
+			if (m_Cur == m_End)
+				return false;
+			std::uint8_t size = *m_Cur++;
+			if (size > sizeof(DataSectionEvent) || m_End - m_Cur < size)
+				return false;
+			std::memcpy(&event, m_Cur, size);
+			m_Cur += size;
+			return true;
+		}
+		case EEventType::ZoneBegin:
+		{
+			auto&         data = reinterpret_cast<ZoneBeginEvent&>(event);
+			std::uint64_t value;
+			if (!Utils::ReadVarint(m_Cur, m_End, value))
+				return false;
+			data.DescriptorID = static_cast<std::uint32_t>(value);
+			return readTimestamp(data.Timestamp);
+		}
+		case EEventType::Sample:
+		{
+			auto& data = reinterpret_cast<SampleEvent&>(event);
+			return Utils::ReadVarint(m_Cur, m_End, data.DataID) && Utils::ReadVarint(m_Cur, m_End, data.NumEntries) && readTimestamp(data.Timestamp);
+		}
+		case EEventType::ZoneSample:
+		{
+			auto& data = reinterpret_cast<ZoneSampleEvent&>(event);
+			if (m_Cur == m_End)
+				return false;
+			data.NumEntries = *m_Cur++;
+			return Utils::ReadVarint(m_Cur, m_End, data.ThreadID) && Utils::ReadVarint(m_Cur, m_End, data.DataID) && readTimestamp(data.Timestamp);
+		}
+		default:
+			return false;
+		}
+	}
+} // namespace Profiler
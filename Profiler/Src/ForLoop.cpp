@@ -8,7 +8,7 @@ namespace Profiler::Detail
 
 		auto& data = NewEvent<ForLoopBeginEvent>(state);
 		data.ID    = id;
-		CaptureLowResTimestamp(data.Timestamp);
+		CaptureLowResTimestamp<EZoneType::ForLoop>(data.Timestamp);
 		return id;
 	}
 
@@ -16,7 +16,7 @@ namespace Profiler::Detail
 	{
 		auto& data = NewEvent<ForLoopEndEvent>(state);
 		data.ID    = id;
-		CaptureLowResTimestamp(data.Timestamp);
+		CaptureLowResTimestamp<EZoneType::ForLoop>(data.Timestamp);
 	}
 
 	std::uint64_t HRForLoopBegin(ThreadState* state)
@@ -25,7 +25,7 @@ namespace Profiler::Detail
 
 		auto& data = NewEvent<ForLoopBeginEvent>(state);
 		data.ID    = id;
-		CaptureHighResTimestamp(data.Timestamp);
+		CaptureHighResTimestamp<EZoneType::ForLoop>(data.Timestamp);
 		return id;
 	}
 
@@ -33,7 +33,7 @@ namespace Profiler::Detail
 	{
 		auto& data = NewEvent<ForLoopEndEvent>(state);
 		data.ID    = id;
-		CaptureHighResTimestamp(data.Timestamp);
+		CaptureHighResTimestamp<EZoneType::ForLoop>(data.Timestamp);
 	}
 
 	void ForLoopIterBegin(ThreadState* state, std::uint64_t id, std::uint8_t size, std::uint64_t (&values)[2])
@@ -41,7 +41,7 @@ namespace Profiler::Detail
 		auto& data = NewEvent<ForLoopIterBeginEvent>(state);
 		data.Size  = size;
 		data.ID    = id;
-		CaptureLowResTimestamp(data.Timestamp);
+		CaptureLowResTimestamp<EZoneType::ForLoop>(data.Timestamp);
 		std::memcpy(data.Index, values, sizeof(values));
 	}
 
@@ -49,7 +49,7 @@ namespace Profiler::Detail
 	{
 		auto& data = NewEvent<ForLoopIterEndEvent>(state);
 		data.ID    = id;
-		CaptureLowResTimestamp(data.Timestamp);
+		CaptureLowResTimestamp<EZoneType::ForLoop>(data.Timestamp);
 	}
 
 	void HRForLoopIterBegin(ThreadState* state, std::uint64_t id, std::uint8_t size, std::uint64_t (&values)[2])
@@ -57,7 +57,7 @@ namespace Profiler::Detail
 		auto& data = NewEvent<ForLoopIterBeginEvent>(state);
 		data.Size  = size;
 		data.ID    = id;
-		CaptureHighResTimestamp(data.Timestamp);
+		CaptureHighResTimestamp<EZoneType::ForLoop>(data.Timestamp);
 		std::memcpy(data.Index, values, sizeof(values));
 	}
 
@@ -65,6 +65,6 @@ namespace Profiler::Detail
 	{
 		auto& data = NewEvent<ForLoopIterEndEvent>(state);
 		data.ID    = id;
-		CaptureHighResTimestamp(data.Timestamp);
+		CaptureHighResTimestamp<EZoneType::ForLoop>(data.Timestamp);
 	}
 } // namespace Profiler::Detail
\ No newline at end of file
@@ -1,24 +1,34 @@
 #include "Profiler/Frame.h"
+#include "Profiler/Modules.h"
+#include "Profiler/Zone.h"
 
 namespace Profiler::Detail
 {
 	void Frame(ThreadState* state)
 	{
-		if (state->FunctionDepth)
+		if (state->FunctionDepth > state->InstrumentOpen)
 			throw std::runtime_error("Previous frame ended with unended functions, FIX YOUR FUCKING FUNCTION CALLS!");
 
 		auto& event    = NewEvent<FrameEvent>(state);
 		event.FrameNum = g_State.CurrentFrame++;
-		CaptureLowResTimestamp(event.Timestamp);
+		CaptureLowResTimestamp<EZoneType::Frame>(event.Timestamp);
+		RecordClockSample();
+		UpdateModules();
+		UpdateHotZones();
+		DrainSamples(state);
 	}
 
 	void HRFrame(ThreadState* state)
 	{
-		if (state->FunctionDepth)
+		if (state->FunctionDepth > state->InstrumentOpen)
 			throw std::runtime_error("Previous frame ended with unended functions, FIX YOUR FUCKING FUNCTION CALLS!");
 
 		auto& event    = NewEvent<FrameEvent>(state);
 		event.FrameNum = g_State.CurrentFrame++;
-		CaptureHighResTimestamp(event.Timestamp);
+		CaptureHighResTimestamp<EZoneType::Frame>(event.Timestamp);
+		RecordClockSample();
+		UpdateModules();
+		UpdateHotZones();
+		DrainSamples(state);
 	}
 } // namespace Profiler::Detail
\ No newline at end of file
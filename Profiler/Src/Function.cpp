@@ -1,39 +1,64 @@
+#include "Profiler/CallTree.h"
 #include "Profiler/Function.h"
+#include "Profiler/ZoneStack.h"
 
 namespace Profiler::Detail
 {
 	void FunctionBegin(ThreadState* state, void* functionPtr)
 	{
+		if (g_State.BuildCallTrees)
+			return CallTreeBegin(state, reinterpret_cast<std::uintptr_t>(functionPtr));
+		if (g_State.SampleZoneStacks)
+			return ZoneStackBegin(state, reinterpret_cast<std::uintptr_t>(functionPtr));
+
 		auto& event       = NewEvent<FunctionBeginEvent>(state);
 		event.FunctionPtr = functionPtr;
-		CaptureLowResTimestamp(event.Timestamp);
+		CaptureLowResTimestamp<EZoneType::Function>(event.Timestamp);
 		++state->FunctionDepth;
 	}
 
 	void FunctionEnd(ThreadState* state)
 	{
+		if (g_State.BuildCallTrees)
+			return CallTreeEnd(state);
+		if (g_State.SampleZoneStacks)
+			return ZoneStackEnd(state);
+
 		auto& event = NewEvent<FunctionEndEvent>(state);
-		CaptureLowResTimestamp(event.Timestamp);
+		CaptureLowResTimestamp<EZoneType::Function>(event.Timestamp);
 		--state->FunctionDepth;
 	}
 
 	void HRFunctionBegin(ThreadState* state, void* functionPtr)
 	{
+		if (g_State.BuildCallTrees)
+			return CallTreeBegin(state, reinterpret_cast<std::uintptr_t>(functionPtr));
+		if (g_State.SampleZoneStacks)
+			return ZoneStackBegin(state, reinterpret_cast<std::uintptr_t>(functionPtr));
+
 		auto& event       = NewEvent<FunctionBeginEvent>(state);
 		event.FunctionPtr = functionPtr;
-		CaptureHighResTimestamp(event.Timestamp);
+		CaptureHighResTimestamp<EZoneType::Function>(event.Timestamp);
 		++state->FunctionDepth;
 	}
 
 	void HRFunctionEnd(ThreadState* state)
 	{
+		if (g_State.BuildCallTrees)
+			return CallTreeEnd(state);
+		if (g_State.SampleZoneStacks)
+			return ZoneStackEnd(state);
+
 		auto& event = NewEvent<FunctionEndEvent>(state);
-		CaptureHighResTimestamp(event.Timestamp);
+		CaptureHighResTimestamp<EZoneType::Function>(event.Timestamp);
 		--state->FunctionDepth;
 	}
 
 	void BoolArg(ThreadState* state, std::uint8_t offset, bool value)
 	{
+		if (g_State.BuildCallTrees || g_State.SampleZoneStacks)
+			return;
+
 		auto& event  = NewEvent<BoolArgumentEvent>(state);
 		event.Offset = offset;
 		event.Value  = value;
@@ -41,6 +66,9 @@ namespace Profiler::Detail
 
 	void IntArg(ThreadState* state, std::uint8_t offset, std::uint8_t size, std::uint64_t (&values)[3], std::uint8_t base)
 	{
+		if (g_State.BuildCallTrees || g_State.SampleZoneStacks)
+			return;
+
 		auto& event  = NewEvent<IntArgumentEvent>(state);
 		event.Offset = offset;
 		event.Size   = size;
@@ -50,6 +78,9 @@ namespace Profiler::Detail
 
 	void FloatArg(ThreadState* state, std::uint8_t offset, std::uint8_t size, std::uint64_t (&values)[3])
 	{
+		if (g_State.BuildCallTrees || g_State.SampleZoneStacks)
+			return;
+
 		auto& event  = NewEvent<FloatArgumentEvent>(state);
 		event.Offset = offset;
 		event.Size   = size;
@@ -58,6 +89,9 @@ namespace Profiler::Detail
 
 	void FlagsArg(ThreadState* state, std::uint8_t offset, std::uint64_t flagsType, std::uint64_t (&values)[2])
 	{
+		if (g_State.BuildCallTrees || g_State.SampleZoneStacks)
+			return;
+
 		auto& event     = NewEvent<FlagsArgumentEvent>(state);
 		event.Offset    = offset;
 		event.FlagsType = flagsType;
@@ -66,6 +100,9 @@ namespace Profiler::Detail
 
 	void PtrArg(ThreadState* state, std::uint8_t offset, void* ptr)
 	{
+		if (g_State.BuildCallTrees || g_State.SampleZoneStacks)
+			return;
+
 		auto& event  = NewEvent<PtrArgumentEvent>(state);
 		event.Offset = offset;
 		event.Ptr    = ptr;
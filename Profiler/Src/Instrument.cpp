@@ -0,0 +1,219 @@
+#include "Profiler/Function.h"
+#include "Profiler/Instrument.h"
+#include "Profiler/Modules.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Profiler
+{
+	struct InstrumentRange
+	{
+	public:
+		std::uint64_t Start;
+		std::uint64_t End;
+	};
+
+	// Sorted and merged, replaced as a whole so the hooks can read it without a lock.
+	struct InstrumentExclusions
+	{
+	public:
+		std::vector<InstrumentRange> Ranges;
+	};
+
+	static struct InstrumentFilter
+	{
+		std::atomic<const InstrumentExclusions*> Current = nullptr;
+		std::vector<const InstrumentExclusions*> Retired;
+		std::vector<InstrumentRange>             Ranges;
+		std::vector<std::string>                 Modules;
+		std::mutex                               Mutex;
+	} s_InstrumentFilter;
+
+	static bool ModuleMatches(const LoadedModule& module, std::string_view name)
+	{
+		return module.Path == name || std::filesystem::path { module.Path }.filename() == name;
+	}
+
+	// Expects the filter's mutex to be held.
+	static void PublishExclusions()
+	{
+		std::vector<InstrumentRange> ranges = s_InstrumentFilter.Ranges;
+		if (!s_InstrumentFilter.Modules.empty())
+		{
+			for (auto& module : ModuleSnapshot())
+			{
+				if (module.UnloadTime)
+					continue;
+				if (std::any_of(s_InstrumentFilter.Modules.begin(), s_InstrumentFilter.Modules.end(), [&module](const std::string& name) { return ModuleMatches(module, name); }))
+					ranges.emplace_back(InstrumentRange { module.Start, module.End });
+			}
+		}
+		std::sort(ranges.begin(), ranges.end(), [](const InstrumentRange& lhs, const InstrumentRange& rhs) { return lhs.Start < rhs.Start; });
+
+		InstrumentExclusions* exclusions = nullptr;
+		if (!ranges.empty())
+		{
+			exclusions = new InstrumentExclusions();
+			for (auto& range : ranges)
+			{
+				if (!exclusions->Ranges.empty() && range.Start <= exclusions->Ranges.back().End)
+					exclusions->Ranges.back().End = std::max(exclusions->Ranges.back().End, range.End);
+				else
+					exclusions->Ranges.emplace_back(range);
+			}
+		}
+		if (const InstrumentExclusions* previous = s_InstrumentFilter.Current.exchange(exclusions, std::memory_order_acq_rel))
+			s_InstrumentFilter.Retired.emplace_back(previous);
+	}
+
+	void ExcludeInstrumentedRange(std::uint64_t start, std::uint64_t end)
+	{
+		if (start >= end)
+			return;
+		std::lock_guard lock(s_InstrumentFilter.Mutex);
+		s_InstrumentFilter.Ranges.emplace_back(InstrumentRange { start, end });
+		PublishExclusions();
+	}
+
+	void ExcludeInstrumentedModule(std::string_view name)
+	{
+		std::lock_guard lock(s_InstrumentFilter.Mutex);
+		s_InstrumentFilter.Modules.emplace_back(name);
+		PublishExclusions();
+	}
+
+	void ClearInstrumentExclusions()
+	{
+		std::lock_guard lock(s_InstrumentFilter.Mutex);
+		s_InstrumentFilter.Ranges.clear();
+		s_InstrumentFilter.Modules.clear();
+		PublishExclusions();
+	}
+
+	static bool IsInstrumentExcluded(std::uint64_t address)
+	{
+		const InstrumentExclusions* exclusions = s_InstrumentFilter.Current.load(std::memory_order_acquire);
+		if (!exclusions)
+			return false;
+		auto itr = std::upper_bound(exclusions->Ranges.begin(), exclusions->Ranges.end(), address, [](std::uint64_t value, const InstrumentRange& range) { return value < range.Start; });
+		return itr != exclusions->Ranges.begin() && address < (itr - 1)->End;
+	}
+
+	namespace Detail
+	{
+		void LoadInstrumentExclusions()
+		{
+			const char* list = std::getenv("PROFILER_INSTRUMENT_EXCLUDE");
+			if (!list)
+				return;
+
+			std::string_view entries = list;
+			while (!entries.empty())
+			{
+				std::size_t end   = entries.find(',');
+				auto        entry = entries.substr(0, end);
+				entries           = end == std::string_view::npos ? std::string_view {} : entries.substr(end + 1);
+				if (entry.empty())
+					continue;
+
+				unsigned long long start = 0, stop = 0;
+				int                length = 0;
+				std::string        copy { entry };
+				if (std::sscanf(copy.c_str(), "%llx-%llx%n", &start, &stop, &length) == 2 && static_cast<std::size_t>(length) == copy.size())
+					ExcludeInstrumentedRange(start, stop);
+				else
+					ExcludeInstrumentedModule(entry);
+			}
+		}
+
+		void UpdateInstrumentExclusions()
+		{
+			std::lock_guard lock(s_InstrumentFilter.Mutex);
+			if (!s_InstrumentFilter.Modules.empty())
+				PublishExclusions();
+		}
+
+		// The current table stays, instrumented code may still be running.
+		void FreeInstrumentExclusions()
+		{
+			std::lock_guard lock(s_InstrumentFilter.Mutex);
+			for (auto exclusions : s_InstrumentFilter.Retired)
+				delete exclusions;
+			s_InstrumentFilter.Retired.clear();
+		}
+
+		BUILD_NO_INSTRUMENT static void InstrumentEnter(void* function)
+		{
+			ThreadState* state = GetThreadState();
+			if (state->InInstrumentHook)
+				return;
+			std::uint64_t depth = state->InstrumentDepth++;
+			if (depth >= c_MaxInstrumentDepth || !(state->Capture || state->Aggregate) || IsInstrumentExcluded(reinterpret_cast<std::uintptr_t>(function)))
+				return;
+
+			std::uint64_t bit                   = 1ULL << (depth & 63);
+			state->InInstrumentHook             = true;
+			state->InstrumentBegun[depth >> 6] |= bit;
+			if (state->Capture)
+			{
+				state->InstrumentAggregated[depth >> 6] &= ~bit;
+				++state->InstrumentOpen;
+				HRFunctionBegin(state, function);
+			}
+			else
+			{
+				state->InstrumentAggregated[depth >> 6] |= bit;
+				AggregateBegin(state, reinterpret_cast<std::uintptr_t>(function));
+			}
+			state->InInstrumentHook = false;
+		}
+
+		BUILD_NO_INSTRUMENT static void InstrumentExit()
+		{
+			ThreadState* state = GetThreadState();
+			if (state->InInstrumentHook || !state->InstrumentDepth)
+				return;
+			std::uint64_t depth = --state->InstrumentDepth;
+			if (depth >= c_MaxInstrumentDepth || !((state->InstrumentBegun[depth >> 6] >> (depth & 63)) & 1))
+				return;
+
+			// Ends on the path the call began on even if the thread's mode changed since, so begins and ends stay paired.
+			std::uint64_t bit                   = 1ULL << (depth & 63);
+			state->InInstrumentHook             = true;
+			state->InstrumentBegun[depth >> 6] &= ~bit;
+			if (state->InstrumentAggregated[depth >> 6] & bit)
+			{
+				AggregateEnd(state);
+			}
+			else
+			{
+				--state->InstrumentOpen;
+				HRFunctionEnd(state);
+			}
+			state->InInstrumentHook = false;
+		}
+	} // namespace Detail
+} // namespace Profiler
+
+extern "C"
+{
+	BUILD_NO_INSTRUMENT void __cyg_profile_func_enter(void* function, [[maybe_unused]] void* callSite)
+	{
+		if constexpr (Profiler::c_ProfilerEnabled)
+			Profiler::Detail::InstrumentEnter(function);
+	}
+
+	BUILD_NO_INSTRUMENT void __cyg_profile_func_exit([[maybe_unused]] void* function, [[maybe_unused]] void* callSite)
+	{
+		if constexpr (Profiler::c_ProfilerEnabled)
+			Profiler::Detail::InstrumentExit();
+	}
+}
@@ -7,7 +7,7 @@ namespace Profiler::Detail
 		auto& data  = NewEvent<MemAllocEvent>(state);
 		data.Memory = memory;
 		data.Size   = size;
-		CaptureLowResTimestamp(data.Timestamp);
+		CaptureLowResTimestamp<EZoneType::Memory>(data.Timestamp);
 	}
 
 	void HRMemAlloc(ThreadState* state, void* memory, std::uint64_t size)
@@ -15,20 +15,20 @@ namespace Profiler::Detail
 		auto& data  = NewEvent<MemAllocEvent>(state);
 		data.Memory = memory;
 		data.Size   = size;
-		CaptureHighResTimestamp(data.Timestamp);
+		CaptureHighResTimestamp<EZoneType::Memory>(data.Timestamp);
 	}
 
 	void MemFree(ThreadState* state, void* memory)
 	{
 		auto& data  = NewEvent<MemFreeEvent>(state);
 		data.Memory = memory;
-		CaptureLowResTimestamp(data.Timestamp);
+		CaptureLowResTimestamp<EZoneType::Memory>(data.Timestamp);
 	}
 
 	void HRMemFree(ThreadState* state, void* memory)
 	{
 		auto& data  = NewEvent<MemFreeEvent>(state);
 		data.Memory = memory;
-		CaptureHighResTimestamp(data.Timestamp);
+		CaptureHighResTimestamp<EZoneType::Memory>(data.Timestamp);
 	}
 } // namespace Profiler::Detail
\ No newline at end of file
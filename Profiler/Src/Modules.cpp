@@ -0,0 +1,184 @@
+#include "Profiler/Elf.h"
+#include "Profiler/Instrument.h"
+#include "Profiler/Modules.h"
+#include "Profiler/State.h"
+#include "Profiler/Unwind.h"
+
+#include <algorithm>
+#include <mutex>
+
+#if BUILD_IS_SYSTEM_LINUX
+	#include <climits>
+	#include <cstddef>
+	#include <cstdlib>
+
+	#include <link.h>
+	#include <unistd.h>
+#endif
+
+namespace Profiler
+{
+	static struct ModuleTable
+	{
+		std::vector<LoadedModule> Modules;
+		std::mutex                Mutex;
+		std::uint64_t             Adds = 0;
+		std::uint64_t             Subs = 0;
+	} s_ModuleTable;
+
+#if BUILD_IS_SYSTEM_LINUX
+	struct ModuleScan
+	{
+	public:
+		std::uint64_t             Adds      = 0;
+		std::uint64_t             Subs      = 0;
+		bool                      Unchanged = false;
+		std::vector<LoadedModule> Modules;
+	};
+
+	static std::string ExecutablePath()
+	{
+		char    path[PATH_MAX];
+		ssize_t size = readlink("/proc/self/exe", path, sizeof(path) - 1);
+		return size > 0 ? std::string { path, static_cast<std::size_t>(size) } : std::string {};
+	}
+
+	// Relative dlopen names are made absolute while the working directory still matches, the vDSO keeps its name.
+	static std::string ModulePath(const char* name)
+	{
+		if (!name || !*name)
+			return ExecutablePath();
+		char path[PATH_MAX];
+		if (*name != '/' && realpath(name, path))
+			return path;
+		return name;
+	}
+
+	static int ScanModuleCallback(dl_phdr_info* info, std::size_t size, void* data)
+	{
+		ModuleScan* scan = static_cast<ModuleScan*>(data);
+		if (size >= offsetof(dl_phdr_info, dlpi_subs) + sizeof(info->dlpi_subs) && scan->Modules.empty())
+		{
+			scan->Unchanged = info->dlpi_adds == scan->Adds && info->dlpi_subs == scan->Subs;
+			scan->Adds      = info->dlpi_adds;
+			scan->Subs      = info->dlpi_subs;
+			// Stopping at the first module keeps a frame without loader activity down to one callback.
+			if (scan->Unchanged)
+				return 1;
+		}
+
+		LoadedModule module { info->dlpi_addr, ~0ULL, 0, 0, 0, {}, {} };
+		for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i)
+		{
+			const ElfW(Phdr)& header = info->dlpi_phdr[i];
+			if (header.p_type == PT_LOAD)
+			{
+				module.Start = std::min<std::uint64_t>(module.Start, info->dlpi_addr + header.p_vaddr);
+				module.End   = std::max<std::uint64_t>(module.End, info->dlpi_addr + header.p_vaddr + header.p_memsz);
+			}
+			else if (header.p_type == PT_NOTE && module.BuildID.empty())
+			{
+				module.BuildID = ReadBuildIDNote(reinterpret_cast<const std::uint8_t*>(info->dlpi_addr + header.p_vaddr), header.p_memsz);
+			}
+		}
+		if (module.Start >= module.End)
+			return 0;
+		module.Path = ModulePath(info->dlpi_name);
+		scan->Modules.emplace_back(std::move(module));
+		return 0;
+	}
+#endif
+
+	static bool SameModule(const LoadedModule& lhs, const LoadedModule& rhs)
+	{
+		return lhs.Base == rhs.Base && lhs.Start == rhs.Start && lhs.Path == rhs.Path;
+	}
+
+	void LoadModules()
+	{
+		{
+			std::lock_guard lock(s_ModuleTable.Mutex);
+			s_ModuleTable.Modules.clear();
+#if BUILD_IS_SYSTEM_LINUX
+			ModuleScan scan;
+			dl_iterate_phdr(&ScanModuleCallback, &scan);
+			s_ModuleTable.Modules = std::move(scan.Modules);
+			s_ModuleTable.Adds    = scan.Adds;
+			s_ModuleTable.Subs    = scan.Subs;
+			std::sort(s_ModuleTable.Modules.begin(), s_ModuleTable.Modules.end(), [](const LoadedModule& lhs, const LoadedModule& rhs) { return lhs.Start < rhs.Start; });
+#endif
+		}
+		Detail::UpdateInstrumentExclusions();
+	}
+
+	bool UpdateModules()
+	{
+#if BUILD_IS_SYSTEM_LINUX
+		ModuleScan scan;
+		{
+			std::lock_guard lock(s_ModuleTable.Mutex);
+			scan.Adds = s_ModuleTable.Adds;
+			scan.Subs = s_ModuleTable.Subs;
+		}
+		dl_iterate_phdr(&ScanModuleCallback, &scan);
+		if (scan.Unchanged)
+			return false;
+
+		std::uint64_t now     = MonotonicNanoseconds();
+		bool          loaded  = false;
+		bool          changed = false;
+		{
+			std::lock_guard lock(s_ModuleTable.Mutex);
+			auto&           modules = s_ModuleTable.Modules;
+			s_ModuleTable.Adds      = scan.Adds;
+			s_ModuleTable.Subs      = scan.Subs;
+			for (auto& module : modules)
+			{
+				if (module.UnloadTime)
+					continue;
+				if (std::none_of(scan.Modules.begin(), scan.Modules.end(), [&module](const LoadedModule& current) { return SameModule(module, current); }))
+				{
+					module.UnloadTime = now;
+					changed           = true;
+				}
+			}
+			for (auto& current : scan.Modules)
+			{
+				if (std::any_of(modules.begin(), modules.end(), [&current](const LoadedModule& module) { return !module.UnloadTime && SameModule(module, current); }))
+					continue;
+				current.LoadTime = now;
+				modules.emplace_back(std::move(current));
+				loaded = changed = true;
+			}
+			std::stable_sort(modules.begin(), modules.end(), [](const LoadedModule& lhs, const LoadedModule& rhs) { return lhs.Start < rhs.Start; });
+		}
+		if (loaded)
+			LoadUnwindTables();
+		if (changed)
+			Detail::UpdateInstrumentExclusions();
+		return changed;
+#else
+		return false;
+#endif
+	}
+
+	std::vector<LoadedModule> ModuleSnapshot()
+	{
+		std::lock_guard lock(s_ModuleTable.Mutex);
+		return s_ModuleTable.Modules;
+	}
+
+	const LoadedModule* FindModule(const std::vector<LoadedModule>& modules, std::uint64_t address)
+	{
+		const LoadedModule* found = nullptr;
+		auto                end   = std::upper_bound(modules.begin(), modules.end(), address, [](std::uint64_t value, const LoadedModule& module) { return value < module.Start; });
+		for (auto itr = modules.begin(); itr != end; ++itr)
+		{
+			if (address >= itr->End)
+				continue;
+			if (!found || (found->UnloadTime && (!itr->UnloadTime || itr->UnloadTime > found->UnloadTime)))
+				found = &*itr;
+		}
+		return found;
+	}
+} // namespace Profiler
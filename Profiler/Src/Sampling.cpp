@@ -0,0 +1,251 @@
+#include "Profiler/Callstack.h"
+#include "Profiler/Sampling.h"
+#include "Profiler/Timestamp.h"
+
+#include <atomic>
+
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+	#include <cerrno>
+
+	#include <pthread.h>
+	#include <signal.h>
+	#include <sys/syscall.h>
+	#include <time.h>
+	#include <ucontext.h>
+	#include <unistd.h>
+
+	#ifndef sigev_notify_thread_id
+		#define sigev_notify_thread_id _sigev_un._tid
+	#endif
+#endif
+
+namespace Profiler
+{
+	struct SampleSlot
+	{
+	public:
+		EventTimestamp Timestamp;
+		std::size_t    Size;
+		void*          Frames[c_MaxCallstackDepth];
+	};
+
+	// Single producer ring, the producer is the thread's signal handler and the consumer the thread itself.
+	struct SampleBuffer
+	{
+	public:
+		std::atomic_uint32_t Head     = 0;
+		std::atomic_uint32_t Tail     = 0;
+		std::atomic_uint32_t Dropped  = 0;
+		bool                 Draining = false;
+		SampleSlot           Slots[c_SampleBufferSize];
+	};
+
+	struct ThreadSampler
+	{
+	public:
+		std::atomic<SampleBuffer*> Buffer = nullptr;
+		bool                       Armed  = false;
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+		clockid_t Clock    = CLOCK_THREAD_CPUTIME_ID;
+		pid_t     ThreadID = 0;
+		timer_t   Timer {};
+#endif
+	};
+
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+	static bool s_HandlerInstalled = false;
+
+	// Only touches the interrupted thread's own buffer, the unwinder and the clock, all of which are async signal safe.
+	static void SampleSignalHandler([[maybe_unused]] int signal, [[maybe_unused]] siginfo_t* info, void* context)
+	{
+		int            savedErrno = errno;
+		ThreadState*   state      = GetThreadState();
+		ThreadSampler* sampler    = state->Sampler;
+		SampleBuffer*  buffer     = sampler ? sampler->Buffer.load(std::memory_order_acquire) : nullptr;
+		if (buffer && state->Capture.load(std::memory_order_relaxed))
+		{
+			std::uint32_t head = buffer->Head.load(std::memory_order_relaxed);
+			if (head - buffer->Tail.load(std::memory_order_acquire) >= c_SampleBufferSize)
+			{
+				buffer->Dropped.fetch_add(1, std::memory_order_relaxed);
+			}
+			else
+			{
+				SampleSlot& slot = buffer->Slots[head % c_SampleBufferSize];
+				CaptureHighResTimestamp<EZoneType::Sample>(slot.Timestamp);
+
+				const mcontext_t& registers = static_cast<const ucontext_t*>(context)->uc_mcontext;
+				UnwindContext     unwind;
+				unwind.PC = static_cast<std::uintptr_t>(registers.gregs[REG_RIP]);
+				unwind.SP = static_cast<std::uintptr_t>(registers.gregs[REG_RSP]);
+				unwind.FP = static_cast<std::uintptr_t>(registers.gregs[REG_RBP]);
+				slot.Size = UnwindCallstack(unwind, slot.Frames, c_MaxCallstackDepth);
+				buffer->Head.store(head + 1, std::memory_order_release);
+			}
+		}
+		errno = savedErrno;
+	}
+
+	static bool InstallHandler()
+	{
+		if (s_HandlerInstalled)
+			return true;
+
+		// Left installed once sampling stops, a timer signal still pending would otherwise terminate the process.
+		struct sigaction action {};
+		action.sa_sigaction = &SampleSignalHandler;
+		action.sa_flags     = SA_SIGINFO | SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		s_HandlerInstalled = sigaction(SIGPROF, &action, nullptr) == 0;
+		return s_HandlerInstalled;
+	}
+
+	// Buffers are never freed, samplers and their buffers are reused by later threads.
+	static void ArmSampler(ThreadSampler* sampler, std::uint32_t frequency)
+	{
+		if (!sampler->Buffer.load(std::memory_order_relaxed))
+			sampler->Buffer.store(new SampleBuffer(), std::memory_order_release);
+
+		if (!sampler->Armed)
+		{
+			sigevent event {};
+			event.sigev_notify           = SIGEV_THREAD_ID;
+			event.sigev_signo            = SIGPROF;
+			event.sigev_notify_thread_id = sampler->ThreadID;
+			if (timer_create(sampler->Clock, &event, &sampler->Timer) != 0)
+				return;
+			sampler->Armed = true;
+		}
+
+		std::uint64_t interval = 1'000'000'000 / frequency;
+		itimerspec    spec {};
+		spec.it_interval.tv_sec  = static_cast<time_t>(interval / 1'000'000'000);
+		spec.it_interval.tv_nsec = static_cast<long>(interval % 1'000'000'000);
+		spec.it_value            = spec.it_interval;
+		timer_settime(sampler->Timer, 0, &spec, nullptr);
+	}
+
+	static void DisarmSampler(ThreadSampler* sampler)
+	{
+		if (!sampler->Armed)
+			return;
+		timer_delete(sampler->Timer);
+		sampler->Armed = false;
+	}
+#endif
+
+	bool StartSampling([[maybe_unused]] std::uint32_t frequency)
+	{
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+		if (!frequency || frequency > 1'000'000)
+			return false;
+
+		std::lock_guard lock(g_State.ThreadsMutex);
+		if (!InstallHandler())
+			return false;
+		g_State.SamplingFrequency = frequency;
+		for (auto state : g_State.Threads)
+		{
+			if (state->Sampler)
+				ArmSampler(state->Sampler, frequency);
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void StopSampling()
+	{
+		std::lock_guard lock(g_State.ThreadsMutex);
+		g_State.SamplingFrequency = 0;
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+		for (auto sampler : g_State.Samplers)
+			DisarmSampler(sampler);
+#endif
+	}
+
+	bool IsSampling()
+	{
+		return g_State.SamplingFrequency != 0;
+	}
+
+	namespace Detail
+	{
+		void PrepareThreadSampling(ThreadState* state)
+		{
+			if (!state->Sampler)
+			{
+				ThreadSampler* sampler = nullptr;
+				if (g_State.FreeSamplers.empty())
+				{
+					sampler = new ThreadSampler();
+					g_State.Samplers.emplace_back(sampler);
+				}
+				else
+				{
+					sampler = g_State.FreeSamplers.back();
+					g_State.FreeSamplers.pop_back();
+					if (SampleBuffer* buffer = sampler->Buffer.load(std::memory_order_relaxed))
+					{
+						buffer->Head.store(0, std::memory_order_relaxed);
+						buffer->Tail.store(0, std::memory_order_relaxed);
+						buffer->Dropped.store(0, std::memory_order_relaxed);
+					}
+				}
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+				// The thread's own clock ID, CLOCK_THREAD_CPUTIME_ID would follow whichever thread creates the timer.
+				pthread_getcpuclockid(pthread_self(), &sampler->Clock);
+				sampler->ThreadID = static_cast<pid_t>(syscall(SYS_gettid));
+#endif
+				std::atomic_signal_fence(std::memory_order_seq_cst);
+				state->Sampler = sampler;
+			}
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+			if (g_State.SamplingFrequency)
+				ArmSampler(state->Sampler, g_State.SamplingFrequency);
+#endif
+		}
+
+		void StopThreadSampling(ThreadState* state)
+		{
+			ThreadSampler* sampler = state->Sampler;
+			if (!sampler)
+				return;
+
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+			DisarmSampler(sampler);
+#endif
+			// Runs on the thread itself, once detached its handler no longer reaches the sampler so a signal still
+			// pending cannot write into it after another thread takes it.
+			state->Sampler = nullptr;
+			std::atomic_signal_fence(std::memory_order_seq_cst);
+			g_State.FreeSamplers.emplace_back(sampler);
+		}
+
+		void DrainSamples(ThreadState* state)
+		{
+			SampleBuffer* buffer = state->Sampler->Buffer.load(std::memory_order_acquire);
+			if (!buffer || buffer->Draining)
+				return;
+
+			// Samples become events, whose blocks can fill up and drain again.
+			buffer->Draining   = true;
+			std::uint32_t tail = buffer->Tail.load(std::memory_order_relaxed);
+			while (tail != buffer->Head.load(std::memory_order_acquire))
+			{
+				SampleSlot&   slot = buffer->Slots[tail % c_SampleBufferSize];
+				std::uint64_t id   = InternCallstack(state, slot.Frames, slot.Size);
+
+				auto& event      = NewEvent<SampleEvent>(state);
+				event.DataID     = id;
+				event.NumEntries = slot.Size;
+				event.Timestamp  = slot.Timestamp;
+				buffer->Tail.store(++tail, std::memory_order_release);
+			}
+			if (std::uint32_t dropped = buffer->Dropped.exchange(0, std::memory_order_relaxed))
+				g_State.DroppedSamples.fetch_add(dropped, std::memory_order_relaxed);
+			buffer->Draining = false;
+		}
+	} // namespace Detail
+} // namespace Profiler
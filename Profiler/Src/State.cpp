@@ -1,10 +1,17 @@
+#include "Profiler/CallTree.h"
+#include "Profiler/Collector.h"
+#include "Profiler/Instrument.h"
+#include "Profiler/Modules.h"
 #include "Profiler/State.h"
+#include "Profiler/Timestamp.h"
+#include "Profiler/Zone.h"
 #include "Profiler/Utils/Core.h"
 #include "Profiler/Utils/IntrinsicsThatClangDoesntSupport.h"
 
-#include <iostream>
+#include <cstdio>
+#include <cstring>
 
-#include <fmt/format.h>
+#include <thread>
 
 #if BUILD_IS_SYSTEM_WINDOWS
 	#include <Windows.h>
@@ -22,6 +29,13 @@ typedef struct _PROCESSOR_POWER_INFORMATION
 	ULONG MaxIdleState;
 	ULONG CurrentIdleState;
 } PROCESSOR_POWER_INFORMATION, *PPROCESSOR_POWER_INFORMATION;
+#else
+	#include <time.h>
+#endif
+
+#if BUILD_IS_SYSTEM_LINUX
+	#include <sys/syscall.h>
+	#include <unistd.h>
 #endif
 
 namespace Profiler
@@ -29,23 +43,57 @@ namespace Profiler
 	State                    g_State {};
 	thread_local ThreadState g_TState {};
 
-	static void CheckInvariantClock()
+	std::uint64_t MonotonicNanoseconds()
 	{
-		int res[4];
-		Utils::cpuid(res, 0x8000'0001);
-		if (!((res[2] >> 23) & 1))
-			return;
+#if BUILD_IS_SYSTEM_WINDOWS
+		LARGE_INTEGER counter, frequency;
+		QueryPerformanceCounter(&counter);
+		QueryPerformanceFrequency(&frequency);
+		return static_cast<std::uint64_t>(counter.QuadPart / frequency.QuadPart * 1'000'000'000 + counter.QuadPart % frequency.QuadPart * 1'000'000'000 / frequency.QuadPart);
+#else
+		timespec ts {};
+		clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+		return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000 + static_cast<std::uint64_t>(ts.tv_nsec);
+#endif
+	}
 
-		Utils::cpuid(res, 1);
-		if (!((res[3] >> 4) & 1))
-			return;
+	// Reads the clocks a few times and keeps the readings with the tightest rdtsc window around them.
+	ClockSample SampleClocks()
+	{
+		ClockSample   best {};
+		std::uint64_t bestWindow = ~0ULL;
+		for (std::size_t i = 0; i < 16; ++i)
+		{
+			std::uint64_t before = Utils::rdtsc();
+			std::uint64_t ns     = MonotonicNanoseconds();
+			std::uint64_t lowRes = ReadClock<EClockSource::Monotonic>();
+			std::uint64_t after  = Utils::rdtsc();
+			if (after - before < bestWindow)
+			{
+				bestWindow = after - before;
+				best       = { before + (after - before) / 2, ns, lowRes };
+			}
+		}
+		return best;
+	}
 
-		Utils::cpuid(res, 0x8000'0007);
-		if (!((res[3] >> 8) & 1))
+	void RecordClockSample(bool force)
+	{
+		std::uint64_t now  = MonotonicNanoseconds();
+		std::uint64_t last = g_State.LastClockSample.load(std::memory_order_relaxed);
+		if (!force && now - last < c_ClockSampleInterval)
+			return;
+		if (!g_State.LastClockSample.compare_exchange_strong(last, now, std::memory_order_relaxed) && !force)
 			return;
 
-		g_State.Abilities |= Abilities::InvariantCPUClock;
+		ClockSample     sample = SampleClocks();
+		std::lock_guard lock(g_State.ClockSamplesMutex);
+		g_State.ClockSamples.emplace_back(sample);
+	}
 
+	// The frequency the kernel or CPU reports for the TSC, 0 if unknown.
+	static std::uint64_t ReportedInvariantClockFrequency()
+	{
 #if BUILD_IS_SYSTEM_WINDOWS
 		SYSTEM_INFO sysInfo {};
 		GetSystemInfo(&sysInfo);
@@ -56,14 +104,107 @@ namespace Profiler
 
 		CallNtPowerInformation(ProcessorInformation, nullptr, 0, infos, static_cast<ULONG>(coreCount * sizeof(*infos)));
 
-		g_State.InvariantClockFrequency = infos[0].MaxMhz * 1'000'000ULL;
+		std::uint64_t frequency = infos[0].MaxMhz * 1'000'000ULL;
 
 		delete[] infos;
+		return frequency;
 #else
-		g_State.InvariantClockFrequency = 0;
+		std::uint64_t frequency = 0;
+		if (std::FILE* file = std::fopen("/sys/devices/system/cpu/cpu0/tsc_freq_khz", "r"))
+		{
+			unsigned long long khz = 0;
+			if (std::fscanf(file, "%llu", &khz) == 1)
+				frequency = khz * 1'000;
+			std::fclose(file);
+			if (frequency)
+				return frequency;
+		}
+
+		// Crystal clock and TSC ratio, only reported by some Intel CPUs.
+		int res[4];
+		Utils::cpuid(res, 0);
+		if (res[0] >= 0x15)
+		{
+			Utils::cpuid(res, 0x15);
+			if (res[0] && res[1] && res[2])
+				return static_cast<std::uint64_t>(static_cast<unsigned>(res[2])) * static_cast<unsigned>(res[1]) / static_cast<unsigned>(res[0]);
+		}
+
+		// Intel brand strings carry the nominal frequency, which is the TSC frequency.
+		if (std::FILE* file = std::fopen("/proc/cpuinfo", "r"))
+		{
+			char line[256];
+			while (std::fgets(line, sizeof(line), file))
+			{
+				if (std::strncmp(line, "model name", 10) != 0)
+					continue;
+				if (const char* at = std::strstr(line, "@ "))
+				{
+					double ghz = 0.0;
+					if (std::sscanf(at + 2, "%lfGHz", &ghz) == 1)
+						frequency = static_cast<std::uint64_t>(ghz * 1e9 + 0.5);
+				}
+				break;
+			}
+			std::fclose(file);
+		}
+		return frequency;
 #endif
 	}
 
+	// Measures the TSC against the monotonic clock over a short window, a reported frequency is preferred when it agrees
+	// with the measurement as it is exact, otherwise (e.g. under virtualization) the measurement wins.
+	static void CalibrateInvariantClock()
+	{
+		ClockSample start = SampleClocks();
+		while (MonotonicNanoseconds() - start.Nanoseconds < 10'000'000)
+			std::this_thread::yield();
+		ClockSample end = SampleClocks();
+
+		std::uint64_t elapsed = end.Nanoseconds - start.Nanoseconds;
+		if (!elapsed || end.Ticks <= start.Ticks)
+			return;
+		std::uint64_t measured = static_cast<std::uint64_t>(static_cast<double>(end.Ticks - start.Ticks) * 1e9 / static_cast<double>(elapsed));
+		std::uint64_t reported = ReportedInvariantClockFrequency();
+
+		std::uint64_t frequency = measured;
+		if (reported && (reported > measured ? reported - measured : measured - reported) < measured / 200)
+			frequency = reported;
+
+		g_State.InvariantClockFrequency = frequency;
+		g_State.InvariantClockOffset    = start.Ticks;
+		g_State.InvariantClockEpoch     = start.Nanoseconds;
+		g_State.InvariantClockScale     = static_cast<std::uint64_t>((static_cast<long double>(1'000'000'000) * 4294967296.0L) / frequency + 0.5L);
+	}
+
+	static void CheckInvariantClock()
+	{
+		int res[4];
+		Utils::cpuid(res, 0x8000'0000);
+		if (static_cast<unsigned>(res[0]) < 0x8000'0007)
+			return;
+
+		Utils::cpuid(res, 1);
+		if (!((res[3] >> 4) & 1))
+			return;
+
+		Utils::cpuid(res, 0x8000'0007);
+		if (!((res[3] >> 8) & 1))
+			return;
+
+		g_State.Abilities |= Abilities::InvariantCPUClock;
+
+		CalibrateInvariantClock();
+	}
+
+	static void CheckRDTSCP()
+	{
+		int res[4];
+		Utils::cpuid(res, 0x8000'0001);
+		if ((res[3] >> 27) & 1)
+			g_State.Abilities |= Abilities::RDTSCP;
+	}
+
 	static void CheckIBS()
 	{
 		int res[4];
@@ -88,53 +229,77 @@ namespace Profiler
 		g_State.Initialized = true;
 		g_State.Capturing   = false;
 		g_State.Abilities   = 0;
-		g_State.Events.clear();
+		g_State.clearEvents();
+		ClearCallTrees();
+		++g_State.CallstackGeneration;
 		g_State.CurrentFrame            = 0;
 		g_State.InvariantClockFrequency = 0;
-		g_State.Threads.clear();
-		g_TState.ThreadID = GetThreadID();
+		g_State.InvariantClockOffset    = 0;
+		g_State.InvariantClockEpoch     = 0;
+		g_State.InvariantClockScale     = 0;
+		g_State.ClockSamples.clear();
+		g_State.LastClockSample = 0;
 		g_State.ThreadsMutex.lock();
-		g_State.Threads.emplace_back(&g_TState);
-		g_State.MainThreadID = g_State.Threads.back()->ThreadID;
+		g_State.Threads.clear();
 		g_State.ThreadsMutex.unlock();
+		g_TState.ThreadID = GetThreadID();
+		g_State.addThread(&g_TState);
+		g_State.MainThreadID = g_TState.ThreadID;
 
 		CheckInvariantClock();
+		CheckRDTSCP();
 		CheckIBS();
 		SetupTLS();
+		LoadModules();
+		LoadUnwindTables();
+		Detail::LoadZoneFilters();
+		Detail::LoadInstrumentExclusions();
 	}
 
 	void Deinit()
 	{
 		g_State.Initialized = false;
 		g_State.Capturing   = false;
-		g_State.Events.clear();
+		g_State.Aggregating = false;
+		StopSampling();
+		StopZoneSampler();
+		g_State.ThreadsMutex.lock();
 		for (auto tstate : g_State.Threads)
 		{
-			tstate->Capture = false;
-			g_State.pushEvents(tstate->Buffer, tstate->CurrentIndex, tstate->ThreadID);
-			tstate->CurrentIndex = 0;
-			FreeThreadState(tstate);
+			tstate->Capture   = false;
+			tstate->Aggregate = false;
 		}
+		g_State.ThreadsMutex.unlock();
+		FlushThreads();
+		FreeThreadState(GetThreadState());
+		StopStreaming();
+		StopCollector();
+		FreeUnwindTables();
+		Detail::FreeInstrumentExclusions();
 		FreeTLS();
 	}
 
 	void WantCapturing(bool capture, bool instant)
 	{
+		// Modules loaded while not capturing get their load recorded before the first event that could reference them.
+		if (capture && !g_State.WantCapturing && g_State.Initialized)
+			UpdateModules();
 		if (instant)
 		{
+			// A new capture may be written to another file, stacks interned before it have to be stored again.
+			if (capture && !g_State.Capturing)
+				++g_State.CallstackGeneration;
 			g_State.WantCapturing = capture;
 			g_State.Capturing     = capture;
 			bool canCapture       = g_State.Initialized && g_State.Capturing;
+			if (g_State.Initialized)
+				RecordClockSample(true);
+			g_State.ThreadsMutex.lock();
 			for (auto tstate : g_State.Threads)
 				tstate->Capture = canCapture;
+			g_State.ThreadsMutex.unlock();
 			if (!canCapture)
-			{
-				for (auto tstate : g_State.Threads)
-				{
-					g_State.pushEvents(tstate->Buffer, tstate->CurrentIndex, tstate->ThreadID);
-					tstate->CurrentIndex = 0;
-				}
-			}
+				FlushThreads();
 		}
 		else
 		{
@@ -142,157 +307,133 @@ namespace Profiler
 		}
 	}
 
-	static void WriteEvent(Event* event)
+	void FlushThreads()
 	{
-		switch (event->Type)
-		{
-		case EEventType::ThreadBounds:
-		{
-			ThreadBoundsEvent* data = reinterpret_cast<ThreadBoundsEvent*>(event);
-			std::cout << fmt::format("Thread Bounds {}, length: {}\n", data->ThreadID, data->Length);
-			break;
-		}
-		case EEventType::ThreadBegin:
-		{
-			ThreadBeginEvent* data = reinterpret_cast<ThreadBeginEvent*>(event);
-			std::cout << fmt::format("Thread Begin, time: {}, type: {}\n", static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
-		}
-		case EEventType::ThreadEnd:
-		{
-			ThreadEndEvent* data = reinterpret_cast<ThreadEndEvent*>(event);
-			std::cout << fmt::format("Thread End, time: {}, type: {}\n", static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
-		}
-		case EEventType::Frame:
-		{
-			FrameEvent* data = reinterpret_cast<FrameEvent*>(event);
-			std::cout << fmt::format("Frame {}, time: {}, type: {}\n", data->FrameNum, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
-		}
-		case EEventType::FunctionBegin:
+		// Other threads publish their own buffers, swapping a buffer under its owner would race with its events.
+		ThreadState* self = GetThreadState();
+		g_State.ThreadsMutex.lock();
+		for (auto tstate : g_State.Threads)
 		{
-			FunctionBeginEvent* data = reinterpret_cast<FunctionBeginEvent*>(event);
-			std::cout << fmt::format("Function Begin {}, time: {}, type: {}\n", data->FunctionPtr, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
+			if (tstate != self)
+				RequestFlush(tstate);
 		}
-		case EEventType::FunctionEnd:
+		g_State.ThreadsMutex.unlock();
+		if (self->Chain)
+			FlushEvents(self);
+
+		// The lock is retaken for every check, threads that end meanwhile flush in ThreadEnd and leave the list.
+		std::uint64_t start = MonotonicNanoseconds();
+		while (true)
 		{
-			FunctionEndEvent* data = reinterpret_cast<FunctionEndEvent*>(event);
-			std::cout << fmt::format("Function End, time: {}, type: {}\n", static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
+			bool pending = false;
+			g_State.ThreadsMutex.lock();
+			for (auto tstate : g_State.Threads)
+				pending |= tstate->FlushRequested.load(std::memory_order_acquire);
+			g_State.ThreadsMutex.unlock();
+			if (!pending || MonotonicNanoseconds() - start >= c_FlushTimeout)
+				break;
+			std::this_thread::yield();
 		}
-		case EEventType::BoolArgument:
+	}
+
+	void EventChain::seal()
+	{
+		if (m_Current && m_Current->Count)
 		{
-			BoolArgumentEvent* data = reinterpret_cast<BoolArgumentEvent*>(event);
-			std::cout << fmt::format("    Argument {} = {}\n", data->Offset, data->Value);
-			break;
+			publish(m_Current);
+			m_Current = nullptr;
 		}
-		case EEventType::IntArgument:
-		{
-			IntArgumentEvent* data = reinterpret_cast<IntArgumentEvent*>(event);
-			switch (data->Size)
-			{
-			case 1:
-				std::cout << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0] & 0xFF);
-				break;
-			case 2:
-				std::cout << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0] & 0xFFFF);
-				break;
-			case 4:
-				std::cout << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0] & 0xFFFF'FFFF);
-				break;
-			case 8:
-				std::cout << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0] & 0xFFFF'FFFF'FFFF'FFFF);
-				break;
-			}
-			break;
-		}
-		case EEventType::FloatArgument:
+	}
+
+	void EventChain::store(EventBlock* block)
+	{
+		for (std::size_t i = 0; i < block->Count; ++i)
 		{
-			FloatArgumentEvent* data = reinterpret_cast<FloatArgumentEvent*>(event);
-			switch (data->Size)
-			{
-			case 4:
+			if (m_Current && c_EncodedBlockSize - m_Current->Size < c_MaxEncodedEventSize)
+				seal();
+			if (!m_Current)
 			{
-				float v;
-				std::memcpy(&v, data->Data, sizeof(v));
-				std::cout << fmt::format("    Argument {} = {}\n", data->Offset, v);
-				break;
+				m_Current           = g_State.EncodedBlocks.acquire();
+				m_Current->ThreadID = block->ThreadID;
+				m_Current->Size     = 0;
+				m_Current->Count    = 0;
+				m_Encoder.beginBlock();
 			}
-			case 8:
+			std::size_t size = m_Encoder.encode(block->Events[i], m_Current->Data + m_Current->Size);
+			if (size)
 			{
-				double v;
-				std::memcpy(&v, data->Data, sizeof(v));
-				std::cout << fmt::format("    Argument {} = {}\n", data->Offset, v);
-				break;
+				m_Current->Size += static_cast<std::uint32_t>(size);
+				++m_Current->Count;
 			}
-			}
-			break;
-		}
-		case EEventType::FlagsArgument:
-		{
-			FlagsArgumentEvent* data = reinterpret_cast<FlagsArgumentEvent*>(event);
-			std::cout << fmt::format("    Argument {} = {}\n", data->Offset, data->Data[0]);
-			break;
-		}
-		case EEventType::PtrArgument:
-		{
-			PtrArgumentEvent* data = reinterpret_cast<PtrArgumentEvent*>(event);
-			std::cout << fmt::format("    Argument {} = {}\n", data->Offset, data->Ptr);
-			break;
 		}
-		case EEventType::ForLoopBegin:
-		{
-			ForLoopBeginEvent* data = reinterpret_cast<ForLoopBeginEvent*>(event);
-			std::cout << fmt::format("For Loop Begin, id: {}, time: {}, type: {}\n", data->ID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
-		}
-		case EEventType::ForLoopEnd:
-		{
-			ForLoopEndEvent* data = reinterpret_cast<ForLoopEndEvent*>(event);
-			std::cout << fmt::format("For Loop End, id: {}, time: {}, type: {}\n", data->ID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
-		}
-		case EEventType::ForLoopIterBegin:
+		if (block->Seal)
+			seal();
+		g_State.Blocks.release(block);
+	}
+
+	void PublishEvents(ThreadState* state, std::size_t count, bool seal)
+	{
+		// Flushes take the buffered samples along, full blocks move them into the next block instead.
+		if (seal && state->Sampler)
 		{
-			ForLoopIterBeginEvent* data = reinterpret_cast<ForLoopIterBeginEvent*>(event);
-			std::cout << fmt::format("For Loop Iter Begin {}, id: {}, time: {}, type: {}\n", data->Index[0], data->ID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
+			Detail::DrainSamples(state);
+			count = state->CurrentIndex;
 		}
-		case EEventType::ForLoopIterEnd:
+
+		if (g_State.Streaming.load(std::memory_order_relaxed) && g_State.pendingMemoryUsage() > g_State.StreamingHighWaterMark)
 		{
-			ForLoopIterEndEvent* data = reinterpret_cast<ForLoopIterEndEvent*>(event);
-			std::cout << fmt::format("For Loop Iter End, id: {}, time: {}, type: {}\n", data->ID, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
+			if (g_State.StreamingPolicy == EStreamingPolicy::Block)
+			{
+				while (g_State.Streaming.load(std::memory_order_relaxed) && g_State.pendingMemoryUsage() > g_State.StreamingHighWaterMark)
+					std::this_thread::yield();
+			}
+			else if (!state->BufferInData && !state->DataSlots) // Cutting a data record would have its rest read as events
+			{
+				g_State.DroppedBlocks.fetch_add(1, std::memory_order_relaxed);
+				g_State.DroppedEvents.fetch_add(count, std::memory_order_relaxed);
+				g_State.CallstackGeneration.fetch_add(1, std::memory_order_relaxed); // The block may have held interned stacks
+				state->CurrentIndex = 0;
+				if (seal)
+					state->FlushRequested.store(false, std::memory_order_release);
+				return;
+			}
 		}
-		case EEventType::MemAlloc:
+
+		EventBlock* block   = state->Buffer;
+		block->Chain        = state->Chain;
+		block->ThreadID     = state->ThreadID;
+		block->Count        = count;
+		block->Seal         = seal;
+		state->Buffer       = g_State.Blocks.acquire();
+		state->CurrentIndex = 0;
+		state->BufferInData = state->DataSlots != 0;
+		g_State.PendingCount.fetch_add(1, std::memory_order_seq_cst);
+		if (g_State.UseCollector.load(std::memory_order_seq_cst))
 		{
-			MemAllocEvent* data = reinterpret_cast<MemAllocEvent*>(event);
-			std::cout << fmt::format("Mem Alloc {}, size: {}, time: {}, type: {}\n", data->Memory, data->Size, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
+			g_State.PendingBlocks.push(block);
 		}
-		case EEventType::MemFree:
+		else
 		{
-			MemFreeEvent* data = reinterpret_cast<MemFreeEvent*>(event);
-			std::cout << fmt::format("Mem Free {}, time: {}, type: {}\n", data->Memory, static_cast<std::uint64_t>(data->Timestamp.Time), data->Timestamp.Type ? "HR" : "LR");
-			break;
-		}
-		default:
-			break;
+			// Earlier blocks of this chain may still be queued, the collector stores those first.
+			g_State.PendingCount.fetch_sub(1, std::memory_order_relaxed);
+			while (g_State.CollectorDraining.load(std::memory_order_acquire))
+				std::this_thread::yield();
+			block->Chain->store(block);
 		}
-	}
 
-	void WriteCaptures()
-	{
-		for (auto event : g_State.Events)
-			WriteEvent(&event);
+		// Cleared once the block is queued or stored, a thread waiting in FlushThreads then finds it published.
+		if (seal)
+			state->FlushRequested.store(false, std::memory_order_release);
+		else if (state->Sampler)
+			Detail::DrainSamples(state);
 	}
 
 	std::uint64_t GetThreadID()
 	{
 #if BUILD_IS_SYSTEM_WINDOWS
 		return GetThreadId(GetCurrentThread());
+#elif BUILD_IS_SYSTEM_LINUX
+		return static_cast<std::uint64_t>(syscall(SYS_gettid));
 #else
 		return 0;
 #endif
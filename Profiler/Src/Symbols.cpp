@@ -0,0 +1,546 @@
+#include "Profiler/Dwarf.h"
+#include "Profiler/Elf.h"
+#include "Profiler/Encoding.h"
+#include "Profiler/Events.h"
+#include "Profiler/Symbols.h"
+#include "Profiler/Utils/WorkStealingPool.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+
+#if BUILD_IS_SYSTEM_LINUX
+	#include <cxxabi.h>
+	#include <unistd.h>
+#endif
+
+namespace Profiler
+{
+	// Symbols of one module file sorted by their link time address, names are packed into one string.
+	struct ModuleSymbols
+	{
+	public:
+		struct Entry
+		{
+		public:
+			std::uint64_t Address;
+			std::uint64_t Size;
+			std::uint32_t NameOffset;
+			std::uint32_t NameSize;
+		};
+
+		const Entry* find(std::uint64_t address) const
+		{
+			auto itr = std::upper_bound(Entries.begin(), Entries.end(), address, [](std::uint64_t value, const Entry& entry) { return value < entry.Address; });
+			if (itr == Entries.begin())
+				return nullptr;
+			const Entry& entry = *(itr - 1);
+			if (entry.Size && address >= entry.Address + entry.Size)
+				return nullptr;
+			return &entry;
+		}
+
+		std::string_view name(const Entry& entry) const { return std::string_view { Names }.substr(entry.NameOffset, entry.NameSize); }
+
+	public:
+		std::vector<Entry> Entries;
+		std::string        Names;
+	};
+
+#if BUILD_IS_SYSTEM_LINUX
+	static constexpr char          c_SymbolCacheMagic[8] = { 'P', 'R', 'O', 'F', 'S', 'Y', 'M', '\0' };
+	static constexpr std::uint32_t c_SymbolCacheVersion  = 1;
+
+	struct SymbolCacheHeader
+	{
+	public:
+		char          Magic[8];
+		std::uint32_t Version;
+		std::uint32_t Pad;
+		std::uint64_t Count;
+		std::uint64_t NamesSize;
+	};
+
+	// Adds the defined function symbols of .symtab and .dynsym, duplicates are removed by the caller.
+	static void ReadElfSymbols(const ElfFile& elf, std::vector<ModuleSymbols::Entry>& entries, std::string& names)
+	{
+		const Elf64_Shdr* sections = elf.sectionHeaders();
+		std::size_t       count    = elf.sectionHeaderCount();
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			const Elf64_Shdr& section = sections[i];
+			if ((section.sh_type != SHT_SYMTAB && section.sh_type != SHT_DYNSYM) || section.sh_link >= count || section.sh_entsize != sizeof(Elf64_Sym))
+				continue;
+			const Elf64_Shdr& strings    = sections[section.sh_link];
+			const Elf64_Sym*  symbols    = elf.at<Elf64_Sym>(section.sh_offset, section.sh_size / sizeof(Elf64_Sym));
+			const char*       stringData = elf.at<char>(strings.sh_offset, strings.sh_size);
+			if (!symbols || !stringData)
+				continue;
+
+			for (std::size_t j = 0; j < section.sh_size / sizeof(Elf64_Sym); ++j)
+			{
+				const Elf64_Sym& symbol = symbols[j];
+				std::uint8_t     type   = ELF64_ST_TYPE(symbol.st_info);
+				if ((type != STT_FUNC && type != STT_GNU_IFUNC) || symbol.st_shndx == SHN_UNDEF || !symbol.st_value || symbol.st_name >= strings.sh_size)
+					continue;
+
+				const char* name   = stringData + symbol.st_name;
+				std::size_t length = strnlen(name, strings.sh_size - symbol.st_name);
+				std::string demangled { name, length };
+				if (length > 2 && name[0] == '_' && name[1] == 'Z')
+				{
+					int   status = 0;
+					char* result = abi::__cxa_demangle(demangled.c_str(), nullptr, nullptr, &status);
+					if (result && status == 0)
+						demangled = result;
+					std::free(result);
+				}
+				entries.emplace_back(ModuleSymbols::Entry { symbol.st_value, symbol.st_size, static_cast<std::uint32_t>(names.size()), static_cast<std::uint32_t>(demangled.size()) });
+				names += demangled;
+			}
+		}
+	}
+
+	static std::filesystem::path SymbolCacheDirectory()
+	{
+		if (const char* directory = std::getenv("PROFILER_SYMBOL_CACHE"))
+			return directory;
+		if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache && *cache)
+			return std::filesystem::path { cache } / "profiler" / "symbols";
+		if (const char* home = std::getenv("HOME"); home && *home)
+			return std::filesystem::path { home } / ".cache" / "profiler" / "symbols";
+		return {};
+	}
+
+	static bool LoadSymbolCache(const std::filesystem::path& filepath, ModuleSymbols& symbols)
+	{
+		std::FILE* file = std::fopen(filepath.c_str(), "rb");
+		if (!file)
+			return false;
+
+		SymbolCacheHeader header {};
+		bool              result = std::fread(&header, sizeof(header), 1, file) == 1 &&
+						std::memcmp(header.Magic, c_SymbolCacheMagic, sizeof(c_SymbolCacheMagic)) == 0 &&
+						header.Version == c_SymbolCacheVersion &&
+						header.Count < (1ULL << 32) && header.NamesSize < (1ULL << 32);
+		if (result)
+		{
+			symbols.Entries.resize(header.Count);
+			symbols.Names.resize(header.NamesSize);
+			result = std::fread(symbols.Entries.data(), sizeof(ModuleSymbols::Entry), header.Count, file) == header.Count &&
+					 std::fread(symbols.Names.data(), 1, header.NamesSize, file) == header.NamesSize;
+		}
+		std::fclose(file);
+		return result;
+	}
+
+	// Written to a temporary file and renamed, so processes resolving concurrently never read a partial cache.
+	static void StoreSymbolCache(const std::filesystem::path& filepath, const ModuleSymbols& symbols)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(filepath.parent_path(), error);
+		std::filesystem::path temporary = filepath;
+		temporary += ".tmp" + std::to_string(getpid());
+
+		std::FILE* file = std::fopen(temporary.c_str(), "wb");
+		if (!file)
+			return;
+		SymbolCacheHeader header {};
+		std::memcpy(header.Magic, c_SymbolCacheMagic, sizeof(c_SymbolCacheMagic));
+		header.Version   = c_SymbolCacheVersion;
+		header.Count     = symbols.Entries.size();
+		header.NamesSize = symbols.Names.size();
+		bool result      = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+					  std::fwrite(symbols.Entries.data(), sizeof(ModuleSymbols::Entry), symbols.Entries.size(), file) == symbols.Entries.size() &&
+					  std::fwrite(symbols.Names.data(), 1, symbols.Names.size(), file) == symbols.Names.size();
+		result = std::fclose(file) == 0 && result;
+		if (result)
+			std::filesystem::rename(temporary, filepath, error);
+		if (!result || error)
+			std::filesystem::remove(temporary, error);
+	}
+
+	static bool HasBuildID(const std::filesystem::path& path, const std::string& buildID)
+	{
+		std::error_code error;
+		if (!std::filesystem::is_regular_file(path, error))
+			return false;
+		ElfFile elf(path.string());
+		return elf.valid() && (buildID.empty() || elf.buildID() == buildID);
+	}
+
+	// Separate debug file of a build ID in the search paths or /usr/lib/debug, empty if there is none.
+	static std::string DebugFilePath(const std::string& buildID, const std::vector<std::filesystem::path>& searchPaths)
+	{
+		if (buildID.size() <= 2)
+			return {};
+		for (auto& directory : searchPaths)
+		{
+			for (auto path : { directory / (buildID + ".debug"), directory / ".build-id" / buildID.substr(0, 2) / (buildID.substr(2) + ".debug") })
+			{
+				if (HasBuildID(path, buildID))
+					return path.string();
+			}
+		}
+		std::string path = ElfDebugFilePath(buildID);
+		return HasBuildID(path, buildID) ? path : std::string {};
+	}
+
+	// File to read a module from, its recorded path unless that file was rebuilt or the capture came from another machine.
+	static std::string ModuleFilePath(const LoadedModule& module, const std::vector<std::filesystem::path>& searchPaths)
+	{
+		if (HasBuildID(module.Path, module.BuildID))
+			return module.Path;
+		std::filesystem::path filename = std::filesystem::path { module.Path }.filename();
+		for (auto& directory : searchPaths)
+		{
+			if (!filename.empty() && HasBuildID(directory / filename, module.BuildID))
+				return (directory / filename).string();
+		}
+		// Without a build ID there is nothing to tell a debug file belongs to the module.
+		return module.BuildID.empty() ? std::string {} : DebugFilePath(module.BuildID, searchPaths);
+	}
+
+	static std::unordered_map<std::string, std::shared_ptr<const ModuleSymbols>> s_SymbolTables;
+	static std::mutex                                                            s_SymbolTablesMutex;
+
+	// Stripped files keep their full symbol table in a separate debug file named after the build ID.
+	static void ReadModuleSymbols(const ElfFile& elf, const std::string& buildID, const std::vector<std::filesystem::path>& searchPaths, ModuleSymbols& symbols)
+	{
+		ReadElfSymbols(elf, symbols.Entries, symbols.Names);
+		if (!elf.hasSection(SHT_SYMTAB) && !buildID.empty())
+		{
+			ElfFile debug(DebugFilePath(buildID, searchPaths));
+			if (debug.valid())
+				ReadElfSymbols(debug, symbols.Entries, symbols.Names);
+		}
+
+		// Prefer the sized entry where aliases share an address.
+		std::stable_sort(symbols.Entries.begin(), symbols.Entries.end(), [](const ModuleSymbols::Entry& lhs, const ModuleSymbols::Entry& rhs) { return lhs.Address < rhs.Address || (lhs.Address == rhs.Address && lhs.Size > rhs.Size); });
+		symbols.Entries.erase(std::unique(symbols.Entries.begin(), symbols.Entries.end(), [](const ModuleSymbols::Entry& lhs, const ModuleSymbols::Entry& rhs) { return lhs.Address == rhs.Address; }), symbols.Entries.end());
+	}
+
+	static std::shared_ptr<const ModuleSymbols> LoadModuleSymbols(const std::string& path, const ElfFile& elf, const std::vector<std::filesystem::path>& searchPaths)
+	{
+		std::string buildID = elf.buildID();
+		std::string key     = buildID.empty() ? path : buildID;
+		{
+			std::lock_guard lock(s_SymbolTablesMutex);
+			auto            itr = s_SymbolTables.find(key);
+			if (itr != s_SymbolTables.end())
+				return itr->second;
+		}
+
+		auto                  symbols   = std::make_shared<ModuleSymbols>();
+		std::filesystem::path directory = buildID.empty() ? std::filesystem::path {} : SymbolCacheDirectory();
+		std::filesystem::path cachePath = directory.empty() ? directory : directory / (buildID + ".sym");
+		if (cachePath.empty() || !LoadSymbolCache(cachePath, *symbols))
+		{
+			symbols->Entries.clear();
+			symbols->Names.clear();
+			ReadModuleSymbols(elf, buildID, searchPaths, *symbols);
+			if (!cachePath.empty())
+				StoreSymbolCache(cachePath, *symbols);
+		}
+
+		std::lock_guard lock(s_SymbolTablesMutex);
+		return s_SymbolTables.emplace(key, std::move(symbols)).first->second;
+	}
+
+	struct ModuleBatch
+	{
+	public:
+		const LoadedModule*        Module;
+		std::vector<std::uint64_t> Addresses;
+	};
+
+	static std::vector<ModuleBatch> GroupByModule(const std::vector<std::uint64_t>& sorted, const std::vector<LoadedModule>& modules)
+	{
+		std::vector<ModuleBatch> batches;
+		for (std::uint64_t address : sorted)
+		{
+			const LoadedModule* module = FindModule(modules, address);
+			if (!module)
+				continue;
+			if (batches.empty() || batches.back().Module != module)
+				batches.emplace_back(ModuleBatch { module, {} });
+			batches.back().Addresses.emplace_back(address);
+		}
+		return batches;
+	}
+
+	// Batches are resolved on a pool of one thread per batch, up to one per hardware thread.
+	static std::size_t ResolveThreadCount(std::size_t batchCount)
+	{
+		return std::clamp<std::size_t>(batchCount, 1, std::max(std::thread::hardware_concurrency(), 1U));
+	}
+
+	static void ResolveSymbolBatch(const ModuleBatch& batch, const std::vector<std::filesystem::path>& searchPaths, std::vector<ResolvedSymbol>& result)
+	{
+		std::string path = ModuleFilePath(*batch.Module, searchPaths);
+		ElfFile     elf(path);
+		if (!elf.valid())
+			return;
+		std::shared_ptr<const ModuleSymbols> symbols = LoadModuleSymbols(path, elf, searchPaths);
+
+		const ModuleSymbols::Entry* last = nullptr;
+		for (std::uint64_t address : batch.Addresses)
+		{
+			const ModuleSymbols::Entry* entry = symbols->find(address - batch.Module->Base);
+			if (!entry || entry == last)
+				continue;
+			last = entry;
+			result.emplace_back(ResolvedSymbol { entry->Address + batch.Module->Base, entry->Size, std::string { symbols->name(*entry) } });
+		}
+	}
+
+	static std::unordered_map<std::string, std::shared_ptr<const DwarfIndex>> s_DwarfIndices;
+	static std::mutex                                                         s_DwarfIndicesMutex;
+
+	// Built once per module file, a module without DWARF gets an empty index so it is not read again.
+	static std::shared_ptr<const DwarfIndex> LoadDwarfIndex(const std::string& path, const ElfFile& elf, const std::vector<std::filesystem::path>& searchPaths)
+	{
+		std::string buildID = elf.buildID();
+		std::string key     = buildID.empty() ? path : buildID;
+		{
+			std::lock_guard lock(s_DwarfIndicesMutex);
+			auto            itr = s_DwarfIndices.find(key);
+			if (itr != s_DwarfIndices.end())
+				return itr->second;
+		}
+
+		auto index = std::make_shared<DwarfIndex>();
+		if (!index->build(elf) && !buildID.empty())
+		{
+			ElfFile debug(DebugFilePath(buildID, searchPaths));
+			if (debug.valid())
+				index->build(debug);
+		}
+
+		std::lock_guard lock(s_DwarfIndicesMutex);
+		return s_DwarfIndices.emplace(key, std::move(index)).first->second;
+	}
+
+	struct LineBatchResult
+	{
+	public:
+		std::shared_ptr<const DwarfIndex> Index;
+		std::vector<SourceLocation>       Locations;
+		std::vector<DwarfFrame>           Frames;
+	};
+
+	static void ResolveLineBatch(const ModuleBatch& batch, const std::unordered_set<std::uint64_t>& returnAddresses, const std::vector<std::filesystem::path>& searchPaths, LineBatchResult& result)
+	{
+		std::string path = ModuleFilePath(*batch.Module, searchPaths);
+		ElfFile     elf(path);
+		if (!elf.valid())
+			return;
+		result.Index = LoadDwarfIndex(path, elf, searchPaths);
+
+		for (std::uint64_t address : batch.Addresses)
+		{
+			// Return addresses point past the call, the call itself is the instruction before.
+			std::uint64_t pc    = returnAddresses.contains(address) ? address - 1 : address;
+			std::size_t   first = result.Frames.size();
+			result.Index->lookup(pc - batch.Module->Base, result.Frames);
+			if (result.Frames.size() > first)
+				result.Locations.emplace_back(SourceLocation { address, static_cast<std::uint32_t>(first), static_cast<std::uint32_t>(result.Frames.size() - first) });
+		}
+	}
+#endif
+
+	void SetCaptureSymbolization(bool enabled)
+	{
+		g_State.SymbolizeCaptures = enabled;
+	}
+
+	bool IsCaptureSymbolization()
+	{
+		return g_State.SymbolizeCaptures;
+	}
+
+	std::vector<ResolvedSymbol> ResolveSymbols([[maybe_unused]] const std::vector<std::uint64_t>& addresses, [[maybe_unused]] const std::vector<LoadedModule>& modules, [[maybe_unused]] const std::vector<std::filesystem::path>& searchPaths)
+	{
+		std::vector<ResolvedSymbol> symbols;
+#if BUILD_IS_SYSTEM_LINUX
+		std::vector<std::uint64_t> sorted = addresses;
+		std::sort(sorted.begin(), sorted.end());
+		sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+		std::vector<ModuleBatch>                 batches = GroupByModule(sorted, modules);
+		std::vector<std::vector<ResolvedSymbol>> results(batches.size());
+		Utils::WorkStealingPool                  pool(ResolveThreadCount(batches.size()));
+		pool.parallelFor(batches.size(), [&](std::size_t i) { ResolveSymbolBatch(batches[i], searchPaths, results[i]); });
+
+		for (auto& result : results)
+			std::move(result.begin(), result.end(), std::back_inserter(symbols));
+		std::sort(symbols.begin(), symbols.end(), [](const ResolvedSymbol& lhs, const ResolvedSymbol& rhs) { return lhs.Address < rhs.Address; });
+		symbols.erase(std::unique(symbols.begin(), symbols.end(), [](const ResolvedSymbol& lhs, const ResolvedSymbol& rhs) { return lhs.Address == rhs.Address; }), symbols.end());
+#endif
+		return symbols;
+	}
+
+	std::vector<ResolvedSymbol> ResolveSymbols(const std::vector<std::uint64_t>& addresses)
+	{
+		UpdateModules();
+		return ResolveSymbols(addresses, ModuleSnapshot());
+	}
+
+	ResolvedLines ResolveLines([[maybe_unused]] const std::vector<std::uint64_t>& addresses, [[maybe_unused]] const std::vector<std::uint64_t>& returnAddresses, [[maybe_unused]] const std::vector<LoadedModule>& modules, [[maybe_unused]] const std::vector<std::filesystem::path>& searchPaths)
+	{
+		ResolvedLines lines;
+#if BUILD_IS_SYSTEM_LINUX
+		std::vector<std::uint64_t> sorted = addresses;
+		sorted.insert(sorted.end(), returnAddresses.begin(), returnAddresses.end());
+		std::sort(sorted.begin(), sorted.end());
+		sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+		std::unordered_set<std::uint64_t> returns { returnAddresses.begin(), returnAddresses.end() };
+
+		std::vector<ModuleBatch>     batches = GroupByModule(sorted, modules);
+		std::vector<LineBatchResult> results(batches.size());
+		Utils::WorkStealingPool      pool(ResolveThreadCount(batches.size()));
+		pool.parallelFor(batches.size(), [&](std::size_t i) { ResolveLineBatch(batches[i], returns, searchPaths, results[i]); });
+
+		// Batches are in address order, their string IDs are remapped into one table shared by all modules.
+		std::unordered_map<std::string_view, std::uint32_t> stringIDs;
+		for (auto& result : results)
+		{
+			if (!result.Index)
+				continue;
+			const std::vector<std::string>& strings = result.Index->strings();
+			std::vector<std::uint32_t>      remap(strings.size(), c_DwarfNone);
+			auto                            mapString = [&](std::uint32_t id) {
+				if (id >= strings.size())
+					return c_DwarfNone;
+				if (remap[id] == c_DwarfNone)
+				{
+					auto [itr, inserted] = stringIDs.emplace(strings[id], static_cast<std::uint32_t>(lines.Strings.size()));
+					if (inserted)
+						lines.Strings.emplace_back(strings[id]);
+					remap[id] = itr->second;
+				}
+				return remap[id];
+			};
+
+			for (auto& location : result.Locations)
+			{
+				lines.Locations.emplace_back(SourceLocation { location.Address, static_cast<std::uint32_t>(lines.Frames.size()), location.FrameCount });
+				for (std::uint32_t i = 0; i < location.FrameCount; ++i)
+				{
+					const DwarfFrame& frame = result.Frames[location.FirstFrame + i];
+					lines.Frames.emplace_back(SourceFrame { mapString(frame.Function), mapString(frame.File), frame.Line, frame.Column });
+				}
+			}
+		}
+#endif
+		return lines;
+	}
+
+	ResolvedLines ResolveLines(const std::vector<std::uint64_t>& addresses, const std::vector<std::uint64_t>& returnAddresses)
+	{
+		UpdateModules();
+		return ResolveLines(addresses, returnAddresses, ModuleSnapshot());
+	}
+
+	void SymbolAddressCollector::add(std::uint64_t address, bool returnAddress)
+	{
+		auto [itr, inserted] = m_Addresses.emplace(address, returnAddress);
+		if (!inserted && !returnAddress)
+			itr->second = false;
+	}
+
+	void SymbolAddressCollector::addStack(const PendingData& data, std::uint64_t dataID, EStackKind kind)
+	{
+		if (data.ID != dataID || data.Remaining)
+			return;
+		for (std::size_t offset = 0; offset + sizeof(std::uint64_t) <= data.Bytes.size(); offset += sizeof(std::uint64_t))
+		{
+			std::uint64_t address;
+			std::memcpy(&address, data.Bytes.data() + offset, sizeof(address));
+			if (!address)
+				continue;
+			switch (kind)
+			{
+			case EStackKind::Callstack: add(address, true); break;
+			// The first frame of a sample is the interrupted instruction.
+			case EStackKind::Sample: add(address, offset != 0); break;
+			// Zone keys of shadow stacks are not code addresses.
+			case EStackKind::ZoneKeys:
+				if (!(address >> 63))
+					add(address, false);
+				break;
+			}
+		}
+	}
+
+	void SymbolAddressCollector::collect(const EncodedBlock* block)
+	{
+		EventDecoder decoder;
+		decoder.reset(block->Data, block->Size);
+		Event      event;
+		EEventType type;
+		while (decoder.next(event, type))
+			collect(block->ThreadID, event, type);
+	}
+
+	void SymbolAddressCollector::collect(std::uint64_t threadID, const Event& event, EEventType type)
+	{
+		switch (type)
+		{
+		case EEventType::FunctionBegin:
+			add(reinterpret_cast<std::uintptr_t>(reinterpret_cast<const FunctionBeginEvent&>(event).FunctionPtr), false);
+			break;
+		case EEventType::DataHeader:
+		{
+			PendingData& data   = m_Data[threadID];
+			auto&        header = reinterpret_cast<const DataHeaderEvent&>(event);
+			data.ID             = header.ID;
+			data.Remaining      = header.Size;
+			data.Bytes.clear();
+			break;
+		}
+		case EEventType::DataSection:
+		{
+			PendingData& data = m_Data[threadID];
+			std::size_t  size = static_cast<std::size_t>(std::min<std::uint64_t>(data.Remaining, sizeof(DataSectionEvent)));
+			auto*        raw  = reinterpret_cast<const std::uint8_t*>(&event);
+			data.Bytes.insert(data.Bytes.end(), raw, raw + size);
+			data.Remaining -= size;
+			break;
+		}
+		// Interned stacks are stored right before the first event referencing them.
+		case EEventType::Callstack: addStack(m_Data[threadID], reinterpret_cast<const CallstackEvent&>(event).DataID, EStackKind::Callstack); break;
+		case EEventType::Sample: addStack(m_Data[threadID], reinterpret_cast<const SampleEvent&>(event).DataID, EStackKind::Sample); break;
+		case EEventType::ZoneSample: addStack(m_Data[threadID], reinterpret_cast<const ZoneSampleEvent&>(event).DataID, EStackKind::ZoneKeys); break;
+		default: break;
+		}
+	}
+
+	std::vector<std::uint64_t> SymbolAddressCollector::addresses() const
+	{
+		std::vector<std::uint64_t> result;
+		result.reserve(m_Addresses.size());
+		for (auto& [address, returnAddress] : m_Addresses)
+			result.emplace_back(address);
+		return result;
+	}
+
+	std::vector<std::uint64_t> SymbolAddressCollector::returnAddresses() const
+	{
+		std::vector<std::uint64_t> result;
+		for (auto& [address, returnAddress] : m_Addresses)
+		{
+			if (returnAddress)
+				result.emplace_back(address);
+		}
+		return result;
+	}
+} // namespace Profiler
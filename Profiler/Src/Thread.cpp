@@ -8,18 +8,18 @@ namespace Profiler::Detail
 		g_State.addThread(state);
 
 		auto& event = NewEvent<ThreadBeginEvent>(state);
-		CaptureLowResTimestamp(event.Timestamp);
+		CaptureLowResTimestamp<EZoneType::Thread>(event.Timestamp);
 	}
 
 	void ThreadEnd(ThreadState* state)
 	{
 		auto& event = NewEvent<ThreadEndEvent>(state);
-		CaptureLowResTimestamp(event.Timestamp);
+		CaptureLowResTimestamp<EZoneType::Thread>(event.Timestamp);
 		FlushEvents(state);
 
 		g_State.removeThread(state);
 
-		if (state->FunctionDepth)
+		if (state->FunctionDepth > state->InstrumentOpen)
 			throw std::runtime_error("Thread ended with unended functions!");
 	}
 
@@ -29,18 +29,18 @@ namespace Profiler::Detail
 		g_State.addThread(state);
 
 		auto& event = NewEvent<ThreadBeginEvent>(state);
-		CaptureHighResTimestamp(event.Timestamp);
+		CaptureHighResTimestamp<EZoneType::Thread>(event.Timestamp);
 	}
 
 	void HRThreadEnd(ThreadState* state)
 	{
 		auto& event = NewEvent<ThreadEndEvent>(state);
-		CaptureHighResTimestamp(event.Timestamp);
+		CaptureHighResTimestamp<EZoneType::Thread>(event.Timestamp);
 		FlushEvents(state);
 
 		g_State.removeThread(state);
 
-		if (state->FunctionDepth)
+		if (state->FunctionDepth > state->InstrumentOpen)
 			throw std::runtime_error("Thread ended with unended functions!");
 	}
 } // namespace Profiler::Detail
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "Profiler/Timestamp.h"
+
+#include <algorithm>
+
+namespace Profiler
+{
+	static constexpr std::size_t c_ClockMeasureReads = 1 << 16;
+
+	template <EClockSource Source>
+	static ClockSourceInfo MeasureClock()
+	{
+		ClockSourceInfo info { Source, true, 0.0, 0.0 };
+		if constexpr (Source == EClockSource::Rdtscp)
+		{
+			if (!(g_State.Abilities & Abilities::RDTSCP))
+			{
+				info.Supported = false;
+				return info;
+			}
+		}
+
+		// TSC sources report in ticks, everything else in nanoseconds.
+		double toNanoseconds = 1.0;
+		if constexpr (IsHighResClock(Source))
+		{
+			if (!g_State.InvariantClockFrequency)
+			{
+				info.Supported = false;
+				return info;
+			}
+			toNanoseconds = 1e9 / static_cast<double>(g_State.InvariantClockFrequency);
+		}
+
+		std::uint64_t minStep  = ~0ULL;
+		std::uint64_t previous = ReadClock<Source>();
+		std::uint64_t start    = MonotonicNanoseconds();
+		for (std::size_t i = 0; i < c_ClockMeasureReads; ++i)
+		{
+			std::uint64_t current = ReadClock<Source>();
+			if (current != previous)
+				minStep = std::min(minStep, current - previous);
+			previous = current;
+		}
+		std::uint64_t elapsed = MonotonicNanoseconds() - start;
+
+		// Coarse clocks may not step during the loop at all, wait for a step to find their resolution.
+		if (minStep == ~0ULL)
+		{
+			std::uint64_t first = ReadClock<Source>();
+			while ((previous = ReadClock<Source>()) == first)
+				;
+			minStep = previous - first;
+		}
+
+		info.Cost       = static_cast<double>(elapsed) / c_ClockMeasureReads;
+		info.Resolution = static_cast<double>(minStep) * toNanoseconds;
+		return info;
+	}
+
+	ClockSourceInfo MeasureClockSource(EClockSource source)
+	{
+		switch (source)
+		{
+		case EClockSource::Monotonic: return MeasureClock<EClockSource::Monotonic>();
+		case EClockSource::MonotonicCoarse: return MeasureClock<EClockSource::MonotonicCoarse>();
+		case EClockSource::Rdtsc: return MeasureClock<EClockSource::Rdtsc>();
+		case EClockSource::Rdtscp: return MeasureClock<EClockSource::Rdtscp>();
+		case EClockSource::LfenceRdtsc: return MeasureClock<EClockSource::LfenceRdtsc>();
+		}
+		return { source, false, 0.0, 0.0 };
+	}
+
+	std::vector<ClockSourceInfo> MeasureClockSources()
+	{
+		std::vector<ClockSourceInfo> infos;
+		for (auto source : { EClockSource::Monotonic, EClockSource::MonotonicCoarse, EClockSource::Rdtsc, EClockSource::Rdtscp, EClockSource::LfenceRdtsc })
+			infos.emplace_back(MeasureClockSource(source));
+		return infos;
+	}
+} // namespace Profiler
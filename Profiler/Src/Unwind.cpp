@@ -0,0 +1,689 @@
+#include "Profiler/Callstack.h"
+#include "Profiler/Unwind.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#if BUILD_IS_SYSTEM_WINDOWS
+	#include <Windows.h>
+#elif BUILD_IS_SYSTEM_UNIX
+	#include <pthread.h>
+#endif
+
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+	#include <link.h>
+#endif
+
+namespace Profiler
+{
+	enum class EUnwindRule : std::uint8_t
+	{
+		Unknown, // No usable CFI, step with the frame pointer
+		Rsp,     // CFA = rsp + CfaOffset
+		Rbp,     // CFA = rbp + CfaOffset
+		End      // Return address is undefined, outermost frame
+	};
+
+	// Where the caller's registers are relative to the CFA, RbpOffset 0 leaves rbp unchanged.
+	struct UnwindRule
+	{
+	public:
+		std::int32_t CfaOffset;
+		std::int16_t RbpOffset;
+		std::int8_t  RaOffset;
+		EUnwindRule  Rule;
+	};
+
+	// Row i covers [Starts[i], Starts[i + 1]), starts are kept apart from the rules to keep the search in cache.
+	struct UnwindTable
+	{
+	public:
+		std::vector<std::uintptr_t> Starts;
+		std::vector<UnwindRule>     Rules;
+	};
+
+	struct StackBounds
+	{
+	public:
+		std::uintptr_t Low  = 0;
+		std::uintptr_t High = 0;
+	};
+
+	static std::atomic<const UnwindTable*> s_UnwindTable = nullptr;
+	static std::vector<const UnwindTable*> s_RetiredUnwindTables;
+	static std::mutex                      s_UnwindTablesMutex;
+
+	// Zero initialized so signal handlers can read it without running a TLS constructor.
+	static thread_local StackBounds s_StackBounds;
+
+	void PrepareThreadUnwinding()
+	{
+		if (s_StackBounds.High)
+			return;
+#if BUILD_IS_SYSTEM_UNIX
+		pthread_attr_t attr;
+		if (pthread_getattr_np(pthread_self(), &attr) == 0)
+		{
+			void*       base = nullptr;
+			std::size_t size = 0;
+			if (pthread_attr_getstack(&attr, &base, &size) == 0)
+			{
+				s_StackBounds.Low  = reinterpret_cast<std::uintptr_t>(base);
+				s_StackBounds.High = s_StackBounds.Low + size;
+			}
+			pthread_attr_destroy(&attr);
+		}
+#endif
+	}
+
+	std::size_t UnwindTableSize()
+	{
+		const UnwindTable* table = s_UnwindTable.load(std::memory_order_acquire);
+		return table ? table->Starts.size() : 0;
+	}
+
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+	static constexpr std::uint8_t c_DwarfRbp = 6;
+	static constexpr std::uint8_t c_DwarfRsp = 7;
+	static constexpr std::uint8_t c_DwarfRa  = 16;
+
+	class CfiReader
+	{
+	public:
+		CfiReader(const std::uint8_t* data, const std::uint8_t* end)
+			: m_Data(data), m_End(end) {}
+
+		bool                done() const { return m_Data >= m_End; }
+		const std::uint8_t* data() const { return m_Data; }
+		void                skip(std::size_t count) { m_Data += count; }
+
+		template <class T>
+		T read()
+		{
+			T value {};
+			if (m_End - m_Data >= static_cast<std::ptrdiff_t>(sizeof(T)))
+				std::memcpy(&value, m_Data, sizeof(T));
+			m_Data += sizeof(T);
+			return value;
+		}
+
+		std::uint64_t uleb()
+		{
+			std::uint64_t value = 0;
+			std::uint32_t shift = 0;
+			while (m_Data < m_End)
+			{
+				std::uint8_t byte = *m_Data++;
+				if (shift < 64)
+					value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+				shift += 7;
+				if (!(byte & 0x80))
+					break;
+			}
+			return value;
+		}
+
+		std::int64_t sleb()
+		{
+			std::int64_t  value = 0;
+			std::uint32_t shift = 0;
+			std::uint8_t  byte  = 0;
+			while (m_Data < m_End)
+			{
+				byte = *m_Data++;
+				if (shift < 64)
+					value |= static_cast<std::int64_t>(byte & 0x7F) << shift;
+				shift += 7;
+				if (!(byte & 0x80))
+					break;
+			}
+			if (shift < 64 && (byte & 0x40))
+				value |= -(static_cast<std::int64_t>(1) << shift);
+			return value;
+		}
+
+		// Reads a DW_EH_PE encoded pointer, dataBase is the start of .eh_frame_hdr.
+		std::uintptr_t pointer(std::uint8_t encoding, std::uintptr_t dataBase = 0)
+		{
+			if (encoding == 0xFF)
+				return 0;
+
+			std::uintptr_t position = reinterpret_cast<std::uintptr_t>(m_Data);
+			std::uintptr_t value    = 0;
+			switch (encoding & 0x0F)
+			{
+			case 0x00: value = read<std::uint64_t>(); break;
+			case 0x01: value = uleb(); break;
+			case 0x02: value = read<std::uint16_t>(); break;
+			case 0x03: value = read<std::uint32_t>(); break;
+			case 0x04: value = read<std::uint64_t>(); break;
+			case 0x09: value = static_cast<std::uintptr_t>(sleb()); break;
+			case 0x0A: value = static_cast<std::uintptr_t>(static_cast<std::intptr_t>(read<std::int16_t>())); break;
+			case 0x0B: value = static_cast<std::uintptr_t>(static_cast<std::intptr_t>(read<std::int32_t>())); break;
+			case 0x0C: value = static_cast<std::uintptr_t>(read<std::int64_t>()); break;
+			default: return 0;
+			}
+			if (!value)
+				return 0;
+
+			switch (encoding & 0x70)
+			{
+			case 0x00: break;
+			case 0x10: value += position; break;
+			case 0x30: value += dataBase; break;
+			default: return 0;
+			}
+			if (encoding & 0x80)
+				std::memcpy(&value, reinterpret_cast<const void*>(value), sizeof(value));
+			return value;
+		}
+
+	private:
+		const std::uint8_t* m_Data;
+		const std::uint8_t* m_End;
+	};
+
+	struct RegisterRule
+	{
+	public:
+		enum class EKind : std::uint8_t
+		{
+			Same,
+			Undefined,
+			Offset,
+			Other
+		};
+
+		EKind        Kind   = EKind::Same;
+		std::int64_t Offset = 0;
+	};
+
+	struct CfaState
+	{
+	public:
+		std::uint64_t CfaRegister   = c_DwarfRsp;
+		std::int64_t  CfaOffset     = 8;
+		bool          CfaExpression = false;
+		RegisterRule  Rbp;
+		RegisterRule  Ra;
+	};
+
+	struct CommonInfo
+	{
+	public:
+		std::uint64_t       CodeAlign    = 1;
+		std::int64_t        DataAlign    = -8;
+		std::uint64_t       RaRegister   = c_DwarfRa;
+		std::uint8_t        FdeEncoding  = 0;
+		bool                Augmented    = false;
+		const std::uint8_t* Instructions = nullptr;
+		const std::uint8_t* End          = nullptr;
+	};
+
+	static UnwindRule CompileRule(const CfaState& state)
+	{
+		UnwindRule rule { 0, 0, 0, EUnwindRule::Unknown };
+		if (state.Ra.Kind == RegisterRule::EKind::Undefined)
+		{
+			rule.Rule = EUnwindRule::End;
+			return rule;
+		}
+		if (state.CfaExpression || (state.CfaRegister != c_DwarfRsp && state.CfaRegister != c_DwarfRbp))
+			return rule;
+		if (state.Ra.Kind != RegisterRule::EKind::Offset || state.Ra.Offset < -128 || state.Ra.Offset > 127)
+			return rule;
+		if (state.CfaOffset < INT32_MIN || state.CfaOffset > INT32_MAX)
+			return rule;
+		if (state.Rbp.Kind == RegisterRule::EKind::Offset && (state.Rbp.Offset < INT16_MIN || state.Rbp.Offset > INT16_MAX || !state.Rbp.Offset))
+			return rule;
+
+		rule.Rule      = state.CfaRegister == c_DwarfRsp ? EUnwindRule::Rsp : EUnwindRule::Rbp;
+		rule.CfaOffset = static_cast<std::int32_t>(state.CfaOffset);
+		rule.RaOffset  = static_cast<std::int8_t>(state.Ra.Offset);
+		rule.RbpOffset = state.Rbp.Kind == RegisterRule::EKind::Offset ? static_cast<std::int16_t>(state.Rbp.Offset) : 0;
+		return rule;
+	}
+
+	// Runs a CFA program, emitting a row whenever the location advances past a state change.
+	class CfaProgram
+	{
+	public:
+		CfaProgram(const CommonInfo& cie, UnwindTable& table)
+			: m_Cie(cie), m_Table(table) {}
+
+		void run(CfiReader reader, std::uintptr_t& location, std::uintptr_t end, bool emit)
+		{
+			while (!reader.done() && location < end)
+			{
+				std::uint8_t  opcode  = reader.read<std::uint8_t>();
+				std::uint8_t  operand = opcode & 0x3F;
+				std::uint64_t reg     = 0;
+				switch (opcode & 0xC0)
+				{
+				case 0x40: advance(location, operand * m_Cie.CodeAlign, emit); continue;
+				case 0x80: setRule(operand, RegisterRule { RegisterRule::EKind::Offset, static_cast<std::int64_t>(reader.uleb()) * m_Cie.DataAlign }); continue;
+				case 0xC0: restore(operand); continue;
+				}
+
+				switch (opcode)
+				{
+				case 0x00: break;
+				case 0x01: advance(location, reader.pointer(m_Cie.FdeEncoding) - location, emit); break;
+				case 0x02: advance(location, reader.read<std::uint8_t>() * m_Cie.CodeAlign, emit); break;
+				case 0x03: advance(location, reader.read<std::uint16_t>() * m_Cie.CodeAlign, emit); break;
+				case 0x04: advance(location, reader.read<std::uint32_t>() * m_Cie.CodeAlign, emit); break;
+				case 0x05:
+					reg = reader.uleb();
+					setRule(reg, RegisterRule { RegisterRule::EKind::Offset, static_cast<std::int64_t>(reader.uleb()) * m_Cie.DataAlign });
+					break;
+				case 0x06: restore(reader.uleb()); break;
+				case 0x07: setRule(reader.uleb(), RegisterRule { RegisterRule::EKind::Undefined, 0 }); break;
+				case 0x08: setRule(reader.uleb(), RegisterRule { RegisterRule::EKind::Same, 0 }); break;
+				case 0x09:
+					reg = reader.uleb();
+					reader.uleb();
+					setRule(reg, RegisterRule { RegisterRule::EKind::Other, 0 });
+					break;
+				case 0x0A: m_Remembered.emplace_back(m_State); break;
+				case 0x0B:
+					// Restores the whole row including the CFA, as GCC's epilogues expect.
+					if (!m_Remembered.empty())
+					{
+						m_State = m_Remembered.back();
+						m_Remembered.pop_back();
+					}
+					break;
+				case 0x0C:
+					m_State.CfaRegister   = reader.uleb();
+					m_State.CfaOffset     = static_cast<std::int64_t>(reader.uleb());
+					m_State.CfaExpression = false;
+					break;
+				case 0x0D:
+					m_State.CfaRegister   = reader.uleb();
+					m_State.CfaExpression = false;
+					break;
+				case 0x0E: m_State.CfaOffset = static_cast<std::int64_t>(reader.uleb()); break;
+				case 0x0F:
+					reader.skip(reader.uleb());
+					m_State.CfaExpression = true;
+					break;
+				case 0x10:
+				case 0x16:
+					reg = reader.uleb();
+					reader.skip(reader.uleb());
+					setRule(reg, RegisterRule { RegisterRule::EKind::Other, 0 });
+					break;
+				case 0x11:
+					reg = reader.uleb();
+					setRule(reg, RegisterRule { RegisterRule::EKind::Offset, reader.sleb() * m_Cie.DataAlign });
+					break;
+				case 0x12:
+					m_State.CfaRegister   = reader.uleb();
+					m_State.CfaOffset     = reader.sleb() * m_Cie.DataAlign;
+					m_State.CfaExpression = false;
+					break;
+				case 0x13: m_State.CfaOffset = reader.sleb() * m_Cie.DataAlign; break;
+				case 0x14:
+				case 0x15:
+					reg = reader.uleb();
+					opcode == 0x14 ? reader.uleb() : reader.sleb();
+					setRule(reg, RegisterRule { RegisterRule::EKind::Other, 0 });
+					break;
+				case 0x2E: reader.uleb(); break;
+				case 0x2F:
+					reg = reader.uleb();
+					setRule(reg, RegisterRule { RegisterRule::EKind::Offset, -static_cast<std::int64_t>(reader.uleb()) * m_Cie.DataAlign });
+					break;
+				default:
+					// Unknown opcodes have unknown operands, nothing after them can be trusted.
+					m_State.CfaExpression = true;
+					return;
+				}
+			}
+		}
+
+		void saveInitial() { m_Initial = m_State; }
+
+		void emitRow(std::uintptr_t location)
+		{
+			UnwindRule rule = CompileRule(m_State);
+			if (!m_Table.Starts.empty() && m_Table.Starts.back() == location)
+			{
+				m_Table.Rules.back() = rule;
+				return;
+			}
+			if (!m_FirstRow && std::memcmp(&m_Table.Rules.back(), &rule, sizeof(rule)) == 0)
+				return;
+			m_Table.Starts.emplace_back(location);
+			m_Table.Rules.emplace_back(rule);
+			m_FirstRow = false;
+		}
+
+	private:
+		void advance(std::uintptr_t& location, std::uintptr_t delta, bool emit)
+		{
+			if (emit)
+				emitRow(location);
+			location += delta;
+		}
+
+		void setRule(std::uint64_t reg, RegisterRule rule)
+		{
+			if (reg == c_DwarfRbp)
+				m_State.Rbp = rule;
+			else if (reg == m_Cie.RaRegister)
+				m_State.Ra = rule;
+		}
+
+		void restore(std::uint64_t reg)
+		{
+			if (reg == c_DwarfRbp)
+				m_State.Rbp = m_Initial.Rbp;
+			else if (reg == m_Cie.RaRegister)
+				m_State.Ra = m_Initial.Ra;
+		}
+
+	private:
+		const CommonInfo&     m_Cie;
+		UnwindTable&          m_Table;
+		CfaState              m_State;
+		CfaState              m_Initial;
+		std::vector<CfaState> m_Remembered;
+		bool                  m_FirstRow = true;
+	};
+
+	class EhFrameParser
+	{
+	public:
+		EhFrameParser(UnwindTable& table)
+			: m_Table(table) {}
+
+		// Returns false if the entry is not an FDE.
+		bool parseFde(const std::uint8_t* entry)
+		{
+			CfiReader     reader(entry, entry + 12);
+			std::uint64_t length = reader.read<std::uint32_t>();
+			if (!length || length == 0xFFFF'FFFF)
+				return false;
+			const std::uint8_t* end   = reader.data() + length;
+			const std::uint8_t* idPos = reader.data();
+			reader                    = CfiReader(idPos, end);
+			std::uint32_t cieOffset   = reader.read<std::uint32_t>();
+			if (!cieOffset)
+				return false;
+
+			const CommonInfo* cie = parseCie(idPos - cieOffset);
+			if (!cie)
+				return false;
+
+			std::uintptr_t begin = reader.pointer(cie->FdeEncoding);
+			std::uintptr_t range = reader.pointer(cie->FdeEncoding & 0x0F);
+			if (!begin || !range)
+				return true;
+			if (cie->Augmented)
+				reader.skip(reader.uleb());
+
+			CfaProgram     program(*cie, m_Table);
+			std::uintptr_t location = begin;
+			program.run(CfiReader(cie->Instructions, cie->End), location, ~std::uintptr_t { 0 }, false);
+			program.saveInitial();
+			location = begin;
+			program.run(reader, location, begin + range, true);
+			if (location < begin + range)
+				program.emitRow(location);
+
+			// Marks the end of the function, a following function overwrites it if it starts right here.
+			m_Table.Starts.emplace_back(begin + range);
+			m_Table.Rules.emplace_back(UnwindRule { 0, 0, 0, EUnwindRule::Unknown });
+			return true;
+		}
+
+		// Walks .eh_frame up to its zero terminator, used when .eh_frame_hdr has no usable search table.
+		void parseAll(const std::uint8_t* ehFrame)
+		{
+			const std::uint8_t* entry = ehFrame;
+			while (true)
+			{
+				std::uint32_t length;
+				std::memcpy(&length, entry, sizeof(length));
+				if (!length || length == 0xFFFF'FFFF)
+					break;
+				parseFde(entry);
+				entry += 4 + length;
+			}
+		}
+
+	private:
+		const CommonInfo* parseCie(const std::uint8_t* entry)
+		{
+			auto itr = m_Cies.find(entry);
+			if (itr != m_Cies.end())
+				return itr->second.Instructions ? &itr->second : nullptr;
+
+			CommonInfo&   cie    = m_Cies[entry];
+			CfiReader     reader(entry, entry + 8);
+			std::uint64_t length = reader.read<std::uint32_t>();
+			if (!length || length == 0xFFFF'FFFF)
+				return nullptr;
+			const std::uint8_t* end = reader.data() + length;
+			reader                  = CfiReader(reader.data(), end);
+			if (reader.read<std::uint32_t>() != 0)
+				return nullptr;
+
+			std::uint8_t version      = reader.read<std::uint8_t>();
+			const char*  augmentation = reinterpret_cast<const char*>(reader.data());
+			reader.skip(std::strlen(augmentation) + 1);
+			if (augmentation[0] && augmentation[0] != 'z')
+				return nullptr;
+
+			cie.CodeAlign  = reader.uleb();
+			cie.DataAlign  = reader.sleb();
+			cie.RaRegister = version == 1 ? reader.read<std::uint8_t>() : reader.uleb();
+			if (augmentation[0] == 'z')
+			{
+				cie.Augmented                      = true;
+				std::uint64_t       augmentSize    = reader.uleb();
+				const std::uint8_t* augmentEnd     = reader.data() + augmentSize;
+				for (const char* c = augmentation + 1; *c; ++c)
+				{
+					switch (*c)
+					{
+					case 'R': cie.FdeEncoding = reader.read<std::uint8_t>(); break;
+					case 'P': reader.pointer(reader.read<std::uint8_t>() & 0x7F); break;
+					case 'L': reader.read<std::uint8_t>(); break;
+					default: break;
+					}
+				}
+				reader = CfiReader(augmentEnd, end);
+			}
+			cie.Instructions = reader.data();
+			cie.End          = end;
+			return &cie;
+		}
+
+	private:
+		UnwindTable&                                            m_Table;
+		std::unordered_map<const std::uint8_t*, CommonInfo> m_Cies;
+	};
+
+	static void LoadModule(UnwindTable& table, std::uintptr_t hdrAddress)
+	{
+		const std::uint8_t* hdr = reinterpret_cast<const std::uint8_t*>(hdrAddress);
+		if (hdr[0] != 1)
+			return;
+
+		std::uint8_t   frameEncoding = hdr[1];
+		std::uint8_t   countEncoding = hdr[2];
+		std::uint8_t   tableEncoding = hdr[3];
+		CfiReader      reader(hdr + 4, hdr + 64);
+		std::uintptr_t ehFrame = reader.pointer(frameEncoding, hdrAddress);
+		if (!ehFrame)
+			return;
+
+		EhFrameParser parser(table);
+		if (tableEncoding != 0x3B || countEncoding == 0xFF)
+		{
+			parser.parseAll(reinterpret_cast<const std::uint8_t*>(ehFrame));
+			return;
+		}
+
+		std::uintptr_t      count   = reader.pointer(countEncoding, hdrAddress);
+		const std::uint8_t* entries = reader.data();
+		for (std::uintptr_t i = 0; i < count; ++i)
+		{
+			std::int32_t fdeOffset;
+			std::memcpy(&fdeOffset, entries + i * 8 + 4, sizeof(fdeOffset));
+			parser.parseFde(reinterpret_cast<const std::uint8_t*>(hdrAddress + fdeOffset));
+		}
+	}
+
+	static int LoadModuleCallback(dl_phdr_info* info, [[maybe_unused]] std::size_t size, void* userData)
+	{
+		for (ElfW(Half) i = 0; i < info->dlpi_phnum; ++i)
+		{
+			if (info->dlpi_phdr[i].p_type == PT_GNU_EH_FRAME)
+				LoadModule(*static_cast<UnwindTable*>(userData), info->dlpi_addr + info->dlpi_phdr[i].p_vaddr);
+		}
+		return 0;
+	}
+
+	void LoadUnwindTables()
+	{
+		UnwindTable* table = new UnwindTable();
+		dl_iterate_phdr(&LoadModuleCallback, table);
+
+		// Sort the rows, where an end marker and a function start share an address the function wins.
+		std::vector<std::uint32_t> order(table->Starts.size());
+		for (std::uint32_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [table](std::uint32_t lhs, std::uint32_t rhs) { return table->Starts[lhs] < table->Starts[rhs]; });
+
+		UnwindTable* sorted = new UnwindTable();
+		sorted->Starts.reserve(order.size());
+		sorted->Rules.reserve(order.size());
+		for (std::uint32_t index : order)
+		{
+			std::uintptr_t start = table->Starts[index];
+			UnwindRule     rule  = table->Rules[index];
+			if (!sorted->Starts.empty() && sorted->Starts.back() == start)
+			{
+				if (rule.Rule != EUnwindRule::Unknown)
+					sorted->Rules.back() = rule;
+				continue;
+			}
+			sorted->Starts.emplace_back(start);
+			sorted->Rules.emplace_back(rule);
+		}
+		delete table;
+
+		std::lock_guard lock(s_UnwindTablesMutex);
+		if (const UnwindTable* previous = s_UnwindTable.exchange(sorted, std::memory_order_acq_rel))
+			s_RetiredUnwindTables.emplace_back(previous);
+	}
+
+	static const UnwindRule* FindRule(const UnwindTable* table, std::uintptr_t pc)
+	{
+		auto itr = std::upper_bound(table->Starts.begin(), table->Starts.end(), pc);
+		if (itr == table->Starts.begin())
+			return nullptr;
+		return &table->Rules[(itr - table->Starts.begin()) - 1];
+	}
+
+	static bool ReadStack(const StackBounds& bounds, std::uintptr_t address, std::uintptr_t& value)
+	{
+		if (address < bounds.Low || address > bounds.High - sizeof(std::uintptr_t) || (address & (sizeof(std::uintptr_t) - 1)))
+			return false;
+		value = *reinterpret_cast<const std::uintptr_t*>(address);
+		return true;
+	}
+
+	static std::size_t Unwind(UnwindContext context, void** frames, std::size_t maxFrames, std::size_t skip, bool returnAddress)
+	{
+		const StackBounds& bounds = s_StackBounds;
+		if (!bounds.High)
+			return 0;
+
+		const UnwindTable* table = s_UnwindTable.load(std::memory_order_acquire);
+		std::size_t        count = 0;
+		while (count < maxFrames && context.PC)
+		{
+			if (skip)
+				--skip;
+			else
+				frames[count++] = reinterpret_cast<void*>(context.PC);
+
+			// Return addresses point past the call, which may already be the next function.
+			const UnwindRule* rule = table ? FindRule(table, returnAddress ? context.PC - 1 : context.PC) : nullptr;
+			returnAddress          = true;
+			if (rule && rule->Rule == EUnwindRule::End)
+				break;
+
+			std::uintptr_t cfa, pc, fp = context.FP;
+			if (rule && rule->Rule != EUnwindRule::Unknown)
+			{
+				cfa = (rule->Rule == EUnwindRule::Rsp ? context.SP : context.FP) + rule->CfaOffset;
+				if (!ReadStack(bounds, cfa + rule->RaOffset, pc))
+					break;
+				if (rule->RbpOffset && !ReadStack(bounds, cfa + rule->RbpOffset, fp))
+					break;
+			}
+			else
+			{
+				cfa = context.FP + 2 * sizeof(std::uintptr_t);
+				if (context.FP < context.SP || !ReadStack(bounds, context.FP, fp) || !ReadStack(bounds, context.FP + sizeof(std::uintptr_t), pc))
+					break;
+			}
+			if (cfa <= context.SP)
+				break;
+			context = { pc, cfa, fp };
+		}
+		return count;
+	}
+#else
+	void LoadUnwindTables()
+	{
+	}
+#endif
+
+	void FreeUnwindTables()
+	{
+		std::lock_guard lock(s_UnwindTablesMutex);
+		if (const UnwindTable* table = s_UnwindTable.exchange(nullptr, std::memory_order_acq_rel))
+			s_RetiredUnwindTables.emplace_back(table);
+		for (auto table : s_RetiredUnwindTables)
+			delete table;
+		s_RetiredUnwindTables.clear();
+	}
+
+	std::size_t UnwindCallstack([[maybe_unused]] const UnwindContext& context, [[maybe_unused]] void** frames, [[maybe_unused]] std::size_t maxFrames)
+	{
+#if BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+		return Unwind(context, frames, maxFrames, 0, false);
+#else
+		return 0;
+#endif
+	}
+
+	std::size_t UnwindCallstack(void** frames, std::size_t maxFrames, std::size_t skip)
+	{
+#if BUILD_IS_SYSTEM_WINDOWS
+		return RtlCaptureStackBackTrace(static_cast<DWORD>(skip + 1), static_cast<DWORD>(maxFrames), frames, nullptr);
+#elif BUILD_IS_SYSTEM_LINUX && BUILD_IS_PLATFORM_AMD64
+		PrepareThreadUnwinding();
+		// Using the frame address gives this function a frame, so the caller's registers are at known offsets.
+		std::uintptr_t fp = reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0));
+		UnwindContext  context;
+		context.PC = reinterpret_cast<std::uintptr_t>(__builtin_return_address(0));
+		context.SP = fp + 2 * sizeof(std::uintptr_t);
+		context.FP = *reinterpret_cast<const std::uintptr_t*>(fp);
+		return Unwind(context, frames, maxFrames, skip, true);
+#else
+		return 0;
+#endif
+	}
+} // namespace Profiler
@@ -0,0 +1,178 @@
+#include "Profiler/CallTree.h"
+#include "Profiler/Zone.h"
+#include "Profiler/ZoneStack.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+
+namespace Profiler
+{
+	static bool ZoneMatches(const ZoneDescriptor* descriptor, std::string_view nameOrCategory)
+	{
+		return nameOrCategory == descriptor->Name || nameOrCategory == descriptor->Category;
+	}
+
+	static void SetZoneBit(std::uint32_t descriptorID, bool enabled)
+	{
+		if (descriptorID >= c_MaxFilteredZones)
+			return;
+		std::uint64_t bit = 1ULL << (descriptorID & 63);
+		if (enabled)
+			g_State.DisabledZones[descriptorID >> 6].fetch_and(~bit, std::memory_order_relaxed);
+		else
+			g_State.DisabledZones[descriptorID >> 6].fetch_or(bit, std::memory_order_relaxed);
+	}
+
+	std::uint32_t RegisterZone(const ZoneDescriptor* descriptor)
+	{
+		std::lock_guard lock(g_State.ZoneDescriptorsMutex);
+		g_State.ZoneDescriptors.emplace_back(descriptor);
+		std::uint32_t id = static_cast<std::uint32_t>(g_State.ZoneDescriptors.size());
+		for (auto& name : g_State.DisabledZoneNames)
+		{
+			if (ZoneMatches(descriptor, name))
+			{
+				SetZoneBit(id, false);
+				break;
+			}
+		}
+		return id;
+	}
+
+	void SetZoneEnabled(std::uint32_t descriptorID, bool enabled)
+	{
+		SetZoneBit(descriptorID, enabled);
+	}
+
+	void SetZonesEnabled(std::string_view nameOrCategory, bool enabled)
+	{
+		std::lock_guard lock(g_State.ZoneDescriptorsMutex);
+		std::erase(g_State.DisabledZoneNames, nameOrCategory);
+		if (!enabled)
+			g_State.DisabledZoneNames.emplace_back(nameOrCategory);
+		for (std::size_t i = 0; i < g_State.ZoneDescriptors.size(); ++i)
+		{
+			if (ZoneMatches(g_State.ZoneDescriptors[i], nameOrCategory))
+				SetZoneBit(static_cast<std::uint32_t>(i + 1), enabled);
+		}
+	}
+
+	void AutoDisableHotZones(std::uint64_t frames, std::uint64_t maxCallsPerFrame)
+	{
+		g_State.AutoDisableFrames.store(0, std::memory_order_relaxed);
+		for (auto& calls : g_State.ZoneCalls)
+			calls.store(0, std::memory_order_relaxed);
+		g_State.AutoDisableMaxCalls = maxCallsPerFrame;
+		g_State.AutoDisableElapsed  = 0;
+		g_State.AutoDisableFrames.store(frames, std::memory_order_relaxed);
+	}
+
+	namespace Detail
+	{
+		static void CountZoneCall(std::uint32_t descriptorID)
+		{
+			if (descriptorID < c_MaxFilteredZones && g_State.AutoDisableFrames.load(std::memory_order_relaxed))
+				g_State.ZoneCalls[descriptorID].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		void ZoneBegin(ThreadState* state, std::uint32_t descriptorID)
+		{
+			CountZoneCall(descriptorID);
+			if (g_State.BuildCallTrees)
+				return CallTreeBegin(state, c_AggregateZoneKey | descriptorID);
+			if (g_State.SampleZoneStacks)
+				return ZoneStackBegin(state, c_AggregateZoneKey | descriptorID);
+
+			auto& event        = NewEvent<ZoneBeginEvent>(state);
+			event.DescriptorID = descriptorID;
+			CaptureLowResTimestamp<EZoneType::Function>(event.Timestamp);
+			++state->FunctionDepth;
+		}
+
+		void HRZoneBegin(ThreadState* state, std::uint32_t descriptorID)
+		{
+			CountZoneCall(descriptorID);
+			if (g_State.BuildCallTrees)
+				return CallTreeBegin(state, c_AggregateZoneKey | descriptorID);
+			if (g_State.SampleZoneStacks)
+				return ZoneStackBegin(state, c_AggregateZoneKey | descriptorID);
+
+			auto& event        = NewEvent<ZoneBeginEvent>(state);
+			event.DescriptorID = descriptorID;
+			CaptureHighResTimestamp<EZoneType::Function>(event.Timestamp);
+			++state->FunctionDepth;
+		}
+
+		// Entries are zone names or categories separated by commas or new lines, '#' starts a comment.
+		static void DisableZoneList(std::string_view list)
+		{
+			while (!list.empty())
+			{
+				std::size_t end   = list.find_first_of(",\n");
+				auto        entry = list.substr(0, end);
+				list              = end == std::string_view::npos ? std::string_view {} : list.substr(end + 1);
+
+				entry = entry.substr(0, entry.find('#'));
+				while (!entry.empty() && std::strchr(" \t\r", entry.front()))
+					entry.remove_prefix(1);
+				while (!entry.empty() && std::strchr(" \t\r", entry.back()))
+					entry.remove_suffix(1);
+				if (!entry.empty())
+					SetZonesEnabled(entry, false);
+			}
+		}
+
+		void LoadZoneFilters()
+		{
+			if (const char* zones = std::getenv("PROFILER_DISABLED_ZONES"))
+				DisableZoneList(zones);
+
+			if (const char* path = std::getenv("PROFILER_ZONE_FILTER"))
+			{
+				if (std::FILE* file = std::fopen(path, "r"))
+				{
+					std::string contents;
+					char        buffer[4096];
+					while (std::size_t read = std::fread(buffer, 1, sizeof(buffer), file))
+						contents.append(buffer, read);
+					std::fclose(file);
+					DisableZoneList(contents);
+				}
+			}
+
+			// Given as <frames>:<max calls per frame>.
+			if (const char* autoDisable = std::getenv("PROFILER_AUTO_DISABLE_ZONES"))
+			{
+				unsigned long long frames = 0, maxCalls = 0;
+				if (std::sscanf(autoDisable, "%llu:%llu", &frames, &maxCalls) == 2)
+					AutoDisableHotZones(frames, maxCalls);
+			}
+		}
+
+		void UpdateHotZones()
+		{
+			std::uint64_t frames = g_State.AutoDisableFrames.load(std::memory_order_relaxed);
+			if (!frames)
+				return;
+
+			std::uint64_t elapsed  = ++g_State.AutoDisableElapsed;
+			std::uint64_t maxCalls = g_State.AutoDisableMaxCalls * elapsed;
+			std::size_t   count;
+			{
+				std::lock_guard lock(g_State.ZoneDescriptorsMutex);
+				count = std::min<std::size_t>(g_State.ZoneDescriptors.size() + 1, c_MaxFilteredZones);
+			}
+			for (std::uint32_t id = 1; id < count; ++id)
+			{
+				if (g_State.ZoneCalls[id].load(std::memory_order_relaxed) > maxCalls)
+					SetZoneBit(id, false);
+			}
+
+			if (elapsed >= frames)
+				g_State.AutoDisableFrames.store(0, std::memory_order_relaxed);
+		}
+	} // namespace Detail
+} // namespace Profiler
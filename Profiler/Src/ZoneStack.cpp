@@ -0,0 +1,133 @@
+#include "Profiler/Callstack.h"
+#include "Profiler/Timestamp.h"
+#include "Profiler/ZoneStack.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace Profiler
+{
+	static struct ZoneSamplerData
+	{
+		~ZoneSamplerData()
+		{
+			Running = false;
+			if (Thread.joinable())
+				Thread.join();
+		}
+
+		std::thread      Thread;
+		std::atomic_bool Running   = false;
+		std::uint32_t    Frequency = 0;
+	} s_ZoneSampler;
+
+	struct ZoneStackCopy
+	{
+	public:
+		std::uint64_t ThreadID;
+		std::size_t   Size;
+		void*         Keys[c_ZoneStackDepth];
+	};
+
+	static void ZoneSamplerFunc()
+	{
+		ThreadState* state = GetThreadState();
+		state->ThreadID    = GetThreadID();
+		g_State.addThread(state);
+
+		std::vector<ZoneStackCopy> stacks;
+		auto                       interval = std::chrono::nanoseconds(1'000'000'000 / s_ZoneSampler.Frequency);
+		auto                       next     = std::chrono::steady_clock::now();
+		while (s_ZoneSampler.Running.load(std::memory_order_acquire))
+		{
+			next += interval;
+			std::this_thread::sleep_until(next);
+			if (!state->Capture)
+			{
+				FlushIfRequested(state);
+				continue;
+			}
+
+			// Copied under the lock, storing events may block on the collector.
+			std::size_t count = 0;
+			{
+				std::lock_guard lock(g_State.ThreadsMutex);
+				stacks.resize(g_State.Threads.size());
+				for (auto tstate : g_State.Threads)
+				{
+					if (tstate == state)
+						continue;
+					std::uint64_t keys[c_ZoneStackDepth];
+					auto&         copy = stacks[count];
+					copy.Size          = tstate->OpenZones.read(keys, c_ZoneStackDepth);
+					if (!copy.Size)
+						continue;
+					copy.ThreadID = tstate->ThreadID;
+					for (std::size_t i = 0; i < copy.Size; ++i)
+						copy.Keys[i] = reinterpret_cast<void*>(static_cast<std::uintptr_t>(keys[i]));
+					++count;
+				}
+			}
+
+			EventTimestamp timestamp;
+			CaptureHighResTimestamp<EZoneType::Sample>(timestamp);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				auto&         copy = stacks[i];
+				std::uint64_t id   = Detail::InternCallstack(state, copy.Keys, copy.Size);
+
+				auto& event      = NewEvent<ZoneSampleEvent>(state);
+				event.NumEntries = static_cast<std::uint8_t>(copy.Size);
+				event.ThreadID   = copy.ThreadID;
+				event.DataID     = id;
+				event.Timestamp  = timestamp;
+			}
+		}
+
+		FlushEvents(state);
+		g_State.removeThread(state);
+	}
+
+	bool StartZoneSampler(std::uint32_t frequency)
+	{
+		if (s_ZoneSampler.Running || !frequency || frequency > 1'000'000)
+			return false;
+
+		g_State.SampleZoneStacks = true;
+		s_ZoneSampler.Frequency  = frequency;
+		s_ZoneSampler.Running    = true;
+		s_ZoneSampler.Thread     = std::thread(&ZoneSamplerFunc);
+		return true;
+	}
+
+	void StopZoneSampler()
+	{
+		if (!s_ZoneSampler.Running)
+			return;
+
+		s_ZoneSampler.Running = false;
+		s_ZoneSampler.Thread.join();
+		g_State.SampleZoneStacks = false;
+	}
+
+	bool IsZoneSamplerRunning()
+	{
+		return s_ZoneSampler.Running;
+	}
+
+	namespace Detail
+	{
+		void ZoneStackBegin(ThreadState* state, std::uint64_t key)
+		{
+			state->OpenZones.push(key);
+			++state->FunctionDepth;
+		}
+
+		void ZoneStackEnd(ThreadState* state)
+		{
+			state->OpenZones.pop();
+			--state->FunctionDepth;
+		}
+	} // namespace Detail
+} // namespace Profiler
@@ -61,6 +61,16 @@ void loopedFunc(std::size_t count)
 	}
 }
 
+void zonedFunc()
+{
+	PROFILER_ZONE();
+
+	auto lambda = []() {
+		PROFILER_HR_ZONE("Lambda", 0x00FF00, "Test");
+	};
+	lambda();
+}
+
 void threadFunc()
 {
 	auto _thread = Profiler::Thread();
@@ -92,12 +102,14 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv)
 	funcWithArg(69);
 	funcWithMultipleArgs(1, 2, 3, 4);
 	loopedFunc(10);
+	zonedFunc();
 
 	/*for (std::size_t i = 0; i < 16; ++i)
 		threads[i].join();*/
 
 	Profiler::WantCapturing(false, true);
-	Profiler::WriteCaptures();
+	Profiler::WriteCaptures("Capture.prof");
+	Profiler::DumpCapture("Capture.prof");
 
 	Profiler::Deinit();
 }
\ No newline at end of file
@@ -1,3 +1,8 @@
+newoption({
+	trigger     = "instrument-functions",
+	description = "Build Test with -finstrument-functions, every call is recorded through the Profiler's hooks"
+})
+
 workspace("Profiler")
 	common:setConfigsAndPlatforms()
 	common:addCoreDefines()
@@ -5,6 +10,7 @@ workspace("Profiler")
 	cppdialect("C++20")
 	rtti("Off")
 	exceptionhandling("On")
+	omitframepointer("Off")
 	flags("MultiProcessorCompile")
 
 	startproject("Test")
@@ -73,6 +79,31 @@ workspace("Profiler")
 		links({ "Profiler" })
 		externalincludedirs({ "Profiler/Inc/" })
 
+		-- Inlined Profiler and standard library code is left uninstrumented, the Profiler project itself never is.
+		filter({ "options:instrument-functions", "toolset:gcc" })
+			buildoptions({ "-finstrument-functions", "-finstrument-functions-exclude-file-list=Profiler/Inc/,/c++/" })
+		filter({ "options:instrument-functions", "toolset:clang" })
+			buildoptions({ "-finstrument-functions-after-inlining" })
+		filter({})
+
+		common:addActions()
+
+	project("Bench")
+		location("Bench/")
+		warnings("Extra")
+
+		common:outDirs()
+		common:debugDir()
+
+		kind("ConsoleApp")
+
+		includedirs({ "%{prj.location}/Src/" })
+		files({ "%{prj.location}/Src/**" })
+		removefiles({ "*.DS_Store" })
+
+		links({ "Profiler" })
+		externalincludedirs({ "Profiler/Inc/" })
+
 		common:addActions()
 
 	group("Dependencies")